@@ -0,0 +1,260 @@
+/* ************************************************************************** */
+/*
+    @file
+        gb_batch.c
+
+    @date
+        October, 2026
+
+    @author
+        Gino Francesco Bogo (ᛊᛟᚱᚱᛖ ᛗᛖᚨ ᛁᛊᛏᚨᛗᛁ ᚨcᚢᚱᛉᚢ)
+
+    @license
+        MIT
+ */
+/* ************************************************************************** */
+
+#include "gb_batch.h"
+
+#include <pthread.h>   // pthread_cond_t, pthread_create, pthread_join, ...
+#include <stdatomic.h> // atomic_fetch_add, atomic_load, atomic_size_t, ...
+#include <stdbool.h>   // bool, false, true
+#include <string.h>    // memset
+#include <unistd.h>    // _SC_NPROCESSORS_ONLN, sysconf
+
+#include "gb_utils.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Defines & Macros
+// *****************************************************************************
+// *****************************************************************************
+
+// Sanity cap on the pool size
+#define MAX_THREADS 256
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Types & Structures
+// *****************************************************************************
+// *****************************************************************************
+
+// One call of gb_batch_calc()
+typedef struct {
+    const char *const *exprs;
+    size_t             count;
+    double            *out;
+    gb_calc_error_t   *errs;
+    atomic_size_t      next;   // first unclaimed expression
+    atomic_size_t      failed; // failures so far
+} batch_job_t;
+
+/*
+    The workers sleep on `wake` until `round` changes, then claim chunks of
+    the current job through the shared `next` index. The last one to run out
+    of work signals `done`. The job is written under the lock before the
+    round starts and, apart from its two counters, only read afterwards.
+ */
+struct gb_batch {
+    pthread_mutex_t lock;
+    pthread_cond_t  wake;
+    pthread_cond_t  done;
+    unsigned        round; // job counter
+    unsigned        busy;  // workers still on the current job
+    bool            stop;
+    batch_job_t     job;
+
+    unsigned  workers;
+    pthread_t thread[];
+};
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions
+// *****************************************************************************
+// *****************************************************************************
+
+static void _batch_range(batch_job_t *job, size_t first, size_t last) {
+    size_t failed = 0;
+
+    for (size_t i = first; i < last; ++i) {
+        gb_calc_error_t err;
+
+        job->out[i] = gb_calc_ex(job->exprs[i], &err);
+
+        if (err.code != GB_CALC_OK) {
+            ++failed;
+        }
+
+        if (job->errs) {
+            job->errs[i] = err;
+        }
+    }
+
+    if (failed) {
+        atomic_fetch_add(&job->failed, failed);
+    }
+}
+
+static void _batch_drain(batch_job_t *job) {
+    for (;;) {
+        const size_t first = atomic_fetch_add(&job->next, GB_BATCH_CHUNK);
+
+        if (first >= job->count) {
+            return;
+        }
+
+        _batch_range(job, first, GB_MIN(first + GB_BATCH_CHUNK, job->count));
+    }
+}
+
+static void *_batch_worker(void *args) {
+    gb_batch_t *batch = (gb_batch_t *)args;
+    unsigned    round = 0;
+
+    pthread_mutex_lock(&batch->lock);
+
+    for (;;) {
+        while (!batch->stop && (batch->round == round)) {
+            pthread_cond_wait(&batch->wake, &batch->lock);
+        }
+
+        if (batch->stop) {
+            break;
+        }
+
+        round = batch->round;
+        pthread_mutex_unlock(&batch->lock);
+
+        _batch_drain(&batch->job);
+
+        pthread_mutex_lock(&batch->lock);
+
+        if (--batch->busy == 0) {
+            pthread_cond_signal(&batch->done);
+        }
+    }
+
+    pthread_mutex_unlock(&batch->lock);
+
+    // The scratch memory is per thread: release it before the thread is gone
+    gb_calc_scratch(NULL, 0);
+
+    return NULL;
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Functions
+// *****************************************************************************
+// *****************************************************************************
+
+unsigned gb_batch_cores(void) {
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (cores > 0) ? (unsigned)GB_MIN(cores, MAX_THREADS) : 1;
+}
+
+gb_batch_t *gb_batch_new(unsigned threads) {
+    if (threads == 0) {
+        threads = gb_batch_cores();
+    }
+
+    threads = GB_MIN(threads, MAX_THREADS);
+
+    const size_t size  = sizeof(gb_batch_t) + (threads - 1) * sizeof(pthread_t);
+    gb_batch_t  *batch = (gb_batch_t *)gb_malloc(size, sizeof(void *));
+
+    if (!batch) {
+        return NULL;
+    }
+
+    memset(batch, 0, sizeof(gb_batch_t));
+
+    pthread_mutex_init(&batch->lock, NULL);
+    pthread_cond_init(&batch->wake, NULL);
+    pthread_cond_init(&batch->done, NULL);
+
+    // A worker that cannot be started only shrinks the pool
+    while (batch->workers < (threads - 1)) {
+        if (pthread_create(&batch->thread[batch->workers], NULL, _batch_worker, batch)) {
+            break;
+        }
+
+        ++batch->workers;
+    }
+
+    return batch;
+}
+
+void gb_batch_free(gb_batch_t *batch) {
+    if (!batch) {
+        return;
+    }
+
+    pthread_mutex_lock(&batch->lock);
+    batch->stop = true;
+    pthread_cond_broadcast(&batch->wake);
+    pthread_mutex_unlock(&batch->lock);
+
+    for (unsigned i = 0; i < batch->workers; ++i) {
+        pthread_join(batch->thread[i], NULL);
+    }
+
+    pthread_cond_destroy(&batch->done);
+    pthread_cond_destroy(&batch->wake);
+    pthread_mutex_destroy(&batch->lock);
+
+    gb_free(batch);
+}
+
+unsigned gb_batch_threads(const gb_batch_t *batch) {
+    return batch ? (batch->workers + 1) : 1;
+}
+
+size_t gb_batch_calc(gb_batch_t        *batch, //
+                     const char *const *exprs,
+                     size_t             count,
+                     double            *out,
+                     gb_calc_error_t   *errs) {
+    // Not worth waking the workers for a couple of chunks
+    if (!batch || (batch->workers == 0) || (count <= 2 * GB_BATCH_CHUNK)) {
+        batch_job_t local = {.exprs = exprs, .count = count, .out = out, .errs = errs};
+
+        _batch_range(&local, 0, count);
+        return atomic_load(&local.failed);
+    }
+
+    batch_job_t *job = &batch->job;
+
+    pthread_mutex_lock(&batch->lock);
+
+    job->exprs = exprs;
+    job->count = count;
+    job->out   = out;
+    job->errs  = errs;
+    atomic_store(&job->next, 0);
+    atomic_store(&job->failed, 0);
+
+    batch->busy = batch->workers;
+    ++batch->round;
+
+    pthread_cond_broadcast(&batch->wake);
+    pthread_mutex_unlock(&batch->lock);
+
+    _batch_drain(job);
+
+    pthread_mutex_lock(&batch->lock);
+
+    while (batch->busy) {
+        pthread_cond_wait(&batch->done, &batch->lock);
+    }
+
+    pthread_mutex_unlock(&batch->lock);
+
+    return atomic_load(&job->failed);
+}
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,108 @@
+/* ************************************************************************** */
+/*
+    @file
+        gb_batch.h
+
+    @date
+        October, 2026
+
+    @author
+        Gino Francesco Bogo (ᛊᛟᚱᚱᛖ ᛗᛖᚨ ᛁᛊᛏᚨᛗᛁ ᚨcᚢᚱᛉᚢ)
+
+    @license
+        MIT
+ */
+/* ************************************************************************** */
+
+#ifndef GB_BATCH_H
+#define GB_BATCH_H
+
+#include <stddef.h> // size_t
+
+#include "gb_calc.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Macros
+// *****************************************************************************
+// *****************************************************************************
+
+// Expressions claimed by a thread at a time
+#define GB_BATCH_CHUNK 64
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**
+ * @brief Pool of worker threads evaluating independent expressions.
+ */
+typedef struct gb_batch gb_batch_t;
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Functions
+// *****************************************************************************
+// *****************************************************************************
+
+/**
+ * @brief Returns the number of online processors (at least 1).
+ */
+unsigned gb_batch_cores(void);
+
+/**
+ * @brief Starts a worker pool.
+ *
+ * The thread calling gb_batch_calc() takes part in the work, so a pool of
+ * `threads` spawns `threads - 1` workers. Every worker keeps its own calc
+ * scratch memory (see gb_calc_scratch()) for its whole life, so evaluating
+ * does not allocate in steady state.
+ *
+ * @param[in] threads Total number of threads, or 0 for gb_batch_cores().
+ *
+ * @return The pool, or NULL if out of memory. Release it with
+ *         gb_batch_free().
+ */
+gb_batch_t *gb_batch_new(unsigned threads);
+
+/**
+ * @brief Stops the workers and releases a pool.
+ *
+ * @param[in] batch Pool returned by gb_batch_new(), or NULL (no-op).
+ */
+void gb_batch_free(gb_batch_t *batch);
+
+/**
+ * @brief Returns the total number of threads of a pool (workers and caller).
+ */
+unsigned gb_batch_threads(const gb_batch_t *batch);
+
+/**
+ * @brief Evaluates many independent expressions in parallel.
+ *
+ * Threads claim GB_BATCH_CHUNK consecutive expressions at a time and store
+ * each result at the index of its expression, so the output keeps the input
+ * order whatever the scheduling. The call returns once every expression has
+ * been evaluated. A pool serves one call at a time.
+ *
+ * @param[in]  batch Worker pool, or NULL to evaluate on the calling thread.
+ * @param[in]  exprs Null-terminated expressions.
+ * @param[in]  count Number of expressions.
+ * @param[out] out   Results, as returned by gb_calc_ex() (INFINITY on error).
+ * @param[out] errs  Error reports (one per expression), or NULL.
+ *
+ * @return The number of expressions that failed.
+ */
+size_t gb_batch_calc(gb_batch_t        *batch, //
+                     const char *const *exprs,
+                     size_t             count,
+                     double            *out,
+                     gb_calc_error_t   *errs);
+
+#endif // GB_BATCH_H
+
+/* *****************************************************************************
+ End of File
+ */
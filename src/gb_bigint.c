@@ -0,0 +1,1168 @@
+/* ************************************************************************** */
+/*
+    @file
+        gb_bigint.c
+
+    @date
+        October, 2026
+
+    @author
+        Gino Francesco Bogo (ᛊᛟᚱᚱᛖ ᛗᛖᚨ ᛁᛊᛏᚨᛗᛁ ᚨcᚢᚱᛉᚢ)
+
+    @license
+        MIT
+ */
+/* ************************************************************************** */
+
+#include "gb_bigint.h"
+
+#include <ctype.h>   // isalnum, isalpha, isdigit, isspace
+#include <stdbool.h> // bool, false, true
+#include <stdint.h>  // SIZE_MAX, uint32_t, uint64_t
+
+#include "gb_utils.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Defines & Macros
+// *****************************************************************************
+// *****************************************************************************
+
+#define LIMB_BITS 32
+
+// Largest power of ten that fits in a limb, and its number of digits
+#define DEC_CHUNK     1000000000U
+#define DEC_CHUNK_LEN 9
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (memory)
+// *****************************************************************************
+// *****************************************************************************
+
+static gb_limb_t *_alloc_limbs(size_t n) {
+    if (n > (SIZE_MAX / sizeof(gb_limb_t))) {
+        return NULL;
+    }
+
+    return (gb_limb_t *)gb_malloc(n * sizeof(gb_limb_t), sizeof(gb_limb_t));
+}
+
+/**
+ * @brief Grows the storage of an integer to at least `n` limbs.
+ *
+ * The value is preserved; capacity grows geometrically so that repeated
+ * small extensions (e.g. decimal parsing) stay linear.
+ */
+static bool _reserve(gb_bigint_t *x, size_t n) {
+    if (n <= x->cap) {
+        return true;
+    }
+
+    size_t cap = (x->cap < 4) ? 4 : x->cap;
+    while (cap < n) {
+        cap = (cap > (SIZE_MAX / 2)) ? n : (cap * 2);
+    }
+
+    gb_limb_t *limb = _alloc_limbs(cap);
+    if (!limb) {
+        return false;
+    }
+
+    if (x->len) {
+        gb_memcpy(limb, x->limb, x->len * sizeof(gb_limb_t));
+    }
+
+    gb_free(x->limb);
+
+    x->limb = limb;
+    x->cap  = cap;
+    return true;
+}
+
+// Drops leading zero limbs; zero is never negative
+static void _normalize(gb_bigint_t *x) {
+    while (x->len && !x->limb[x->len - 1]) {
+        x->len--;
+    }
+
+    if (!x->len) {
+        x->neg = false;
+    }
+}
+
+// Replaces the value of `x` with a copy of `n` limbs
+static bool _assign(gb_bigint_t *x, const gb_limb_t *limb, size_t n, bool neg) {
+    if (!_reserve(x, n)) {
+        return false;
+    }
+
+    if (n) {
+        gb_memmove(x->limb, limb, n * sizeof(gb_limb_t));
+    }
+
+    x->len = n;
+    x->neg = neg;
+    _normalize(x);
+    return true;
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (magnitudes)
+// *****************************************************************************
+// *****************************************************************************
+
+static int _mag_cmp(const gb_limb_t *a, size_t na, const gb_limb_t *b, size_t nb) {
+    if (na != nb) {
+        return (na > nb) ? 1 : -1;
+    }
+
+    while (na--) {
+        if (a[na] != b[na]) {
+            return (a[na] > b[na]) ? 1 : -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Adds `b` into `r[0..n)` in place and returns the carry out.
+ *
+ * Requires nb <= n; `r` may alias `b`.
+ */
+static gb_limb_t _mag_add_to(gb_limb_t *r, size_t n, const gb_limb_t *b, size_t nb) {
+    uint64_t carry = 0;
+    size_t   i     = 0;
+
+    for (; i < nb; ++i) {
+        carry += (uint64_t)r[i] + b[i];
+        r[i]   = (gb_limb_t)carry;
+        carry >>= LIMB_BITS;
+    }
+
+    for (; carry && (i < n); ++i) {
+        carry += r[i];
+        r[i]   = (gb_limb_t)carry;
+        carry >>= LIMB_BITS;
+    }
+
+    return (gb_limb_t)carry;
+}
+
+/**
+ * @brief Subtracts `b` from `r[0..n)` in place (requires r >= b, nb <= n).
+ */
+static void _mag_sub_from(gb_limb_t *r, size_t n, const gb_limb_t *b, size_t nb) {
+    int64_t borrow = 0;
+    size_t  i      = 0;
+
+    for (; i < nb; ++i) {
+        borrow += (int64_t)r[i] - b[i];
+        r[i]    = (gb_limb_t)borrow;
+        borrow  = (borrow < 0) ? -1 : 0;
+    }
+
+    for (; borrow && (i < n); ++i) {
+        borrow += r[i];
+        r[i]    = (gb_limb_t)borrow;
+        borrow  = (borrow < 0) ? -1 : 0;
+    }
+}
+
+/**
+ * @brief Schoolbook product r[0..na+nb) = a * b.
+ *
+ * `r` must not overlap the operands.
+ */
+static void _mul_school(gb_limb_t       *r,  //
+                        const gb_limb_t *a,  //
+                        size_t           na, //
+                        const gb_limb_t *b,  //
+                        size_t           nb) {
+    gb_bzero(r, na * sizeof(gb_limb_t));
+
+    for (size_t j = 0; j < nb; ++j) {
+        const uint64_t bj    = b[j];
+        uint64_t       carry = 0;
+
+        for (size_t i = 0; i < na; ++i) {
+            carry       += (a[i] * bj) + r[i + j];
+            r[i + j]     = (gb_limb_t)carry;
+            carry      >>= LIMB_BITS;
+        }
+
+        r[j + na] = (gb_limb_t)carry;
+    }
+}
+
+// Scratch limbs needed by _mul_kara() for n-limb operands
+static size_t _kara_scratch(size_t n) {
+    size_t total = 0;
+
+    while (n >= GB_BIGINT_KARATSUBA) {
+        const size_t hn = n - (n / 2);
+
+        total += (4 * hn) + 4;
+        n      = hn + 1;
+    }
+
+    return total;
+}
+
+/**
+ * @brief Karatsuba product r[0..2n) = a * b of two n-limb operands.
+ *
+ * With a = a1*B^h + a0 and b = b1*B^h + b0 the middle term is obtained as
+ * (a0 + a1)(b0 + b1) - a0*b0 - a1*b1, so each level needs three half-size
+ * products. The sums and the middle product live in `tmp`, which must hold
+ * _kara_scratch(n) limbs; `r` must not overlap the operands.
+ */
+static void _mul_kara(gb_limb_t       *r, //
+                      const gb_limb_t *a, //
+                      const gb_limb_t *b, //
+                      size_t           n, //
+                      gb_limb_t       *tmp) {
+    if (n < GB_BIGINT_KARATSUBA) {
+        _mul_school(r, a, n, b, n);
+        return;
+    }
+
+    const size_t h  = n / 2; // low half
+    const size_t hn = n - h; // high half (hn >= h)
+
+    gb_limb_t *sa   = tmp;
+    gb_limb_t *sb   = sa + hn + 1;
+    gb_limb_t *mid  = sb + hn + 1;
+    gb_limb_t *next = mid + (2 * hn) + 2;
+
+    // z0 = a0*b0 in r[0..2h), z2 = a1*b1 in r[2h..2n)
+    _mul_kara(r, a, b, h, next);
+    _mul_kara(r + (2 * h), a + h, b + h, hn, next);
+
+    // sa = a0 + a1, sb = b0 + b1 (hn + 1 limbs each)
+    gb_memcpy(sa, a + h, hn * sizeof(gb_limb_t));
+    gb_memcpy(sb, b + h, hn * sizeof(gb_limb_t));
+    sa[hn] = _mag_add_to(sa, hn, a, h);
+    sb[hn] = _mag_add_to(sb, hn, b, h);
+
+    // mid = sa*sb - z0 - z2 = a0*b1 + a1*b0
+    _mul_kara(mid, sa, sb, hn + 1, next);
+    _mag_sub_from(mid, (2 * hn) + 2, r, 2 * h);
+    _mag_sub_from(mid, (2 * hn) + 2, r + (2 * h), 2 * hn);
+
+    // r += mid * B^h; the limbs of mid past the end of r are zero
+    const size_t room = (2 * n) - h;
+    const size_t nmid = ((2 * hn) + 2 < room) ? ((2 * hn) + 2) : room;
+
+    _mag_add_to(r + h, room, mid, nmid);
+}
+
+// Scratch limbs needed by _mag_mul() for an na x nb product
+static size_t _mul_scratch(size_t na, size_t nb) {
+    if (na < nb) {
+        const size_t t = na;
+
+        na = nb;
+        nb = t;
+    }
+
+    if (nb < GB_BIGINT_KARATSUBA) {
+        return 0;
+    }
+
+    if (na == nb) {
+        return _kara_scratch(na);
+    }
+
+    size_t total = (2 * nb) + _kara_scratch(nb);
+
+    if (na % nb) {
+        const size_t tail = (2 * nb) + _mul_scratch(nb, na % nb);
+
+        total = (tail > total) ? tail : total;
+    }
+
+    return total;
+}
+
+/**
+ * @brief Product r[0..na+nb) = a * b of arbitrary lengths.
+ *
+ * Short operands use the schoolbook method, equal lengths use Karatsuba and
+ * unbalanced operands are cut into nb-limb slices of the longer one, each
+ * multiplied as a balanced product. `tmp` must hold _mul_scratch(na, nb)
+ * limbs; `r` must not overlap the operands.
+ */
+static void _mag_mul(gb_limb_t       *r,  //
+                     const gb_limb_t *a,  //
+                     size_t           na, //
+                     const gb_limb_t *b,  //
+                     size_t           nb, //
+                     gb_limb_t       *tmp) {
+    if (na < nb) {
+        _mag_mul(r, b, nb, a, na, tmp);
+        return;
+    }
+
+    if (nb < GB_BIGINT_KARATSUBA) {
+        _mul_school(r, a, na, b, nb);
+        return;
+    }
+
+    if (na == nb) {
+        _mul_kara(r, a, b, na, tmp);
+        return;
+    }
+
+    gb_limb_t *prod = tmp;
+    gb_limb_t *next = tmp + (2 * nb);
+
+    gb_bzero(r, (na + nb) * sizeof(gb_limb_t));
+
+    for (size_t off = 0; off < na; off += nb) {
+        const size_t len = ((na - off) < nb) ? (na - off) : nb;
+
+        _mag_mul(prod, a + off, len, b, nb, next);
+        _mag_add_to(r + off, na + nb - off, prod, len + nb);
+    }
+}
+
+/**
+ * @brief Divides `a[0..n)` in place by a single limb and returns the remainder.
+ */
+static gb_limb_t _mag_div_small(gb_limb_t *a, size_t n, gb_limb_t d) {
+    uint64_t rem = 0;
+
+    while (n--) {
+        const uint64_t cur = (rem << LIMB_BITS) | a[n];
+
+        a[n] = (gb_limb_t)(cur / d);
+        rem  = cur % d;
+    }
+
+    return (gb_limb_t)rem;
+}
+
+// Computes a[0..n) = a * m + add in place and returns the carry out
+static gb_limb_t _mag_mul_small(gb_limb_t *a, size_t n, gb_limb_t m, gb_limb_t add) {
+    uint64_t carry = add;
+
+    for (size_t i = 0; i < n; ++i) {
+        carry   += (uint64_t)a[i] * m;
+        a[i]     = (gb_limb_t)carry;
+        carry  >>= LIMB_BITS;
+    }
+
+    return (gb_limb_t)carry;
+}
+
+// Whether x^e stays within GB_BIGINT_MAX_BITS for an x of `bits` bits
+static bool _pow_fits(size_t bits, uint64_t e) {
+    // For |x| >= 2 the result has more than (bits - 1) * e bits
+    return (bits <= 1) || ((e <= GB_BIGINT_MAX_BITS) && (((bits - 1) * e) < GB_BIGINT_MAX_BITS));
+}
+
+static int _clz_limb(gb_limb_t x) {
+    int n = 0;
+
+    // clang-format off
+    if (!(x & 0xFFFF0000U)) { n += 16; x <<= 16; }
+    if (!(x & 0xFF000000U)) { n +=  8; x <<=  8; }
+    if (!(x & 0xF0000000U)) { n +=  4; x <<=  4; }
+    if (!(x & 0xC0000000U)) { n +=  2; x <<=  2; }
+    if (!(x & 0x80000000U)) { n +=  1; }
+    // clang-format on
+
+    return n;
+}
+
+/**
+ * @brief Long division of magnitudes (Knuth, TAOCP vol. 2, algorithm D).
+ *
+ * Requires m >= n >= 2 and v[n - 1] != 0. Produces q[0..m-n+1) and
+ * r[0..n). `un` (m + 1 limbs) and `vn` (n limbs) are work areas for the
+ * normalized operands.
+ */
+static void _mag_divmod(gb_limb_t       *q,  //
+                        gb_limb_t       *r,  //
+                        const gb_limb_t *u,  //
+                        size_t           m,  //
+                        const gb_limb_t *v,  //
+                        size_t           n,  //
+                        gb_limb_t       *un, //
+                        gb_limb_t       *vn) {
+    const uint64_t base = (uint64_t)1 << LIMB_BITS;
+    const int      s    = _clz_limb(v[n - 1]);
+
+    // Normalize so that the top bit of the divisor is set; shifting a 64-bit
+    // value by 32 keeps the s == 0 case well defined
+    for (size_t i = n - 1; i > 0; --i) {
+        vn[i] = (gb_limb_t)(((uint64_t)v[i] << s) | ((uint64_t)v[i - 1] >> (LIMB_BITS - s)));
+    }
+    vn[0] = (gb_limb_t)((uint64_t)v[0] << s);
+
+    un[m] = (gb_limb_t)((uint64_t)u[m - 1] >> (LIMB_BITS - s));
+    for (size_t i = m - 1; i > 0; --i) {
+        un[i] = (gb_limb_t)(((uint64_t)u[i] << s) | ((uint64_t)u[i - 1] >> (LIMB_BITS - s)));
+    }
+    un[0] = (gb_limb_t)((uint64_t)u[0] << s);
+
+    for (size_t j = m - n + 1; j-- > 0;) {
+        // Estimate the quotient digit from the top two limbs
+        const uint64_t num  = ((uint64_t)un[j + n] << LIMB_BITS) | un[j + n - 1];
+        uint64_t       qhat = num / vn[n - 1];
+        uint64_t       rhat = num % vn[n - 1];
+
+        while ((qhat >= base) || ((qhat * vn[n - 2]) > ((rhat << LIMB_BITS) | un[j + n - 2]))) {
+            qhat--;
+            rhat += vn[n - 1];
+            if (rhat >= base) {
+                break;
+            }
+        }
+
+        // Multiply and subtract
+        int64_t borrow = 0;
+        int64_t t;
+
+        for (size_t i = 0; i < n; ++i) {
+            const uint64_t p = qhat * vn[i];
+
+            t         = (int64_t)un[i + j] - borrow - (int64_t)(p & 0xFFFFFFFFU);
+            un[i + j] = (gb_limb_t)t;
+            borrow    = (int64_t)(p >> LIMB_BITS) - (t >> LIMB_BITS);
+        }
+
+        t         = (int64_t)un[j + n] - borrow;
+        un[j + n] = (gb_limb_t)t;
+
+        // The estimate was one too large: add the divisor back
+        if (t < 0) {
+            qhat--;
+            un[j + n] += _mag_add_to(un + j, n, vn, n);
+        }
+
+        q[j] = (gb_limb_t)qhat;
+    }
+
+    // Denormalize the remainder
+    for (size_t i = 0; i < n - 1; ++i) {
+        r[i] = (gb_limb_t)(((uint64_t)un[i] >> s) | ((uint64_t)un[i + 1] << (LIMB_BITS - s)));
+    }
+    r[n - 1] = (gb_limb_t)(((uint64_t)un[n - 1] >> s) | ((uint64_t)un[n] << (LIMB_BITS - s)));
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (signed arithmetic)
+// *****************************************************************************
+// *****************************************************************************
+
+/**
+ * @brief Computes r = a + (b_neg ? -|b| : |b|).
+ *
+ * Every limb is read before the same index is written, so `r` may alias
+ * either operand.
+ */
+static bool _add_signed(gb_bigint_t *r, const gb_bigint_t *a, const gb_bigint_t *b, bool b_neg) {
+    const size_t na    = a->len;
+    const size_t nb    = b->len;
+    const bool   a_neg = a->neg;
+
+    if (a_neg == b_neg) {
+        const size_t n = (na > nb) ? na : nb;
+
+        if (!_reserve(r, n + 1)) {
+            return false;
+        }
+
+        const gb_limb_t *ap    = a->limb;
+        const gb_limb_t *bp    = b->limb;
+        uint64_t         carry = 0;
+
+        for (size_t i = 0; i < n; ++i) {
+            carry     += (uint64_t)((i < na) ? ap[i] : 0) + ((i < nb) ? bp[i] : 0);
+            r->limb[i] = (gb_limb_t)carry;
+            carry    >>= LIMB_BITS;
+        }
+
+        r->limb[n] = (gb_limb_t)carry;
+        r->len     = n + 1;
+        r->neg     = a_neg;
+    } else {
+        const bool a_big = _mag_cmp(a->limb, na, b->limb, nb) >= 0;
+        const bool neg   = a_big ? a_neg : b_neg;
+        const size_t n   = a_big ? na : nb;
+
+        if (!_reserve(r, n)) {
+            return false;
+        }
+
+        const gb_limb_t *big    = a_big ? a->limb : b->limb;
+        const gb_limb_t *small  = a_big ? b->limb : a->limb;
+        const size_t     ns     = a_big ? nb : na;
+        int64_t          borrow = 0;
+
+        for (size_t i = 0; i < n; ++i) {
+            borrow    += (int64_t)big[i] - ((i < ns) ? small[i] : 0);
+            r->limb[i] = (gb_limb_t)borrow;
+            borrow     = (borrow < 0) ? -1 : 0;
+        }
+
+        r->len = n;
+        r->neg = neg;
+    }
+
+    _normalize(r);
+    return true;
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (expression evaluator)
+// *****************************************************************************
+// *****************************************************************************
+
+typedef struct {
+    gb_bigint_t *vals; // operand stack
+    size_t       nvals;
+    char        *ops;  // operator stack ('n' marks a pending unary minus)
+    size_t      *opos; // source offset of each operator
+    size_t       nops;
+
+    gb_calc_error_t *err;
+} bigint_calc_t;
+
+static bool _calc_fail(bigint_calc_t *ctx, gb_calc_errno_t code, size_t pos) {
+    if (ctx->err && (ctx->err->code == GB_CALC_OK)) {
+        ctx->err->code = code;
+        ctx->err->pos  = pos;
+        ctx->err->row  = 0;
+    }
+
+    return false;
+}
+
+static int _calc_prec(char op) {
+    switch (op) {
+        case '+':
+        case '-':
+            return 1;
+        case '*':
+        case '/':
+        case '%':
+            return 2;
+        case '^':
+            return 3;
+        default:
+            return 0; // '(' and unary markers never reduce as binary operators
+    }
+}
+
+// Applies the unary minus markers waiting for the operand on top of the stack
+static void _calc_unary(bigint_calc_t *ctx) {
+    gb_bigint_t *top = &ctx->vals[ctx->nvals - 1];
+
+    while (ctx->nops && (ctx->ops[ctx->nops - 1] == 'n')) {
+        top->neg = top->len && !top->neg;
+        ctx->nops--;
+    }
+}
+
+// Pops the top operator and applies it to the two top operands
+static bool _calc_reduce(bigint_calc_t *ctx) {
+    const char   op  = ctx->ops[--ctx->nops];
+    const size_t pos = ctx->opos[ctx->nops];
+
+    gb_bigint_t *b = &ctx->vals[--ctx->nvals];
+    gb_bigint_t *a = &ctx->vals[ctx->nvals - 1];
+
+    bool ok = true;
+
+    switch (op) {
+        case '+':
+            ok = gb_bigint_add(a, a, b);
+            break;
+        case '-':
+            ok = gb_bigint_sub(a, a, b);
+            break;
+        case '*':
+            ok = gb_bigint_mul(a, a, b);
+            break;
+        case '/':
+        case '%':
+            if (!b->len) {
+                gb_bigint_free(b);
+                return _calc_fail(ctx, (op == '/') ? GB_CALC_E_DIV_ZERO : GB_CALC_E_MOD_ZERO, pos);
+            }
+            ok = (op == '/') ? gb_bigint_divmod(a, NULL, a, b) : gb_bigint_divmod(NULL, a, a, b);
+            break;
+        default: { // '^'
+            const bool unit = (a->len == 1) && (a->limb[0] == 1);
+
+            if (b->neg || (b->len > 2)) {
+                // Only 0, 1 and -1 survive a negative or huge exponent
+                // exactly; the rest would truncate or overflow
+                if (b->neg || (a->len && !unit)) {
+                    gb_bigint_free(b);
+                    return _calc_fail(ctx, GB_CALC_E_RANGE, pos);
+                }
+                if (unit && a->neg && !(b->limb[0] & 1)) {
+                    a->neg = false;
+                }
+                break;
+            }
+
+            uint64_t e = 0;
+            for (size_t i = b->len; i-- > 0;) {
+                e = (e << LIMB_BITS) | b->limb[i];
+            }
+
+            if (!_pow_fits(gb_bigint_bits(a), e)) {
+                gb_bigint_free(b);
+                return _calc_fail(ctx, GB_CALC_E_RANGE, pos);
+            }
+
+            ok = gb_bigint_pow(a, a, e);
+            break;
+        }
+    }
+
+    gb_bigint_free(b);
+
+    return ok || _calc_fail(ctx, GB_CALC_E_NO_MEMORY, pos);
+}
+
+/**
+ * @brief Scans a literal at `expr[*pos]` and pushes its value.
+ */
+static bool _calc_literal(bigint_calc_t *ctx, const char *expr, size_t *pos) {
+    const size_t start = *pos;
+    const char  *cp    = expr + start;
+    int          base  = 10;
+
+    if ((cp[0] == '0') && ((cp[1] == 'x') || (cp[1] == 'X'))) {
+        base = 16;
+        cp  += 2;
+    } else if ((cp[0] == '0') && ((cp[1] == 'b') || (cp[1] == 'B'))) {
+        base = 2;
+        cp  += 2;
+    }
+
+    size_t len = 0;
+    while (isalnum((unsigned char)cp[len])) {
+        len++;
+    }
+
+    gb_bigint_t *x = &ctx->vals[ctx->nvals];
+
+    gb_bigint_init(x);
+
+    if (!gb_bigint_from_str(x, cp, len, base)) {
+        gb_bigint_free(x);
+        return _calc_fail(ctx, GB_CALC_E_SYNTAX, start);
+    }
+
+    ctx->nvals++;
+    *pos = (size_t)(cp + len - expr);
+    return true;
+}
+
+static bool _calc_run(bigint_calc_t *ctx, const char *expr) {
+    bool   expect = true; // an operand is expected next
+    size_t i      = 0;
+
+    while (expr[i]) {
+        const char c = expr[i];
+
+        if (isspace((unsigned char)c)) {
+            i++;
+            continue;
+        }
+
+        if (isdigit((unsigned char)c)) {
+            if (!expect) {
+                return _calc_fail(ctx, GB_CALC_E_SYNTAX, i);
+            }
+            if (!_calc_literal(ctx, expr, &i)) {
+                return false;
+            }
+            _calc_unary(ctx);
+            expect = false;
+            continue;
+        }
+
+        switch (c) {
+            case '(':
+                if (!expect) {
+                    return _calc_fail(ctx, GB_CALC_E_SYNTAX, i);
+                }
+                ctx->opos[ctx->nops]  = i;
+                ctx->ops[ctx->nops++] = '(';
+                break;
+
+            case ')':
+                if (expect) {
+                    return _calc_fail(ctx, GB_CALC_E_OPERAND, i);
+                }
+                while (ctx->nops && (ctx->ops[ctx->nops - 1] != '(')) {
+                    if (!_calc_reduce(ctx)) {
+                        return false;
+                    }
+                }
+                if (!ctx->nops) {
+                    return _calc_fail(ctx, GB_CALC_E_PARENS, i);
+                }
+                ctx->nops--;
+                _calc_unary(ctx);
+                break;
+
+            case '+':
+            case '-':
+            case '*':
+            case '/':
+            case '%':
+            case '^':
+                if (expect) {
+                    if ((c != '+') && (c != '-')) {
+                        return _calc_fail(ctx, GB_CALC_E_OPERAND, i);
+                    }
+                    if (c == '-') {
+                        ctx->opos[ctx->nops]  = i;
+                        ctx->ops[ctx->nops++] = 'n';
+                    }
+                    break;
+                }
+                // '^' is right-associative, the others left-associative, as in gb_calc()
+                while (ctx->nops && (_calc_prec(ctx->ops[ctx->nops - 1]) >= (_calc_prec(c) + (c == '^')))) {
+                    if (!_calc_reduce(ctx)) {
+                        return false;
+                    }
+                }
+                ctx->opos[ctx->nops]  = i;
+                ctx->ops[ctx->nops++] = c;
+                expect                = true;
+                break;
+
+            default:
+                return _calc_fail(ctx, isalpha((unsigned char)c) ? GB_CALC_E_IDENT : GB_CALC_E_SYNTAX, i);
+        }
+
+        i++;
+    }
+
+    if (expect) {
+        return _calc_fail(ctx, (ctx->nops || ctx->nvals) ? GB_CALC_E_OPERAND : GB_CALC_E_EMPTY_EXPR, i);
+    }
+
+    while (ctx->nops) {
+        if (ctx->ops[ctx->nops - 1] == '(') {
+            return _calc_fail(ctx, GB_CALC_E_PARENS, ctx->opos[ctx->nops - 1]);
+        }
+        if (!_calc_reduce(ctx)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Functions
+// *****************************************************************************
+// *****************************************************************************
+
+void gb_bigint_init(gb_bigint_t *x) {
+    x->limb = NULL;
+    x->len  = 0;
+    x->cap  = 0;
+    x->neg  = false;
+}
+
+void gb_bigint_free(gb_bigint_t *x) {
+    gb_free(x->limb);
+    gb_bigint_init(x);
+}
+
+bool gb_bigint_set_i64(gb_bigint_t *x, int64_t value) {
+    const bool     neg = value < 0;
+    const uint64_t mag = neg ? (0 - (uint64_t)value) : (uint64_t)value;
+
+    const gb_limb_t limb[2] = {(gb_limb_t)mag, (gb_limb_t)(mag >> LIMB_BITS)};
+
+    return _assign(x, limb, 2, neg);
+}
+
+bool gb_bigint_copy(gb_bigint_t *dst, const gb_bigint_t *src) {
+    return (dst == src) || _assign(dst, src->limb, src->len, src->neg);
+}
+
+bool gb_bigint_from_str(gb_bigint_t *x, const char *str, size_t len, int base) {
+    if (!str || !len || ((base != 2) && (base != 10) && (base != 16))) {
+        return false;
+    }
+
+    if (base == 10) {
+        if (!_reserve(x, (len / DEC_CHUNK_LEN) + 1)) {
+            return false;
+        }
+
+        x->len = 0;
+        x->neg = false;
+
+        // The first chunk takes the odd digits so the rest are full chunks
+        size_t chunk = len % DEC_CHUNK_LEN;
+        if (!chunk) {
+            chunk = DEC_CHUNK_LEN;
+        }
+
+        for (size_t i = 0; i < len; chunk = DEC_CHUNK_LEN) {
+            gb_limb_t scale = 1;
+            gb_limb_t value = 0;
+
+            for (size_t k = 0; k < chunk; ++k, ++i) {
+                if (!isdigit((unsigned char)str[i])) {
+                    return false;
+                }
+                scale *= 10;
+                value  = (value * 10) + (gb_limb_t)(str[i] - '0');
+            }
+
+            const gb_limb_t carry = _mag_mul_small(x->limb, x->len, scale, value);
+            if (carry) {
+                x->limb[x->len++] = carry;
+            }
+        }
+
+        _normalize(x);
+        return true;
+    }
+
+    // Powers of two: every digit maps to a fixed group of bits
+    const unsigned shift = (base == 16) ? 4 : 1;
+    const size_t   bits  = len * shift;
+
+    if (!_reserve(x, (bits + LIMB_BITS - 1) / LIMB_BITS)) {
+        return false;
+    }
+
+    x->len = (bits + LIMB_BITS - 1) / LIMB_BITS;
+    x->neg = false;
+    gb_bzero(x->limb, x->len * sizeof(gb_limb_t));
+
+    for (size_t i = 0; i < len; ++i) {
+        const char c = str[len - 1 - i];
+        unsigned   d;
+
+        if ((c >= '0') && (c <= '9')) {
+            d = (unsigned)(c - '0');
+        } else if ((c >= 'a') && (c <= 'f')) {
+            d = (unsigned)(c - 'a' + 10);
+        } else if ((c >= 'A') && (c <= 'F')) {
+            d = (unsigned)(c - 'A' + 10);
+        } else {
+            return false;
+        }
+
+        if (d >= (unsigned)base) {
+            return false;
+        }
+
+        const size_t bit = i * shift;
+        x->limb[bit / LIMB_BITS] |= (gb_limb_t)d << (bit % LIMB_BITS);
+    }
+
+    _normalize(x);
+    return true;
+}
+
+size_t gb_bigint_to_str(const gb_bigint_t *x, int base, char *dst, size_t dst_len) {
+    static const char digits[] = "0123456789ABCDEF";
+
+    if (!dst || !dst_len || ((base != 2) && (base != 10) && (base != 16))) {
+        return 0;
+    }
+
+    if (!x->len) {
+        if (dst_len < 2) {
+            return 0;
+        }
+        dst[0] = '0';
+        dst[1] = '\0';
+        return 1;
+    }
+
+    const size_t sign = x->neg ? 1 : 0;
+    size_t       len;
+
+    if (base != 10) {
+        const unsigned shift = (base == 16) ? 4 : 1;
+        const size_t   nd    = (gb_bigint_bits(x) + shift - 1) / shift;
+
+        len = sign + nd;
+        if (len >= dst_len) {
+            return 0;
+        }
+
+        for (size_t i = 0; i < nd; ++i) {
+            const size_t bit = i * shift;
+            const size_t d   = (x->limb[bit / LIMB_BITS] >> (bit % LIMB_BITS)) & ((1U << shift) - 1);
+
+            dst[len - 1 - i] = digits[d];
+        }
+    } else {
+        // Peel 9-digit chunks off a scratch copy with single-limb divisions
+        const size_t nchunks = ((x->len * LIMB_BITS) / 29) + 1; // 2^29 < 10^9
+        gb_limb_t   *work    = _alloc_limbs(x->len + nchunks);
+
+        if (!work) {
+            return 0;
+        }
+
+        gb_limb_t *chunk = work + x->len;
+        size_t     n     = x->len;
+        size_t     count = 0;
+
+        gb_memcpy(work, x->limb, n * sizeof(gb_limb_t));
+
+        while (n) {
+            chunk[count++] = _mag_div_small(work, n, DEC_CHUNK);
+            while (n && !work[n - 1]) {
+                n--;
+            }
+        }
+
+        // Leading chunk without padding, the others with exactly 9 digits
+        size_t lead = 0;
+        for (gb_limb_t v = chunk[count - 1]; v; v /= 10) {
+            lead++;
+        }
+
+        len = sign + lead + ((count - 1) * DEC_CHUNK_LEN);
+        if (len >= dst_len) {
+            gb_free(work);
+            return 0;
+        }
+
+        char *cp = dst + len;
+        for (size_t c = 0; c < count; ++c) {
+            gb_limb_t    v  = chunk[c];
+            const size_t nd = (c + 1 < count) ? DEC_CHUNK_LEN : lead;
+
+            for (size_t k = 0; k < nd; ++k, v /= 10) {
+                *--cp = (char)('0' + (v % 10));
+            }
+        }
+
+        gb_free(work);
+    }
+
+    if (sign) {
+        dst[0] = '-';
+    }
+    dst[len] = '\0';
+    return len;
+}
+
+int gb_bigint_cmp(const gb_bigint_t *a, const gb_bigint_t *b) {
+    if (a->neg != b->neg) {
+        return a->neg ? -1 : 1;
+    }
+
+    const int cmp = _mag_cmp(a->limb, a->len, b->limb, b->len);
+
+    return a->neg ? -cmp : cmp;
+}
+
+size_t gb_bigint_bits(const gb_bigint_t *x) {
+    if (!x->len) {
+        return 0;
+    }
+
+    return (x->len * LIMB_BITS) - (size_t)_clz_limb(x->limb[x->len - 1]);
+}
+
+bool gb_bigint_add(gb_bigint_t *r, const gb_bigint_t *a, const gb_bigint_t *b) {
+    return _add_signed(r, a, b, b->neg);
+}
+
+bool gb_bigint_sub(gb_bigint_t *r, const gb_bigint_t *a, const gb_bigint_t *b) {
+    return _add_signed(r, a, b, b->len && !b->neg);
+}
+
+bool gb_bigint_mul(gb_bigint_t *r, const gb_bigint_t *a, const gb_bigint_t *b) {
+    const size_t na  = a->len;
+    const size_t nb  = b->len;
+    const bool   neg = a->neg != b->neg;
+
+    if (!na || !nb) {
+        return _assign(r, NULL, 0, false);
+    }
+
+    // The product goes to fresh storage, so `r` may alias an operand
+    const size_t ns  = _mul_scratch(na, nb);
+    gb_limb_t   *out = _alloc_limbs(na + nb);
+    gb_limb_t   *tmp = ns ? _alloc_limbs(ns) : NULL;
+
+    if (!out || (ns && !tmp)) {
+        gb_free(out);
+        gb_free(tmp);
+        return false;
+    }
+
+    _mag_mul(out, a->limb, na, b->limb, nb, tmp);
+    gb_free(tmp);
+
+    gb_free(r->limb);
+    r->limb = out;
+    r->cap  = na + nb;
+    r->len  = na + nb;
+    r->neg  = neg;
+    _normalize(r);
+    return true;
+}
+
+bool gb_bigint_divmod(gb_bigint_t *q, gb_bigint_t *r, const gb_bigint_t *a, const gb_bigint_t *b) {
+    const size_t m = a->len;
+    const size_t n = b->len;
+
+    if (!n) {
+        return false;
+    }
+
+    const bool q_neg = a->neg != b->neg;
+    const bool r_neg = a->neg;
+
+    if (_mag_cmp(a->limb, m, b->limb, n) < 0) {
+        // |a| < |b|: the remainder is the dividend itself
+        return (!r || gb_bigint_copy(r, a)) && (!q || _assign(q, NULL, 0, false));
+    }
+
+    // Quotient, remainder and the normalized work areas in one block
+    gb_limb_t *work = _alloc_limbs((m - n + 1) + n + (m + 1) + n);
+    if (!work) {
+        return false;
+    }
+
+    gb_limb_t *qbuf = work;
+    gb_limb_t *rbuf = qbuf + (m - n + 1);
+
+    if (n == 1) {
+        gb_memcpy(qbuf, a->limb, m * sizeof(gb_limb_t));
+        rbuf[0] = _mag_div_small(qbuf, m, b->limb[0]);
+    } else {
+        gb_limb_t *un = rbuf + n;
+        gb_limb_t *vn = un + m + 1;
+
+        _mag_divmod(qbuf, rbuf, a->limb, m, b->limb, n, un, vn);
+    }
+
+    // Both results are complete before either output (which may alias an
+    // operand) is written
+    const bool ok = (!q || _assign(q, qbuf, (n == 1) ? m : (m - n + 1), q_neg)) && //
+                    (!r || _assign(r, rbuf, n, r_neg));
+
+    gb_free(work);
+    return ok;
+}
+
+bool gb_bigint_pow(gb_bigint_t *r, const gb_bigint_t *a, uint64_t e) {
+    const size_t bits = gb_bigint_bits(a);
+    const bool   neg  = a->neg && (e & 1);
+
+    if (!e || (bits == 1)) {
+        // a^0 = 1, (+-1)^e = +-1
+        const gb_limb_t one = 1;
+        return _assign(r, &one, 1, neg);
+    }
+
+    if (!bits) {
+        return _assign(r, NULL, 0, false);
+    }
+
+    if (!_pow_fits(bits, e)) {
+        return false;
+    }
+
+    gb_bigint_t base;
+    gb_bigint_t acc;
+
+    gb_bigint_init(&base);
+    gb_bigint_init(&acc);
+
+    const gb_limb_t one = 1;
+    bool            ok  = gb_bigint_copy(&base, a) && _assign(&acc, &one, 1, false);
+
+    base.neg = false;
+
+    // Left-to-right would need the top bit first; right-to-left keeps the
+    // loop trivial and does the same number of squarings
+    while (ok && e) {
+        if (e & 1) {
+            ok = gb_bigint_mul(&acc, &acc, &base);
+        }
+        e >>= 1;
+        if (ok && e) {
+            ok = gb_bigint_mul(&base, &base, &base);
+        }
+    }
+
+    if (ok) {
+        acc.neg = neg;
+        ok      = _assign(r, acc.limb, acc.len, acc.neg);
+    }
+
+    gb_bigint_free(&base);
+    gb_bigint_free(&acc);
+    return ok;
+}
+
+bool gb_bigint_calc(const char *expr, gb_bigint_t *out, gb_calc_error_t *err) {
+    if (err) {
+        err->code = GB_CALC_OK;
+        err->pos  = 0;
+        err->row  = 0;
+    }
+
+    bigint_calc_t ctx = {.err = err};
+
+    if (!expr) {
+        return _calc_fail(&ctx, GB_CALC_E_NULL_EXPR, 0);
+    }
+
+    // Every token takes at least one character, which bounds both stacks
+    const size_t len = gb_strlen(expr) + 1;
+
+    if (len > (SIZE_MAX / (sizeof(gb_bigint_t) + sizeof(size_t) + 1))) {
+        return _calc_fail(&ctx, GB_CALC_E_LIMIT, 0);
+    }
+
+    void *block = gb_malloc(len * (sizeof(gb_bigint_t) + sizeof(size_t) + 1), sizeof(void *));
+    if (!block) {
+        return _calc_fail(&ctx, GB_CALC_E_NO_MEMORY, 0);
+    }
+
+    ctx.vals = (gb_bigint_t *)block;
+    ctx.opos = (size_t *)(ctx.vals + len);
+    ctx.ops  = (char *)(ctx.opos + len);
+
+    bool ok = _calc_run(&ctx, expr);
+
+    if (ok) {
+        ok = gb_bigint_copy(out, &ctx.vals[0]) || _calc_fail(&ctx, GB_CALC_E_NO_MEMORY, 0);
+    }
+
+    for (size_t i = 0; i < ctx.nvals; ++i) {
+        gb_bigint_free(&ctx.vals[i]);
+    }
+
+    gb_free(block);
+    return ok;
+}
+
+/* *****************************************************************************
+ End of File
+ */
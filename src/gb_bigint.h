@@ -0,0 +1,211 @@
+/* ************************************************************************** */
+/*
+    @file
+        gb_bigint.h
+
+    @date
+        October, 2026
+
+    @author
+        Gino Francesco Bogo (ᛊᛟᚱᚱᛖ ᛗᛖᚨ ᛁᛊᛏᚨᛗᛁ ᚨcᚢᚱᛉᚢ)
+
+    @license
+        MIT
+ */
+/* ************************************************************************** */
+
+#ifndef GB_BIGINT_H
+#define GB_BIGINT_H
+
+#include <stdbool.h> // bool
+#include <stddef.h>  // size_t
+#include <stdint.h>  // uint32_t, uint64_t
+
+#include "gb_calc.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Macros
+// *****************************************************************************
+// *****************************************************************************
+
+// Operands of at least this many limbs are multiplied with Karatsuba
+#define GB_BIGINT_KARATSUBA 32
+
+// Largest result gb_bigint_pow() may produce, in bits
+#define GB_BIGINT_MAX_BITS (1UL << 20)
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Types
+// *****************************************************************************
+// *****************************************************************************
+
+typedef uint32_t gb_limb_t;
+
+/**
+ * @brief Arbitrary-precision integer (sign and magnitude).
+ *
+ * The magnitude is stored in base 2^32, least significant limb first, with no
+ * leading zero limbs: zero has `len == 0` and is never negative. Initialize
+ * with gb_bigint_init() and release with gb_bigint_free().
+ */
+typedef struct {
+    gb_limb_t *limb;
+    size_t     len; // limbs in use
+    size_t     cap; // limbs allocated
+    bool       neg;
+} gb_bigint_t;
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Functions
+// *****************************************************************************
+// *****************************************************************************
+
+/**
+ * @brief Initializes an integer to zero (no allocation).
+ *
+ * @param[out] x Integer to initialize.
+ */
+void gb_bigint_init(gb_bigint_t *x);
+
+/**
+ * @brief Releases the memory of an integer and resets it to zero.
+ *
+ * @param[in,out] x Integer to release.
+ */
+void gb_bigint_free(gb_bigint_t *x);
+
+/**
+ * @brief Sets an integer from a signed 64-bit value.
+ *
+ * @param[out] x     Destination.
+ * @param[in]  value Value to store.
+ *
+ * @return `true` on success, `false` if out of memory.
+ */
+bool gb_bigint_set_i64(gb_bigint_t *x, int64_t value);
+
+/**
+ * @brief Copies an integer.
+ *
+ * @param[out] dst Destination.
+ * @param[in]  src Source.
+ *
+ * @return `true` on success, `false` if out of memory.
+ */
+bool gb_bigint_copy(gb_bigint_t *dst, const gb_bigint_t *src);
+
+/**
+ * @brief Parses the digits of a non-negative integer.
+ *
+ * Powers of two are converted in linear time; base 10 is converted nine
+ * digits at a time.
+ *
+ * @param[out] x    Destination.
+ * @param[in]  str  Digits (no sign, no prefix); not necessarily terminated.
+ * @param[in]  len  Number of digits.
+ * @param[in]  base 2, 10 or 16.
+ *
+ * @return `true` on success, `false` on an empty string, an invalid digit or
+ *         out of memory.
+ */
+bool gb_bigint_from_str(gb_bigint_t *x, const char *str, size_t len, int base);
+
+/**
+ * @brief Formats an integer.
+ *
+ * Hexadecimal digits are uppercase; negative values get a leading '-'.
+ *
+ * @param[in]  x       Integer to format.
+ * @param[in]  base    2, 10 or 16.
+ * @param[out] dst     Destination buffer.
+ * @param[in]  dst_len Size of the destination buffer.
+ *
+ * @return The number of characters written (without the terminator), or 0 if
+ *         the buffer is too small or the base is not supported.
+ */
+size_t gb_bigint_to_str(const gb_bigint_t *x, int base, char *dst, size_t dst_len);
+
+/**
+ * @brief Compares two integers.
+ *
+ * @return A negative value, zero or a positive value if `a` is less than,
+ *         equal to or greater than `b`.
+ */
+int gb_bigint_cmp(const gb_bigint_t *a, const gb_bigint_t *b);
+
+/**
+ * @brief Returns the number of significant bits of the magnitude (0 for 0).
+ */
+size_t gb_bigint_bits(const gb_bigint_t *x);
+
+/**
+ * @brief Computes r = a + b (`r` may alias an operand).
+ *
+ * @return `true` on success, `false` if out of memory.
+ */
+bool gb_bigint_add(gb_bigint_t *r, const gb_bigint_t *a, const gb_bigint_t *b);
+
+/**
+ * @brief Computes r = a - b (`r` may alias an operand).
+ *
+ * @return `true` on success, `false` if out of memory.
+ */
+bool gb_bigint_sub(gb_bigint_t *r, const gb_bigint_t *a, const gb_bigint_t *b);
+
+/**
+ * @brief Computes r = a * b (`r` may alias an operand).
+ *
+ * Operands shorter than GB_BIGINT_KARATSUBA limbs use the schoolbook method;
+ * longer ones are split recursively with Karatsuba (three half-size products
+ * instead of four).
+ *
+ * @return `true` on success, `false` if out of memory.
+ */
+bool gb_bigint_mul(gb_bigint_t *r, const gb_bigint_t *a, const gb_bigint_t *b);
+
+/**
+ * @brief Computes the truncated quotient and remainder of a / b.
+ *
+ * As in C, the quotient is rounded toward zero and the remainder takes the
+ * sign of the dividend. Either output may be NULL or alias an operand.
+ *
+ * @param[out] q Quotient, or NULL.
+ * @param[out] r Remainder, or NULL.
+ * @param[in]  a Dividend.
+ * @param[in]  b Divisor (must not be zero).
+ *
+ * @return `true` on success, `false` on division by zero or out of memory.
+ */
+bool gb_bigint_divmod(gb_bigint_t *q, gb_bigint_t *r, const gb_bigint_t *a, const gb_bigint_t *b);
+
+/**
+ * @brief Computes r = a ^ e by binary exponentiation.
+ *
+ * @return `true` on success, `false` if the result would exceed
+ *         GB_BIGINT_MAX_BITS or out of memory.
+ */
+bool gb_bigint_pow(gb_bigint_t *r, const gb_bigint_t *a, uint64_t e);
+
+/**
+ * @brief Evaluates an integer expression exactly.
+ *
+ * Supports decimal, `0x` hexadecimal and `0b` binary literals, parentheses,
+ * unary `+`/`-` and the binary operators `+ - * / % ^` with the same
+ * precedence as gb_calc(). Division truncates toward zero.
+ *
+ * @param[in]  expr A null-terminated string containing the expression.
+ * @param[out] out  Result (initialized by the caller).
+ * @param[out] err  Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return `true` on success, `false` otherwise.
+ */
+bool gb_bigint_calc(const char *expr, gb_bigint_t *out, gb_calc_error_t *err);
+
+#endif // GB_BIGINT_H
+
+/* *****************************************************************************
+ End of File
+ */
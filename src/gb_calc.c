@@ -16,13 +16,20 @@
 
 #include "gb_calc.h"
 
-#include <ctype.h>   // isdigit, isspace
-#include <math.h>    // INFINITY, M_PI, acos, asin, atan, cos, exp, fmod, log, pow, sin, sqrt, tan
-#include <stdbool.h> // bool, false, true
-#include <stdio.h>   // fprintf, size_t
-#include <stdlib.h>  // strtod
+#include <fcntl.h>     // O_RDONLY, open
+#include <math.h>      // INFINITY, isfinite, M_LN2, M_PI, acos, asin, atan, cos, exp, fmod, log, pow, sin, sqrt, tan, trunc
+#include <stdatomic.h> // atomic_bool, atomic_load_explicit, atomic_store
+#include <stdbool.h>   // bool, false, true
+#include <stdint.h>    // UINT32_MAX, int32_t, uint32_t, uint64_t, uintptr_t
+#include <stdio.h>     // FILE, fclose, fopen, fprintf, fwrite, size_t, snprintf
+#include <stdlib.h>    // strtod
+#include <sys/mman.h>  // MAP_FAILED, MAP_PRIVATE, PROT_READ, mmap, munmap
+#include <sys/stat.h>  // fstat, stat
+#include <unistd.h>    // close
 
+#include "gb_fmath.h"
 #include "gb_utils.h"
+#include "gb_vmath.h"
 
 // *****************************************************************************
 // *****************************************************************************
@@ -30,628 +37,5496 @@
 // *****************************************************************************
 // *****************************************************************************
 
-#define MAX_LIFO_DEPTH 32
+/*
+    Bytecode layout: one 32-bit word per instruction.
+
+    ┌───────────────────────────────┬───────────┐
+    │ 31                          8 │ 7       0 │
+    │   argument (pool/var/reg)     │  opcode   │
+    └───────────────────────────────┴───────────┘
+
+    Operators do not use the argument: it holds the source offset of the
+    operator, which is what a run-time error reports.
+ */
+typedef uint32_t calc_insn_t;
+
+#define INSN(op, arg) ((calc_insn_t)(op) | ((calc_insn_t)(arg) << 8))
+#define INSN_OP(w)    ((w) & 0xFFU)
+#define INSN_ARG(w)   ((w) >> 8)
+#define INSN_ARG_MAX  0xFFFFFFU
+
+// Source offsets, pool indexes and registers must fit the 24-bit argument
+#define MAX_EXPR_LEN INSN_ARG_MAX
+
+// Code size past which inlined calls and reduction bodies give up (GB_CALC_E_LIMIT)
+#define MAX_INLINE_LEN 0xFFFFFU
+
+// Nesting of range reductions inside reduction bodies
+#define MAX_LOOP_DEPTH 8
+
+// Largest index span of a range reduction (beyond it `i + 1 == i`)
+#define MAX_LOOP_SPAN 9007199254740992.0
+
+// `!` and `~` work on int64_t: their operand must lie in [-2^63, 2^63)
+#define INT_OPERAND_LIMIT 9223372036854775808.0
+
+// Operand and temporary slots the scalar evaluator keeps on the C stack;
+// deeper programs run on the scratch buffer
+#define EVAL_LOCAL_SLOTS 256
+
+// Same for the rows of the batch evaluator (GB_CALC_BLOCK doubles each)
+#define BATCH_LOCAL_ROWS 16
+
+typedef enum {
+    OP_PUSH = 0, // push pool[arg]
+    OP_LOAD,     // push vars[arg]
+    OP_TEE,      // regs[arg] = top (no pop)
+    OP_REG,      // push regs[arg]
+    OP_RET,      // return top (ends the program, then each reduction body)
+    OP_SEQ,      // drop the value below top (a statement run for its errors only)
+    // unary operators
+    OP_NEG,
+    OP_NOT,
+    OP_BNOT,
+    // unary functions
+    OP_SIN,
+    OP_ASIN,
+    OP_COS,
+    OP_ACOS,
+    OP_TAN,
+    OP_ATAN,
+    OP_SQRT,
+    OP_EXP,
+    OP_LOG,
+    OP_LOG2,
+    // binary operators
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_MOD,
+    OP_POW,
+    // range reductions
+    OP_LOOP, // body header: arg = captured values (never executed)
+    OP_SKIP, // jump to the reduction at ip + arg, past its captures, if its range is empty
+    OP_SUM,  // run the body at ip + arg over the range, add up the values
+    OP_PROD,
+    OP_MIN,
+    OP_MAX,
+    OP_COUNT
+} calc_op_t;
+
+struct gb_calc_prog {
+    const calc_insn_t *code;
+    const double      *pool;
+    const double      *vars; // values of the bound symbol table (or NULL)
+    uint32_t           code_len;
+    uint32_t           pool_len;
+    uint32_t           depth; // exact operand stack depth
+    uint32_t           regs;  // temporaries holding shared subexpressions
+};
+
+typedef struct {
+    uint32_t hash;
+    uint32_t len;
+    char     name[GB_CALC_NAME_MAX + 1];
+} calc_sym_t;
+
+/*
+    User-defined function. The body is the parser output for the expression
+    (postfix code before optimization), relocated so that pool indexes and
+    locals count from 0 within the function; locals 0..nparams-1 are the
+    parameters. A call copies the body into the caller with the arguments
+    stored in fresh locals, and the optimizer then sees the inlined body as an
+    ordinary subexpression of the caller.
+ */
+typedef struct calc_func calc_func_t;
+
+struct calc_func {
+    calc_func_t       *next; // next function of a symbol table (newest first)
+    const char        *name;
+    uint32_t           name_len;
+    uint32_t           nparams;
+    uint32_t           nlocals; // parameters and locals of inlined calls
+    uint32_t           loops;   // deepest nesting of range reductions
+    uint32_t           code_len;
+    uint32_t           pool_len;
+    const calc_insn_t *code;
+    const double      *pool;
+};
+
+/*
+    Symbol table: open addressing with linear probing over a power-of-two
+    index. The index maps a hash slot to the symbol ordinal; ordinals are
+    assigned in creation order and never move, so `values[ordinal]` is a
+    stable address the caller can update in place and the bytecode can
+    reference by ordinal.
+ */
+struct gb_calc_syms {
+    uint32_t     mask;    // index capacity - 1
+    uint32_t     count;   // symbols in use
+    uint32_t     limit;   // maximum number of symbols
+    int32_t     *index;   // hash slot -> ordinal (-1 when empty)
+    calc_sym_t  *entries; // ordinal -> name
+    double      *values;  // ordinal -> value
+    calc_func_t *funcs;   // user-defined functions (gb_calc_func_def())
+};
+
+/*
+    Built-in keyword (function or constant). The keywords are stored in a
+    perfect hash table: the slot of every keyword is fixed by _hash_keyword(),
+    so a lookup is one hash and at most one name comparison.
+ */
+typedef struct {
+    uint8_t op;  // function or reduction opcode, or OP_PUSH (0) for a constant
+    size_t  len; // 0 for an empty slot
+    char    name[8];
+    double  value; // constant value
+} calc_keyword_t;
+
+#define KEYWORD_SLOTS   32
+#define KEYWORD_MAX_LEN 4
+
+/*
+    Token of the expression scanner. Numbers carry their value, every other
+    token is identified by its kind and the class of its first character.
+ */
+typedef enum {
+    TOK_INVALID = 0,
+    TOK_SPACE, // never returned: the scanner skips whitespace
+    TOK_END,
+    TOK_NUMBER,
+    TOK_IDENT,
+    TOK_OPEN,
+    TOK_CLOSE,
+    TOK_OPERATOR,
+    TOK_ASSIGN,
+    TOK_SEMI,
+    TOK_COMMA
+} calc_tok_t;
+
+/*
+    Character class: everything the scanner and the parser need to know about
+    a character, so each token costs a single table lookup.
+ */
+typedef struct {
+    uint8_t kind;   // calc_tok_t of a token starting with the character
+    uint8_t word;   // 1 if the character can continue an identifier
+    uint8_t prec;   // binding power as a binary operator (0 if not binary)
+    uint8_t binary; // binary opcode
+    uint8_t prefix; // prefix opcode (OP_PUSH if not a prefix operator)
+} calc_char_t;
+
+typedef struct {
+    calc_tok_t         kind;
+    const calc_char_t *cc;    // class of the first character
+    int                at;    // expression index
+    int                len;   // characters consumed
+    double             value; // TOK_NUMBER value
+} calc_token_t;
+
+// Operator stack markers of an open parenthesis and of the parenthesis of a
+// user function call or range reduction (the other entries are opcodes)
+#define PARSE_PAREN ((uint8_t)OP_COUNT)
+#define PARSE_CALL  ((uint8_t)(OP_COUNT + 1))
+
+/*
+    Expression node used by the optimizer. Nodes are created in postfix order,
+    so every operand has a lower index than the operator that consumes it.
+    Structurally identical nodes are shared, turning the tree into a DAG.
+ */
+typedef struct {
+    calc_op_t op;
+    int32_t   a;     // first operand node (-1 if none)
+    int32_t   b;     // second operand node (-1 if none)
+    uint32_t  arg;   // OP_LOAD ordinal, OP_LOOP serial number
+    double    value; // OP_PUSH constant
+    uint32_t  loops; // bit d: depends on the index of a reduction nested d deep
+    int32_t   uses;  // number of consumers in the same code segment
+    int32_t   slot;  // pool index (constants) or register (shared operations)
+    int32_t   cap;   // register in the body being emitted (captured values)
+    int32_t   mark;  // last capture scan that reached the node
+    uint32_t  pos;   // source offset of the operator (not part of the identity)
+    bool      fails; // the operation or one of its operands can raise an error
+    bool      sure;  // computed whatever the reduction ranges
+    bool      cond;  // needed by captures that are skipped on an empty range
+    int32_t   zone;  // OP_SKIP guarding the code that saved the register, or -1
+    int32_t   skip;  // OP_SKIP guarding the captures of a reduction, or -1
+} calc_node_t;
+
+/*
+    Statement value of a multi-statement program. Every statement but the last
+    gets one, named after the variable it assigns (`len` is 0 for a plain
+    expression statement). The optimizer binds it to the node of the value, so
+    a later reference is the same DAG node and shares its register.
+ */
+typedef struct {
+    int     at;   // source offset of the name
+    int     len;  // name length
+    int32_t node; // value node (optimizer)
+    bool    stmt; // a statement value (not a parameter or a reduction index)
+} calc_local_t;
+
+// Function definition being parsed (see _parse_head())
+typedef struct {
+    int at;      // source offset of the name
+    int len;     // name length
+    int nparams; // parameters
+    int code;    // start of the body code, or -1 outside a definition
+    int pool;    // start of the body constants
+} calc_def_t;
 
+// User function call or range reduction whose arguments are being parsed
 typedef struct {
-    const char *expr;
-    double      num_lifo[MAX_LIFO_DEPTH];
-    int         num_top;
-    char        op__lifo[MAX_LIFO_DEPTH];
-    int         op__top;
-    int         i;
+    const calc_func_t *func;  // NULL for a reduction
+    calc_op_t          op;    // reduction opcode
+    int                at;    // source offset of the name
+    int                nargs; // arguments completed so far
+    int                local; // reduction index variable
+    int                len;   // length of its name
+} calc_call_t;
+
+/*
+    Compiler context. The arrays are carved from the per-thread scratch buffer
+    and sized from the source length `n`: every character emits at most one
+    instruction, one pool entry, one operator or one operand, and the
+    optimizer never grows the code beyond the final OP_RET. So `n + 1`
+    entries (`cap`) are always enough and no bound is ever hit mid-parse,
+    except by user function calls, whose bodies are copied into the code, and
+    by the code segments of reduction bodies (`grown`): _compile_expr() then
+    starts over with larger arrays.
+ */
+typedef struct {
+    const char      *expr; // source expression (not necessarily terminated)
+    int              len;  // source length
+    gb_calc_syms_t  *syms;
+    gb_calc_error_t *err;
+    int              cap;     // capacity of every per-token array
+    int              num_top; // simulated operand stack top
+    int              num_max; // deepest operand stack top reached
+    uint8_t         *op__lifo; // calc_op_t or PARSE_PAREN
+    int             *op__pos; // expression index of each operator
+    int              op__top;
+    int              i;
+    calc_local_t    *locals; // statement values, in source order
+    int              local_len;
+    int              local_min; // first visible local (the parameters in a body)
+    calc_func_t     *funcs;     // functions defined by the program
+    int              func_len;
+    calc_insn_t     *fcode; // bodies of the program functions
+    int              fcode_len;
+    double          *fpool; // constants of the program functions
+    int              fpool_len;
+    calc_call_t     *calls; // open user function calls and reductions
+    int              call_top;
+    int              loop_depth; // reduction bodies being parsed
+    int              loop_max;   // deepest nesting in the current definition
+    bool             grown;      // code grew past the source length (see _compile_expr)
+    calc_insn_t     *code;
+    int              code_len;
+    double          *pool;
+    int              pool_len;
+    calc_node_t     *nodes;
+    int              node_len;
+    int32_t         *node_hash; // hash-consing index (load factor <= 50%)
+    uint32_t         hash_mask;
+    int32_t         *work_node; // optimizer work stack: node
+    int8_t          *work_done; // optimizer work stack: operands emitted
+    char            *digits;    // terminated copy of a long numeric literal
+    int32_t         *scan_node; // capture scan stack
+    int32_t         *capt;      // captured values of a reduction body
+    int32_t         *bodies;    // reductions whose body is still to emit
+    int              body_len;
+    int32_t          scan_len; // capture scans so far
+    int              reg_len;
 } calc_context_t;
 
+/*
+    Result cache entry. Keys are the expression without redundant whitespace,
+    stored in full so a hash collision can never return a wrong value; longer
+    expressions are simply not cached. Entries are linked both in a hash
+    bucket chain and in the LRU list (most recent at the head).
+ */
+#define CACHE_KEY_MAX 95
+
+typedef struct {
+    double   value;
+    uint32_t hash;
+    int32_t  prev;  // more recently used entry (-1 at the head)
+    int32_t  next;  // less recently used entry (-1 at the tail)
+    int32_t  chain; // next entry in the same bucket (-1 at the end)
+    uint8_t  len;
+    char     key[CACHE_KEY_MAX];
+} calc_cache_entry_t;
+
+struct gb_calc_cache {
+    uint32_t            mask;    // bucket count - 1
+    uint32_t            count;   // entries in use
+    uint32_t            limit;   // maximum number of entries
+    int32_t             head;    // most recently used entry
+    int32_t             tail;    // least recently used entry
+    int32_t            *buckets; // hash -> first entry (-1 when empty)
+    calc_cache_entry_t *entries;
+    size_t              hits;
+    size_t              misses;
+    size_t              bytes; // size of the single allocation
+};
+
+/*
+    Program library image: a versioned, position-independent snapshot of
+    compiled programs, meant to be mapped read-only and used in place.
+
+    ┌──────────┬───────────────────┬─────────────────┬──────────┬──────────┐
+    │  header  │ names[nsyms][32]  │ entries[count]  │  pools   │   code   │
+    └──────────┴───────────────────┴─────────────────┴──────────┴──────────┘
+
+    Every integer is a 32-bit word in the byte order of the writer (the
+    `endian` marker rejects a foreign one). Offsets are relative to the image
+    start; pools are 8-byte aligned, code words 4-byte aligned. The names are
+    the variables the programs load, in ordinal order. Bump LIB_VERSION
+    whenever the opcode numbering or the layout changes.
+ */
+#define LIB_MAGIC   "GBCL"
+#define LIB_VERSION 4
+#define LIB_ENDIAN  0x0102U
+
+typedef struct {
+    char     magic[4];
+    uint16_t version;
+    uint16_t endian;
+    uint32_t size;  // image size in bytes
+    uint32_t count; // number of programs
+    uint32_t nsyms; // number of variable names
+    uint32_t reserved;
+} calc_lib_header_t;
+
+typedef struct {
+    uint32_t code_off;
+    uint32_t code_len;
+    uint32_t pool_off;
+    uint32_t pool_len;
+    uint32_t depth;
+    uint32_t regs;
+} calc_lib_entry_t;
+
+typedef char calc_lib_name_t[GB_CALC_NAME_MAX + 1];
+
+/*
+    Loaded library: one allocation holds the handle and the program headers,
+    which point straight into the image. The symbol table is rebuilt from the
+    stored names, so every ordinal in the code matches its variable.
+ */
+struct gb_calc_lib {
+    gb_calc_prog_t *progs;
+    gb_calc_syms_t *syms;
+    uint32_t        count;
+    void           *map;     // file mapping (gb_calc_lib_open() only)
+    size_t          map_len; // length of the mapping
+};
+
+/*
+    Scratch memory of the calling thread. It is either owned by the library,
+    and then grown on demand and reused by every later call, or supplied by
+    the caller through gb_calc_scratch(), and then never reallocated.
+    Evaluations in progress hold its first `used` bytes (see _scratch_push()).
+ */
+typedef struct {
+    unsigned char *base;
+    size_t         size;
+    size_t         used;     // bytes held by the evaluations in progress
+    int            kept;     // outgrown buffers still held (see _scratch_push())
+    bool           borrowed; // supplied by the caller
+} calc_scratch_t;
+
 // *****************************************************************************
 // *****************************************************************************
-// Local Functions
+// Local Variables
 // *****************************************************************************
 // *****************************************************************************
 
-static bool _apply_unary_op(calc_context_t *ctx, double num) {
-    bool result = false;
+static _Thread_local calc_scratch_t calc_scratch;
 
-    if (ctx->op__top >= 0) {
-        // Process unary operator (extended ID)
-        char op = (char)((unsigned int)ctx->op__lifo[ctx->op__top] - 128);
+// Table-driven elementary functions (see gb_calc_fast_math())
+static atomic_bool calc_fast_math;
 
-        switch (op) {
-            case '-': {
-                if (ctx->num_top >= MAX_LIFO_DEPTH - 1) {
-                    return false;
-                }
-                ctx->num_lifo[++ctx->num_top] = -num;
-                ctx->op__top--;
-                result = true;
-            } break;
+/*
+    Perfect hash table of the keywords, indexed by _hash_keyword(). The hash
+    multipliers were found by an offline search over the keyword set: when a
+    keyword is added, search again for multipliers (or a larger table) that
+    keep every slot distinct, and move the entries to their new slots.
+ */
+// clang-format off
+static const calc_keyword_t calc_keywords[KEYWORD_SLOTS] = {
+    [ 0] = {OP_LOG,  3, "log",  0   },
+    [ 1] = {OP_PUSH, 2, "pi",   M_PI},
+    [ 3] = {OP_MAX,  3, "max",  0   },
+    [ 5] = {OP_PUSH, 1, "e",    M_E },
+    [ 6] = {OP_TAN,  3, "tan",  0   },
+    [ 9] = {OP_LOG2, 4, "log2", 0   },
+    [13] = {OP_SUM,  3, "sum",  0   },
+    [14] = {OP_ASIN, 4, "asin", 0   },
+    [18] = {OP_PROD, 4, "prod", 0   },
+    [19] = {OP_COS,  3, "cos",  0   },
+    [21] = {OP_ATAN, 4, "atan", 0   },
+    [25] = {OP_SIN,  3, "sin",  0   },
+    [26] = {OP_SQRT, 4, "sqrt", 0   },
+    [27] = {OP_MIN,  3, "min",  0   },
+    [28] = {OP_EXP,  3, "exp",  0   },
+    [30] = {OP_ACOS, 4, "acos", 0   },
+};
 
-            case '!': {
-                if (ctx->num_top >= MAX_LIFO_DEPTH - 1) {
-                    return false;
-                }
-                ctx->num_lifo[++ctx->num_top] = !(int)num;
-                ctx->op__top--;
-                result = true;
-            } break;
+// Character classes, indexed by the unsigned character (zero: invalid)
+#define CC_DIGIT {TOK_NUMBER, 1, 0, 0, OP_PUSH}
+#define CC_ALPHA {TOK_IDENT,  1, 0, 0, OP_PUSH}
 
-            case '~': {
-                if (ctx->num_top >= MAX_LIFO_DEPTH - 1) {
-                    return false;
-                }
-                ctx->num_lifo[++ctx->num_top] = ~((int)num);
-                ctx->op__top--;
-                result = true;
-            } break;
+static const calc_char_t calc_chars[256] = {
+    [' ']  = {TOK_SPACE,    0, 0, 0,      OP_PUSH},
+    ['\t'] = {TOK_SPACE,    0, 0, 0,      OP_PUSH},
+    ['\n'] = {TOK_SPACE,    0, 0, 0,      OP_PUSH},
+    ['\v'] = {TOK_SPACE,    0, 0, 0,      OP_PUSH},
+    ['\f'] = {TOK_SPACE,    0, 0, 0,      OP_PUSH},
+    ['\r'] = {TOK_SPACE,    0, 0, 0,      OP_PUSH},
+    ['(']  = {TOK_OPEN,     0, 0, 0,      OP_PUSH},
+    [')']  = {TOK_CLOSE,    0, 0, 0,      OP_PUSH},
+    ['=']  = {TOK_ASSIGN,   0, 0, 0,      OP_PUSH},
+    [';']  = {TOK_SEMI,     0, 0, 0,      OP_PUSH},
+    [',']  = {TOK_COMMA,    0, 0, 0,      OP_PUSH},
+    ['+']  = {TOK_OPERATOR, 0, 1, OP_ADD, OP_PUSH},
+    ['-']  = {TOK_OPERATOR, 0, 1, OP_SUB, OP_NEG },
+    ['*']  = {TOK_OPERATOR, 0, 2, OP_MUL, OP_PUSH},
+    ['/']  = {TOK_OPERATOR, 0, 2, OP_DIV, OP_PUSH},
+    ['%']  = {TOK_OPERATOR, 0, 2, OP_MOD, OP_PUSH},
+    ['^']  = {TOK_OPERATOR, 0, 3, OP_POW, OP_PUSH},
+    ['!']  = {TOK_OPERATOR, 0, 0, 0,      OP_NOT },
+    ['~']  = {TOK_OPERATOR, 0, 0, 0,      OP_BNOT},
+    ['.']  = {TOK_NUMBER,   0, 0, 0,      OP_PUSH},
+    ['0'] = CC_DIGIT, ['1'] = CC_DIGIT, ['2'] = CC_DIGIT, ['3'] = CC_DIGIT, ['4'] = CC_DIGIT,
+    ['5'] = CC_DIGIT, ['6'] = CC_DIGIT, ['7'] = CC_DIGIT, ['8'] = CC_DIGIT, ['9'] = CC_DIGIT,
+    ['A'] = CC_ALPHA, ['B'] = CC_ALPHA, ['C'] = CC_ALPHA, ['D'] = CC_ALPHA, ['E'] = CC_ALPHA, ['F'] = CC_ALPHA,
+    ['G'] = CC_ALPHA, ['H'] = CC_ALPHA, ['I'] = CC_ALPHA, ['J'] = CC_ALPHA, ['K'] = CC_ALPHA, ['L'] = CC_ALPHA,
+    ['M'] = CC_ALPHA, ['N'] = CC_ALPHA, ['O'] = CC_ALPHA, ['P'] = CC_ALPHA, ['Q'] = CC_ALPHA, ['R'] = CC_ALPHA,
+    ['S'] = CC_ALPHA, ['T'] = CC_ALPHA, ['U'] = CC_ALPHA, ['V'] = CC_ALPHA, ['W'] = CC_ALPHA, ['X'] = CC_ALPHA,
+    ['Y'] = CC_ALPHA, ['Z'] = CC_ALPHA,
+    ['a'] = CC_ALPHA, ['b'] = CC_ALPHA, ['c'] = CC_ALPHA, ['d'] = CC_ALPHA, ['e'] = CC_ALPHA, ['f'] = CC_ALPHA,
+    ['g'] = CC_ALPHA, ['h'] = CC_ALPHA, ['i'] = CC_ALPHA, ['j'] = CC_ALPHA, ['k'] = CC_ALPHA, ['l'] = CC_ALPHA,
+    ['m'] = CC_ALPHA, ['n'] = CC_ALPHA, ['o'] = CC_ALPHA, ['p'] = CC_ALPHA, ['q'] = CC_ALPHA, ['r'] = CC_ALPHA,
+    ['s'] = CC_ALPHA, ['t'] = CC_ALPHA, ['u'] = CC_ALPHA, ['v'] = CC_ALPHA, ['w'] = CC_ALPHA, ['x'] = CC_ALPHA,
+    ['y'] = CC_ALPHA, ['z'] = CC_ALPHA,
+    ['_'] = CC_ALPHA,
+};
 
-            default: {
-                // Not a unary operator
-            }
+#undef CC_DIGIT
+#undef CC_ALPHA
+
+// Binding power of the operators on the operator stack (0 for the markers).
+// A prefix operator only stays on the stack right after '^' (see
+// _apply_prefix()), where it covers the whole right-hand power.
+static const uint8_t calc_prec_op[OP_COUNT + 2] = {
+    [OP_ADD] = 1, [OP_SUB] = 1,
+    [OP_MUL] = 2, [OP_DIV] = 2, [OP_MOD] = 2,
+    [OP_POW] = 3, [OP_NEG] = 3, [OP_NOT] = 3, [OP_BNOT] = 3,
+};
+// clang-format on
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (Symbols)
+// *****************************************************************************
+// *****************************************************************************
+
+static inline bool _is_unary_opcode(calc_op_t op) {
+    return (op >= OP_NEG) && (op <= OP_LOG2);
+}
+
+static inline bool _is_prefix_opcode(calc_op_t op) {
+    return (op >= OP_NEG) && (op <= OP_BNOT);
+}
+
+static inline bool _is_binary_opcode(calc_op_t op) {
+    return (op >= OP_ADD) && (op <= OP_POW);
+}
+
+static inline bool _is_reduce_opcode(calc_op_t op) {
+    return (op >= OP_SUM) && (op <= OP_MAX);
+}
+
+// Operations that test their operands at run time (see _run_prog())
+static inline bool _is_checked_opcode(calc_op_t op) {
+    return (op == OP_NOT) || (op == OP_BNOT) || (op == OP_SQRT) || (op == OP_LOG) || (op == OP_LOG2) ||
+           (op == OP_DIV) || (op == OP_MOD) || _is_reduce_opcode(op);
+}
+
+// Operand of `!` and `~` that converts to int64_t (NaN and infinities do not)
+static inline bool _is_int_operand(double x) {
+    return (x >= -INT_OPERAND_LIMIT) && (x < INT_OPERAND_LIMIT);
+}
+
+static inline bool _is_ident_head(char ch) {
+    return calc_chars[(unsigned char)ch].kind == TOK_IDENT;
+}
+
+static inline bool _is_ident_tail(char ch) {
+    return calc_chars[(unsigned char)ch].word != 0;
+}
+
+/**
+ * @brief FNV-1a hash of a name that is not necessarily null-terminated.
+ */
+static uint32_t _hash_name(const char *name, size_t len) {
+    uint32_t hash = 2166136261U;
+
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Compares two names of known, equal length.
+ *
+ * Identifiers are a handful of bytes long, so a plain byte loop beats the
+ * word-at-a-time gb_strncmp set-up cost here.
+ */
+static inline bool _name_equals(const char *a, const char *b, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Perfect hash of a keyword: first two characters and length.
+ */
+static inline uint32_t _hash_keyword(const char *name, size_t len) {
+    const uint32_t c0 = (unsigned char)name[0];
+    const uint32_t c1 = (unsigned char)name[len > 1];
+
+    return ((5 * c0) + (7 * c1) + (9 * (uint32_t)len)) & (KEYWORD_SLOTS - 1);
+}
+
+static const calc_keyword_t *_find_keyword(const char *name, size_t len) {
+    if ((len == 0) || (len > KEYWORD_MAX_LEN)) {
+        return NULL;
+    }
+
+    const calc_keyword_t *kw = &calc_keywords[_hash_keyword(name, len)];
+
+    return ((kw->len == len) && _name_equals(name, kw->name, len)) ? kw : NULL;
+}
+
+static const calc_keyword_t *_find_func(const char *name, size_t len) {
+    const calc_keyword_t *kw = _find_keyword(name, len);
+
+    return (kw && _is_unary_opcode((calc_op_t)kw->op)) ? kw : NULL;
+}
+
+/**
+ * @brief Finds the hash slot of a symbol.
+ *
+ * @return The index slot holding the symbol, or the empty slot where it would
+ *         be inserted.
+ */
+static uint32_t _syms_slot(const gb_calc_syms_t *syms, const char *name, size_t len, uint32_t hash) {
+    uint32_t slot = hash & syms->mask;
+
+    for (;;) {
+        const int32_t ord = syms->index[slot];
+
+        if (ord < 0) {
+            return slot;
+        }
+
+        const calc_sym_t *sym = &syms->entries[ord];
+
+        if ((sym->hash == hash) && (sym->len == len) && _name_equals(sym->name, name, len)) {
+            return slot;
         }
+
+        slot = (slot + 1) & syms->mask;
+    }
+}
+
+static int32_t _syms_lookup(const gb_calc_syms_t *syms, const char *name, size_t len) {
+    if (!syms || (len > GB_CALC_NAME_MAX)) {
+        return -1;
     }
 
-    return result;
+    const uint32_t hash = _hash_name(name, len);
+
+    return syms->index[_syms_slot(syms, name, len, hash)];
 }
 
-static bool _apply_unary_func(calc_context_t *ctx, double num) {
-    bool result = false;
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (Scratch)
+// *****************************************************************************
+// *****************************************************************************
+
+static inline size_t _align_up(size_t size) {
+    return (size + sizeof(double) - 1) & ~(sizeof(double) - 1);
+}
 
-    if (ctx->op__top >= 0) {
-        if (ctx->num_top >= MAX_LIFO_DEPTH - 1) {
-            return false;
+static inline uint32_t _hash_slots(size_t cap) {
+    uint32_t slots = 2;
+    while (slots < 2 * cap) {
+        slots <<= 1;
+    }
+    return slots;
+}
+
+/**
+ * @brief Returns the scratch bytes needed to compile an expression.
+ *
+ * @param[in] cap Capacity of the per-token arrays (source length + 1).
+ */
+static size_t _compile_scratch(size_t cap) {
+    return _align_up(cap * sizeof(calc_node_t)) +          // nodes
+           _align_up(cap * sizeof(double)) +               // pool
+           _align_up(cap * sizeof(calc_insn_t)) +          // code
+           _align_up(cap * sizeof(int)) +                  // op__pos
+           _align_up(cap * sizeof(int32_t)) +              // work_node
+           _align_up(cap * sizeof(calc_local_t)) +         // locals
+           _align_up(cap * sizeof(calc_func_t)) +          // funcs
+           _align_up(cap * sizeof(calc_insn_t)) +          // fcode
+           _align_up(cap * sizeof(double)) +               // fpool
+           _align_up(cap * sizeof(calc_call_t)) +          // calls
+           _align_up(cap * sizeof(int32_t)) * 3 +          // scan_node, capt, bodies
+           _align_up(_hash_slots(cap) * sizeof(int32_t)) + // node_hash
+           _align_up(cap) * 3;                             // op__lifo, work_done, digits
+}
+
+/**
+ * @brief Returns at least `size` bytes of scratch memory for this thread.
+ *
+ * The memory is reused by every call: the library-owned buffer only grows
+ * (geometrically) when a larger expression shows up, so in steady state no
+ * call allocates. A caller-supplied buffer is never replaced.
+ *
+ * @return The scratch base (aligned for doubles), or NULL if the memory is
+ *         not available.
+ */
+static void *_scratch_reserve(size_t size) {
+    calc_scratch_t *scratch = &calc_scratch;
+
+    if (size <= scratch->size) {
+        return scratch->base;
+    }
+
+    if (scratch->borrowed) {
+        return NULL;
+    }
+
+    const size_t   grow = GB_MAX(size, 2 * scratch->size);
+    unsigned char *base = gb_malloc(grow, sizeof(double));
+
+    if (!base) {
+        return NULL;
+    }
+
+    gb_free(scratch->base);
+    scratch->base = base;
+    scratch->size = grow;
+
+    return base;
+}
+
+/**
+ * @brief Takes `size` bytes of scratch memory above those held by the
+ * evaluations in progress, so that a reduction body can run nested in them.
+ *
+ * Held memory must not move: when the buffer has to grow meanwhile, the old
+ * one is linked from the start of the new one (below `used`, so never handed
+ * out again) and released with the last evaluation, by _scratch_pop().
+ *
+ * @return The memory (aligned for doubles), or NULL if it is not available.
+ */
+static void *_scratch_push(size_t size) {
+    calc_scratch_t *scratch = &calc_scratch;
+    const size_t    used    = scratch->used;
+    const size_t    need    = used + _align_up(size);
+
+    if (need > scratch->size) {
+        if (scratch->borrowed) {
+            return NULL;
         }
-        switch (ctx->op__lifo[ctx->op__top]) {
-            case 's': { // sin
-                ctx->num_lifo[++ctx->num_top] = sin(num);
-                ctx->op__top--;
-                result = true;
-            } break;
 
-            case 'S': { // asin
-                ctx->num_lifo[++ctx->num_top] = asin(num);
-                ctx->op__top--;
-                result = true;
-            } break;
+        const size_t   grow = GB_MAX(need, 2 * scratch->size);
+        unsigned char *base = gb_malloc(grow, sizeof(double));
+
+        if (!base) {
+            return NULL;
+        }
+
+        if (used > 0) {
+            *(unsigned char **)(void *)base = scratch->base;
+            scratch->kept++;
+        } else {
+            gb_free(scratch->base);
+        }
+
+        scratch->base = base;
+        scratch->size = grow;
+    }
+
+    scratch->used = need;
+    return scratch->base + used;
+}
+
+/**
+ * @brief Releases the memory of the last _scratch_push() of `size` bytes.
+ */
+static void _scratch_pop(size_t size) {
+    calc_scratch_t *scratch = &calc_scratch;
+
+    scratch->used -= _align_up(size);
+
+    if (scratch->used == 0) {
+        unsigned char *old = scratch->base;
+
+        for (; scratch->kept > 0; scratch->kept--) {
+            unsigned char *prev = *(unsigned char **)(void *)old;
+
+            if (old != scratch->base) {
+                gb_free(old);
+            }
+            old = prev;
+        }
+
+        if (old != scratch->base) {
+            gb_free(old);
+        }
+    }
+}
+
+static inline void *_scratch_take(unsigned char **cursor, size_t size) {
+    void *ptr = *cursor;
+    *cursor += _align_up(size);
+    return ptr;
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (Compiler)
+// *****************************************************************************
+// *****************************************************************************
+
+/**
+ * @brief Records a compile-time error, unless one is already recorded.
+ *
+ * @param[in,out] ctx  Compiler context.
+ * @param[in]     code Error code.
+ * @param[in]     at   Offset in the source expression.
+ *
+ * @return Always `false`, so callers can return it directly.
+ */
+static bool _set_error(calc_context_t *ctx, gb_calc_errno_t code, int at) {
+    if (ctx->err->code == GB_CALC_OK) {
+        ctx->err->code = code;
+        ctx->err->pos  = (size_t)at;
+        ctx->err->row  = 0;
+    }
+    return false;
+}
+
+static bool _emit_op(calc_context_t *ctx, calc_op_t op, int at) {
+    if (ctx->code_len >= ctx->cap) {
+        return _set_error(ctx, GB_CALC_E_LIMIT, at);
+    }
+    ctx->code[ctx->code_len++] = INSN(op, GB_MIN((uint32_t)at, INSN_ARG_MAX));
+    return true;
+}
+
+static bool _emit_push(calc_context_t *ctx, double num) {
+    if ((ctx->num_top >= ctx->cap - 1) || //
+        (ctx->code_len >= ctx->cap) ||    //
+        (ctx->pool_len >= ctx->cap)) {
+        return _set_error(ctx, GB_CALC_E_LIMIT, ctx->i);
+    }
+
+    ctx->pool[ctx->pool_len]   = num;
+    ctx->code[ctx->code_len++] = INSN(OP_PUSH, ctx->pool_len);
+    ctx->pool_len++;
+
+    if (++ctx->num_top > ctx->num_max) {
+        ctx->num_max = ctx->num_top;
+    }
+    return true;
+}
+
+static bool _emit_load(calc_context_t *ctx, int32_t ord) {
+    if ((ctx->num_top >= ctx->cap - 1) || (ctx->code_len >= ctx->cap)) {
+        return _set_error(ctx, GB_CALC_E_LIMIT, ctx->i);
+    }
+
+    ctx->code[ctx->code_len++] = INSN(OP_LOAD, ord);
+
+    if (++ctx->num_top > ctx->num_max) {
+        ctx->num_max = ctx->num_top;
+    }
+    return true;
+}
+
+/**
+ * @brief Emits a reference to a statement value (OP_REG before optimization).
+ */
+static bool _emit_local(calc_context_t *ctx, int k) {
+    if ((ctx->num_top >= ctx->cap - 1) || (ctx->code_len >= ctx->cap)) {
+        return _set_error(ctx, GB_CALC_E_LIMIT, ctx->i);
+    }
+
+    ctx->code[ctx->code_len++] = INSN(OP_REG, k);
+
+    if (++ctx->num_top > ctx->num_max) {
+        ctx->num_max = ctx->num_top;
+    }
+    return true;
+}
+
+static bool _push_op(calc_context_t *ctx, uint8_t op, int at) {
+    if (ctx->op__top >= ctx->cap - 1) {
+        return _set_error(ctx, GB_CALC_E_LIMIT, at);
+    }
+
+    ctx->op__top++;
+    ctx->op__lifo[ctx->op__top] = op;
+    ctx->op__pos[ctx->op__top]  = at;
+    return true;
+}
+
+// Powers of ten that are exact in a double (fast path of _scan_number())
+static const double calc_pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/**
+ * @brief Converts a number with strtod().
+ *
+ * strtod() needs a terminated string and the source buffer may go on past the
+ * expression, so the literal is copied first. The copy covers every character
+ * strtod() could accept (digits, letters, '.', and a sign after an exponent
+ * marker), which is at most a few dozen bytes for any sensible literal. Longer
+ * ones go to `spill`, which holds the whole expression, so nothing is
+ * allocated here.
+ *
+ * @param[in]  cp    Start of the number.
+ * @param[in]  avail Characters left in the expression.
+ * @param[out] spill Buffer of at least `avail + 1` characters.
+ * @param[out] len   Characters consumed (0 if `cp` is not a number).
+ *
+ * @return The value.
+ */
+static double _strtod_n(const char *cp, int avail, char *spill, int *len) {
+    int n = 0;
+
+    while ((n < avail) && ((calc_chars[(unsigned char)cp[n]].kind == TOK_NUMBER) || _is_ident_tail(cp[n]) ||
+                           (((cp[n] == '+') || (cp[n] == '-')) && (n > 0) &&
+                            ((cp[n - 1] | 0x20) == 'e' || (cp[n - 1] | 0x20) == 'p')))) {
+        n++;
+    }
+
+    char  local[64];
+    char *buf = (n < (int)sizeof(local)) ? local : spill;
+
+    gb_memcpy(buf, cp, (size_t)n);
+    buf[n] = '\0';
+
+    char        *ep;
+    const double value = strtod(buf, &ep);
+
+    *len = (int)(ep - buf);
+    return value;
+}
+
+/**
+ * @brief Converts the number at the start of `cp`.
+ *
+ * Plain decimals (`42`, `0.125`) with at most 15 significant digits are
+ * converted in the scanning loop itself: the digits fit a 53-bit mantissa and
+ * the power of ten is exact, so one correctly rounded division gives the same
+ * value as strtod(). Exponents, hexadecimal and longer literals fall back to
+ * strtod().
+ *
+ * @param[in]  cp    Start of the number (a digit or '.').
+ * @param[in]  avail Characters left in the expression.
+ * @param[out] spill Buffer of at least `avail + 1` characters (for strtod()).
+ * @param[out] len   Characters consumed (0 if `cp` is not a number).
+ *
+ * @return The value.
+ */
+static double _scan_number(const char *cp, int avail, char *spill, int *len) {
+    uint64_t mant   = 0;
+    int      digits = 0; // significant digits
+    int      frac   = 0; // digits after the point
+    bool     point  = false;
+    int      n      = 0;
+
+    for (; (n < avail) && (calc_chars[(unsigned char)cp[n]].kind == TOK_NUMBER); ++n) {
+        if (cp[n] == '.') {
+            if (point) {
+                break;
+            }
+            point = true;
+            continue;
+        }
+
+        mant = (mant * 10U) + (uint64_t)(cp[n] - '0');
+        digits += (mant != 0);
+        frac += point;
+    }
+
+    if ((n > (cp[0] == '.')) && (digits <= 15) && (frac < (int)SIZE_OF(calc_pow10)) &&
+        ((n == avail) || !_is_ident_tail(cp[n]))) {
+        *len = n;
+        return (double)mant / calc_pow10[frac];
+    }
+
+    return _strtod_n(cp, avail, spill, len);
+}
+
+/**
+ * @brief Scans the token at the current position and advances past it.
+ *
+ * This is the only place that classifies characters: one calc_chars[] lookup
+ * selects the token kind, and the parser reads the operator properties from
+ * the same entry. Whitespace is skipped here, so the parser works directly on
+ * the caller's buffer and token offsets are source offsets.
+ *
+ * @param[in,out] ctx Compiler context.
+ * @param[out]    tok Scanned token.
+ */
+static void _scan_token(calc_context_t *ctx, calc_token_t *tok) {
+    const calc_char_t *cc = NULL;
+    int                i  = ctx->i;
+
+    while ((i < ctx->len) && ((cc = &calc_chars[(unsigned char)ctx->expr[i]])->kind == TOK_SPACE)) {
+        i++;
+    }
+
+    const char *cp    = &ctx->expr[i];
+    const int   avail = ctx->len - i;
+
+    tok->kind = (avail > 0) ? (calc_tok_t)cc->kind : TOK_END;
+    tok->cc   = cc;
+    tok->at   = i;
+    tok->len  = 1;
+
+    switch (tok->kind) {
+        case TOK_NUMBER: {
+            tok->value = _scan_number(cp, avail, ctx->digits, &tok->len);
+
+            if (tok->len == 0) {
+                tok->kind = TOK_INVALID; // a lone '.'
+                tok->len  = 1;
+            }
+        } break;
+
+        case TOK_IDENT:
+            while ((tok->len < avail) && _is_ident_tail(cp[tok->len])) {
+                tok->len++;
+            }
+            break;
+
+        case TOK_END:
+            tok->len = 0;
+            break;
+
+        default:
+            break; // single-character token
+    }
+
+    ctx->i = i + tok->len;
+}
+
+/**
+ * @brief Returns `true` if the prefix operators from `k` down sit right after
+ * a '^'.
+ */
+static bool _follows_pow(const calc_context_t *ctx, int k) {
+    while ((k >= 0) && _is_prefix_opcode((calc_op_t)ctx->op__lifo[k])) {
+        k--;
+    }
+    return (k >= 0) && (ctx->op__lifo[k] == OP_POW);
+}
+
+/**
+ * @brief Emits the prefix operators and functions waiting for the operand
+ * that was just completed.
+ *
+ * Prefix entries bind tighter than any binary operator, so `-x^2` is `(-x)^2`,
+ * `sin x^2` is `(sin x)^2` and `-sqrt(x)^2` is `(-sqrt(x))^2`. The exception
+ * is a prefix operator right after '^': it stays on the stack and covers the
+ * whole right-hand power, so `2^-x^2` is `2^-(x^2)`.
+ */
+static bool _apply_prefix(calc_context_t *ctx) {
+    while ((ctx->op__top >= 0) && _is_unary_opcode((calc_op_t)ctx->op__lifo[ctx->op__top])) {
+        const calc_op_t op = (calc_op_t)ctx->op__lifo[ctx->op__top];
+
+        if (_is_prefix_opcode(op) && _follows_pow(ctx, ctx->op__top)) {
+            break; // emitted by _reduce_op() with the power
+        }
+
+        const int at = ctx->op__pos[ctx->op__top--];
+
+        if (!_emit_op(ctx, op, at)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Emits the binary operator (or the prefix operator left after '^') on
+ * top of the operator stack.
+ */
+static bool _reduce_op(calc_context_t *ctx) {
+    const calc_op_t op = (calc_op_t)ctx->op__lifo[ctx->op__top];
+    const int       at = ctx->op__pos[ctx->op__top--];
+
+    if (!_emit_op(ctx, op, at)) {
+        return false;
+    }
+
+    if (_is_binary_opcode(op)) {
+        ctx->num_top--; // Two operands in, one result out
+    }
+    return true;
+}
+
+/**
+ * @brief Finds a user function: the program's own definitions first (latest
+ * wins), then those of the symbol table.
+ */
+static const calc_func_t *_find_user_func(const calc_context_t *ctx, const char *name, size_t len) {
+    for (int k = ctx->func_len - 1; k >= 0; --k) {
+        const calc_func_t *func = &ctx->funcs[k];
+
+        if ((func->name_len == len) && _name_equals(name, func->name, len)) {
+            return func;
+        }
+    }
+
+    for (const calc_func_t *func = ctx->syms ? ctx->syms->funcs : NULL; func; func = func->next) {
+        if ((func->name_len == len) && _name_equals(name, func->name, len)) {
+            return func;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Reports reductions nested too deeply, which larger arrays would not
+ * fix (see _compile_expr()).
+ */
+static bool _loop_limit(calc_context_t *ctx, int at) {
+    ctx->grown = false;
+    return _set_error(ctx, GB_CALC_E_LIMIT, at);
+}
+
+/**
+ * @brief Copies the body of a user function into the code, after the
+ * instructions moving its arguments into the parameter locals.
+ *
+ * The body gets fresh locals and its own copy of the constants, so every call
+ * is independent; the optimizer folds and shares the result like any other
+ * code. Calls can make the code outgrow the source length, so they set
+ * `grown` and report GB_CALC_E_LIMIT when the arrays are full: _compile_expr()
+ * then retries with larger arrays.
+ */
+static bool _inline_call(calc_context_t *ctx, const calc_func_t *func, int at) {
+    if (ctx->loop_depth + (int)func->loops > MAX_LOOP_DEPTH) {
+        return _loop_limit(ctx, at);
+    }
+
+    ctx->grown    = true;
+    ctx->loop_max = GB_MAX(ctx->loop_max, ctx->loop_depth + (int)func->loops);
+
+    if ((ctx->code_len + (int)(func->nparams + func->code_len) > ctx->cap) || //
+        (ctx->pool_len + (int)func->pool_len > ctx->cap) ||                  //
+        (ctx->local_len + (int)func->nlocals > ctx->cap)) {
+        return _set_error(ctx, GB_CALC_E_LIMIT, at);
+    }
+
+    const int base = ctx->local_len;
+    const int pool = ctx->pool_len;
+
+    for (uint32_t k = 0; k < func->nlocals; ++k) {
+        ctx->locals[base + (int)k] = (calc_local_t){.at = at, .len = 0, .node = -1};
+    }
+    ctx->local_len += (int)func->nlocals;
+
+    gb_memcpy(&ctx->pool[pool], func->pool, func->pool_len * sizeof(double));
+    ctx->pool_len += (int)func->pool_len;
+
+    // The last argument is on top of the stack
+    for (uint32_t k = func->nparams; k > 0; --k) {
+        ctx->code[ctx->code_len++] = INSN(OP_TEE, base + (int)k - 1);
+    }
+
+    for (uint32_t pc = 0; pc < func->code_len; ++pc) {
+        const calc_insn_t insn = func->code[pc];
+        const calc_op_t   op   = (calc_op_t)INSN_OP(insn);
+
+        if (op == OP_PUSH) {
+            ctx->code[ctx->code_len++] = INSN(op, (uint32_t)pool + INSN_ARG(insn));
+        } else if ((op == OP_TEE) || (op == OP_REG) || (op == OP_LOOP)) {
+            ctx->code[ctx->code_len++] = INSN(op, (uint32_t)base + INSN_ARG(insn));
+        } else {
+            ctx->code[ctx->code_len++] = insn;
+        }
+    }
+
+    ctx->num_top -= (int)func->nparams - 1;
+    return true;
+}
+
+/**
+ * @brief Parses the head of a range reduction, `sum(i,`, and opens its
+ * argument list.
+ *
+ * The index variable gets its local right away, but keeps it unnamed until
+ * the body: the bounds are evaluated outside the loop.
+ */
+static bool _open_reduce(calc_context_t *ctx, calc_op_t op, int at) {
+    calc_token_t open;
+    calc_token_t name;
+    calc_token_t comma;
+
+    _scan_token(ctx, &open);
+    _scan_token(ctx, &name);
+    _scan_token(ctx, &comma);
+
+    if (open.kind != TOK_OPEN) {
+        return _set_error(ctx, GB_CALC_E_SYNTAX, open.at);
+    }
+    if ((name.kind != TOK_IDENT) || _find_keyword(&ctx->expr[name.at], (size_t)name.len)) {
+        return _set_error(ctx, GB_CALC_E_SYNTAX, name.at);
+    }
+    if (comma.kind != TOK_COMMA) {
+        return _set_error(ctx, (comma.kind == TOK_CLOSE) ? GB_CALC_E_ARGS : GB_CALC_E_SYNTAX, comma.at);
+    }
+
+    if ((ctx->call_top >= ctx->cap - 1) || (ctx->local_len >= ctx->cap)) {
+        return _set_error(ctx, GB_CALC_E_LIMIT, at);
+    }
+
+    const int k = ctx->local_len++;
+
+    ctx->locals[k]              = (calc_local_t){.at = name.at, .len = 0, .node = -1};
+    ctx->calls[++ctx->call_top] = (calc_call_t){
+        .func  = NULL,
+        .op    = op,
+        .at    = at,
+        .nargs = 1,
+        .local = k,
+        .len   = name.len,
+    };
+
+    return _push_op(ctx, PARSE_CALL, open.at);
+}
+
+/**
+ * @brief Starts the body of a range reduction, after its bounds.
+ *
+ * OP_LOOP turns the two bounds into the index (see _optimize_code()), whose
+ * name is visible in the body only.
+ */
+static bool _open_body(calc_context_t *ctx, const calc_call_t *call, int at) {
+    if (ctx->loop_depth >= MAX_LOOP_DEPTH) {
+        return _loop_limit(ctx, at);
+    }
+
+    if (ctx->code_len >= ctx->cap) {
+        return _set_error(ctx, GB_CALC_E_LIMIT, at);
+    }
+
+    ctx->code[ctx->code_len++]   = INSN(OP_LOOP, call->local);
+    ctx->locals[call->local].len = call->len;
+    ctx->num_top--; // Two bounds in, the index out
+    ctx->loop_depth++;
+    ctx->loop_max = GB_MAX(ctx->loop_max, ctx->loop_depth);
+
+    return true;
+}
+
+/**
+ * @brief Ends the body of a range reduction.
+ */
+static bool _close_reduce(calc_context_t *ctx, const calc_call_t *call) {
+    if (!_emit_op(ctx, call->op, call->at)) {
+        return false;
+    }
+
+    ctx->locals[call->local].len = 0;
+    ctx->num_top--; // Index and body in, the result out
+    ctx->loop_depth--;
+
+    return true;
+}
+
+/**
+ * @brief Compiles an identifier found where an operand is expected.
+ *
+ * @param[in,out] ctx     Compiler context.
+ * @param[in]     tok     Identifier token.
+ * @param[out]    operand Set to `true` if the identifier completed an operand
+ *                        (constant or variable), `false` for a function that
+ *                        still waits for its argument(s).
+ */
+static bool _parse_ident(calc_context_t *ctx, const calc_token_t *tok, bool *operand) {
+    const char  *cp  = &ctx->expr[tok->at];
+    const size_t len = (size_t)tok->len;
+
+    const calc_keyword_t *kw = _find_keyword(cp, len);
+
+    *operand = !(kw && kw->op);
+
+    if (kw && _is_reduce_opcode((calc_op_t)kw->op)) {
+        return _open_reduce(ctx, (calc_op_t)kw->op, tok->at);
+    }
+
+    if (kw && kw->op) {
+        return _push_op(ctx, kw->op, tok->at);
+    }
+
+    if (kw) {
+        return _emit_push(ctx, kw->value);
+    }
+
+    // The latest assignment wins, and shadows a variable of the same name
+    for (int k = ctx->local_len - 1; k >= ctx->local_min; --k) {
+        const calc_local_t *local = &ctx->locals[k];
+
+        if (((size_t)local->len == len) && _name_equals(cp, &ctx->expr[local->at], len)) {
+            return _emit_local(ctx, k);
+        }
+    }
+
+    // A user function is only a function when it is called
+    const calc_func_t *user = _find_user_func(ctx, cp, len);
+
+    if (user) {
+        const int    rewind = ctx->i;
+        calc_token_t open;
+
+        _scan_token(ctx, &open);
+
+        if (open.kind == TOK_OPEN) {
+            if (ctx->call_top >= ctx->cap - 1) {
+                return _set_error(ctx, GB_CALC_E_LIMIT, tok->at);
+            }
+
+            ctx->calls[++ctx->call_top] = (calc_call_t){.func = user, .at = tok->at, .nargs = 0};
+
+            *operand = false;
+            return _push_op(ctx, PARSE_CALL, open.at);
+        }
+
+        ctx->i = rewind;
+    }
+
+    const int32_t ord = _syms_lookup(ctx->syms, cp, len);
+
+    if (ord >= 0) {
+        return _emit_load(ctx, ord);
+    }
+
+    // Accept a function name directly followed by its argument ("sinx",
+    // "sqrt2"), as "sin x" and "sqrt 2" are.
+    for (size_t n = GB_MIN(len - 1, (size_t)KEYWORD_MAX_LEN); n > 0; --n) {
+        const calc_keyword_t *func = _find_func(cp, n);
+
+        if (func) {
+            *operand = false;
+            ctx->i   = tok->at + (int)n; // the rest is the argument
+            return _push_op(ctx, func->op, tok->at);
+        }
+    }
+
+    return _set_error(ctx, GB_CALC_E_IDENT, tok->at);
+}
+
+/**
+ * @brief Emits the operators left on the stack at the end of a statement.
+ */
+static bool _reduce_all(calc_context_t *ctx) {
+    while (ctx->op__top >= 0) {
+        if (ctx->op__lifo[ctx->op__top] >= PARSE_PAREN) {
+            return _set_error(ctx, GB_CALC_E_PARENS, ctx->op__pos[ctx->op__top]);
+        }
+        if (!_reduce_op(ctx)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Closes an argument of the innermost user function call or range
+ * reduction at ',' or ')', and the call itself at ')'.
+ *
+ * @param[in,out] ctx  Compiler context.
+ * @param[in]     tok  The ',' or ')' token.
+ * @param[out]    done Set to `true` if the call was closed.
+ */
+static bool _close_arg(calc_context_t *ctx, const calc_token_t *tok, bool *done) {
+    calc_call_t *call = &ctx->calls[ctx->call_top];
+
+    *done = false;
+
+    if ((ctx->op__top < 0) || (ctx->op__lifo[ctx->op__top] != PARSE_CALL)) {
+        return _set_error(ctx, GB_CALC_E_SYNTAX, tok->at); // ',' outside a call
+    }
+
+    const int nargs = call->func ? (int)call->func->nparams : 4; // sum(i, a, b, body)
+
+    call->nargs++;
+
+    if (tok->kind == TOK_COMMA) {
+        if (call->nargs >= nargs) {
+            return _set_error(ctx, GB_CALC_E_ARGS, tok->at);
+        }
+        return call->func || (call->nargs < 3) || _open_body(ctx, call, tok->at);
+    }
+
+    if (call->nargs != nargs) {
+        return _set_error(ctx, GB_CALC_E_ARGS, tok->at);
+    }
+
+    ctx->op__top--;
+    ctx->call_top--;
+    *done = true;
+
+    return call->func ? _inline_call(ctx, call->func, call->at) : _close_reduce(ctx, call);
+}
+
+/**
+ * @brief Closes a statement that is followed by another one.
+ *
+ * The statement value is moved off the operand stack into a new local (OP_TEE
+ * before optimization), named after the assigned variable if any.
+ *
+ * @param[in,out] ctx      Compiler context.
+ * @param[in]     name_at  Source offset of the assigned name.
+ * @param[in]     name_len Length of the assigned name (0 if none).
+ * @param[in]     at       Source offset of the ';'.
+ */
+static bool _end_statement(calc_context_t *ctx, int name_at, int name_len, int at) {
+    if ((ctx->code_len >= ctx->cap) || (ctx->local_len >= ctx->cap)) {
+        return _set_error(ctx, GB_CALC_E_LIMIT, at);
+    }
+
+    const int k = ctx->local_len++;
+
+    ctx->locals[k].at          = name_at;
+    ctx->locals[k].len         = name_len;
+    ctx->locals[k].node        = -1;
+    ctx->locals[k].stmt        = true;
+    ctx->code[ctx->code_len++] = INSN(OP_TEE, k);
+    ctx->num_top--;
+
+    return true;
+}
+
+/**
+ * @brief Parses the head of a function definition, `name(p1, p2, ...) =`.
+ *
+ * Called at the start of a statement on a name followed by '('. The head is
+ * recognized by looking ahead; if the tokens do not form one, the position is
+ * restored and the statement is parsed as an expression. Otherwise the
+ * parameters become the only visible locals, for the body that follows.
+ *
+ * @param[in,out] ctx  Compiler context.
+ * @param[in]     name Function name token.
+ * @param[out]    def  Definition in progress; `def->code` is -1 if the
+ *                     statement is not a definition.
+ */
+static bool _parse_head(calc_context_t *ctx, const calc_token_t *name, calc_def_t *def) {
+    const int    rewind = ctx->i;
+    const int    base   = ctx->local_len;
+    int          count  = 0;
+    calc_token_t tok;
+
+    def->code = -1;
+
+    _scan_token(ctx, &tok); // '('
+
+    for (;;) {
+        _scan_token(ctx, &tok);
+
+        if ((tok.kind != TOK_IDENT) || (base + count >= ctx->cap)) {
+            ctx->i = rewind;
+            return true;
+        }
+
+        ctx->locals[base + count] = (calc_local_t){.at = tok.at, .len = tok.len, .node = -1};
+        count++;
+
+        _scan_token(ctx, &tok);
+
+        if (tok.kind == TOK_CLOSE) {
+            break;
+        }
+        if (tok.kind != TOK_COMMA) {
+            ctx->i = rewind;
+            return true;
+        }
+    }
+
+    _scan_token(ctx, &tok);
+
+    if (tok.kind != TOK_ASSIGN) {
+        ctx->i = rewind;
+        return true;
+    }
+
+    // It is a definition: built-in names and repeated parameters are errors
+    if (_find_keyword(&ctx->expr[name->at], (size_t)name->len)) {
+        return _set_error(ctx, GB_CALC_E_SYNTAX, name->at);
+    }
+
+    for (int k = 0; k < count; ++k) {
+        const calc_local_t *param = &ctx->locals[base + k];
+
+        if (_find_keyword(&ctx->expr[param->at], (size_t)param->len)) {
+            return _set_error(ctx, GB_CALC_E_SYNTAX, param->at);
+        }
+
+        for (int j = 0; j < k; ++j) {
+            const calc_local_t *other = &ctx->locals[base + j];
+
+            if ((other->len == param->len) && _name_equals(&ctx->expr[other->at], &ctx->expr[param->at], (size_t)param->len)) {
+                return _set_error(ctx, GB_CALC_E_SYNTAX, param->at);
+            }
+        }
+    }
+
+    def->at        = name->at;
+    def->len       = name->len;
+    def->nparams   = count;
+    def->code      = ctx->code_len;
+    def->pool      = ctx->pool_len;
+    ctx->local_len = base + count;
+    ctx->local_min = base;
+    ctx->loop_max  = 0;
+
+    return true;
+}
+
+/**
+ * @brief Moves the body of a finished definition out of the program code into
+ * the function table, relocated (see calc_func_t).
+ */
+static bool _end_definition(calc_context_t *ctx, const calc_def_t *def) {
+    const int base      = ctx->local_min;
+    const int code_len  = ctx->code_len - def->code;
+    const int pool_len  = ctx->pool_len - def->pool;
+    const int local_len = ctx->local_len - base;
+
+    if ((ctx->fcode_len + code_len > ctx->cap) || (ctx->fpool_len + pool_len > ctx->cap)) {
+        return _set_error(ctx, GB_CALC_E_LIMIT, def->at); // only after inlining
+    }
+
+    calc_insn_t *code = &ctx->fcode[ctx->fcode_len];
+    double      *pool = &ctx->fpool[ctx->fpool_len];
+
+    for (int pc = 0; pc < code_len; ++pc) {
+        const calc_insn_t insn = ctx->code[def->code + pc];
+        const calc_op_t   op   = (calc_op_t)INSN_OP(insn);
+
+        if (op == OP_PUSH) {
+            code[pc] = INSN(op, INSN_ARG(insn) - (uint32_t)def->pool);
+        } else if ((op == OP_TEE) || (op == OP_REG) || (op == OP_LOOP)) {
+            code[pc] = INSN(op, INSN_ARG(insn) - (uint32_t)base);
+        } else {
+            code[pc] = insn;
+        }
+    }
+
+    gb_memcpy(pool, &ctx->pool[def->pool], (size_t)pool_len * sizeof(double));
+
+    ctx->funcs[ctx->func_len++] = (calc_func_t){
+        .next     = NULL,
+        .name     = &ctx->expr[def->at],
+        .name_len = (uint32_t)def->len,
+        .nparams  = (uint32_t)def->nparams,
+        .nlocals  = (uint32_t)local_len,
+        .loops    = (uint32_t)ctx->loop_max,
+        .code_len = (uint32_t)code_len,
+        .pool_len = (uint32_t)pool_len,
+        .code     = code,
+        .pool     = pool,
+    };
+
+    ctx->fcode_len += code_len;
+    ctx->fpool_len += pool_len;
+    ctx->code_len  = def->code;
+    ctx->pool_len  = def->pool;
+    ctx->local_len = base;
+    ctx->local_min = 0;
+    ctx->num_top   = -1;
+
+    return true;
+}
+
+/**
+ * @brief Precedence-climbing parser over the token stream.
+ *
+ * A single left-to-right pass with one operator stack and no recursion, so
+ * the nesting depth is only bounded by the scratch memory. The parser
+ * alternates between two states: expecting an operand (numbers, identifiers,
+ * '(' and prefix operators) and expecting an operator (binary operators, ')'
+ * and the end). A token is therefore classified once, and whether `-` is
+ * unary or binary follows from the state, not from the previous character.
+ *
+ * Binding powers: `+ -` < `* / %` < `^` (right-associative) < prefix
+ * operators and functions.
+ *
+ * A program is a sequence of statements separated by ';', each an expression,
+ * an assignment `name = expression` or a function definition
+ * `name(p1, p2, ...) = expression`; its value is the value of the last
+ * statement (a trailing ';' is allowed). Assigned names and functions are
+ * visible from the next statement on. A function body sees its parameters,
+ * the variables of the symbol table and the functions defined before it,
+ * but not the assigned names of the program.
+ *
+ * A range reduction `sum(i, a, b, body)` (also `prod`, `min`, `max`) takes
+ * its arguments like a call; the index `i` is only visible in the body.
+ *
+ * @param[in,out] ctx       Compiler context.
+ * @param[in]     defs_only Accept definitions only (gb_calc_func_def()); the
+ *                          program then has no value.
+ *
+ * @return `true` if the program is valid, `false` otherwise.
+ */
+static bool _parse_expr(calc_context_t *ctx, bool defs_only) {
+    bool         expect   = true;  // an operand is expected next
+    bool         start    = true;  // at the start of a statement
+    bool         last_def = false; // the previous statement was a definition
+    int          name_at  = 0;     // variable assigned by this statement ...
+    int          name_len = 0;     // ... (0 if none)
+    calc_def_t   def      = {.code = -1};
+    calc_token_t tok      = {.kind = TOK_END};
+
+    for (;;) {
+        _scan_token(ctx, &tok);
+
+        if (start && (tok.kind == TOK_IDENT)) {
+            const int    rewind = ctx->i;
+            calc_token_t next;
+
+            _scan_token(ctx, &next);
+
+            if (next.kind == TOK_ASSIGN) {
+                if (defs_only || _find_keyword(&ctx->expr[tok.at], (size_t)tok.len)) {
+                    return _set_error(ctx, GB_CALC_E_SYNTAX, tok.at); // not a definition, or built-in name
+                }
+
+                name_at  = tok.at;
+                name_len = tok.len;
+            }
+
+            ctx->i = rewind;
+
+            if ((next.kind == TOK_OPEN) && !_parse_head(ctx, &tok, &def)) {
+                return false;
+            }
+
+            if ((next.kind == TOK_ASSIGN) || (def.code >= 0)) {
+                if (next.kind == TOK_ASSIGN) {
+                    _scan_token(ctx, &next); // '='
+                }
+                start = false;
+                continue;
+            }
+        }
+
+        if (start && defs_only && (tok.kind != TOK_END)) {
+            return _set_error(ctx, GB_CALC_E_SYNTAX, tok.at); // not a definition
+        }
+
+        if (expect) {
+            bool operand = false;
+            bool ok      = true;
+
+            switch (tok.kind) {
+                case TOK_NUMBER:
+                    operand = true;
+                    ok      = _emit_push(ctx, tok.value);
+                    break;
+
+                case TOK_IDENT:
+                    ok = _parse_ident(ctx, &tok, &operand);
+                    break;
+
+                case TOK_OPEN:
+                    ok = _push_op(ctx, PARSE_PAREN, tok.at);
+                    break;
+
+                case TOK_OPERATOR:
+                    if (tok.cc->prefix) {
+                        ok = _push_op(ctx, tok.cc->prefix, tok.at);
+                    } else if (tok.cc->binary != OP_ADD) { // unary plus is a no-op
+                        return _set_error(ctx, GB_CALC_E_OPERAND, tok.at);
+                    }
+                    break;
+
+                case TOK_END:
+                    if (ctx->op__top >= 0) { // point at the operator left without operand
+                        return _set_error(ctx, GB_CALC_E_OPERAND, ctx->op__pos[ctx->op__top]);
+                    }
+                    if (start && defs_only && last_def) {
+                        return true;
+                    }
+                    if (start && !last_def && (ctx->local_len > 0)) { // trailing ';'
+                        return _emit_local(ctx, ctx->local_len - 1);
+                    }
+                    return _set_error(ctx, start ? GB_CALC_E_EMPTY_EXPR : GB_CALC_E_OPERAND, tok.at);
+
+                case TOK_CLOSE:
+                    if ((ctx->op__top >= 0) && (ctx->op__lifo[ctx->op__top] == PARSE_CALL)) {
+                        return _set_error(ctx, GB_CALC_E_ARGS, tok.at); // "f()"
+                    }
+                    return _set_error(ctx, GB_CALC_E_SYNTAX, tok.at);
+
+                default:
+                    return _set_error(ctx, GB_CALC_E_SYNTAX, tok.at);
+            }
+
+            if (!ok || (operand && !_apply_prefix(ctx))) {
+                return false;
+            }
+
+            expect = !operand;
+            start  = false;
+            continue;
+        }
+
+        switch (tok.kind) {
+            case TOK_CLOSE:
+            case TOK_COMMA: {
+                while ((ctx->op__top >= 0) && (ctx->op__lifo[ctx->op__top] < PARSE_PAREN)) {
+                    if (!_reduce_op(ctx)) {
+                        return false;
+                    }
+                }
+
+                if ((tok.kind == TOK_CLOSE) && (ctx->op__top >= 0) && (ctx->op__lifo[ctx->op__top] == PARSE_PAREN)) {
+                    ctx->op__top--; // Pop the '('
+
+                    if (!_apply_prefix(ctx)) {
+                        return false;
+                    }
+                    break;
+                }
+
+                if ((tok.kind == TOK_CLOSE) && (ctx->op__top < 0)) {
+                    return _set_error(ctx, GB_CALC_E_PARENS, tok.at);
+                }
+
+                bool done;
+
+                if (!_close_arg(ctx, &tok, &done) || (done && !_apply_prefix(ctx))) {
+                    return false;
+                }
+                expect = !done;
+            } break;
+
+            case TOK_OPERATOR: {
+                const uint8_t prec = tok.cc->prec;
+
+                if (!prec) {
+                    return _set_error(ctx, GB_CALC_E_SYNTAX, tok.at); // '!' or '~'
+                }
+
+                // '^' is right-associative, everything else is left-associative
+                while (ctx->op__top >= 0) {
+                    const uint8_t top = calc_prec_op[ctx->op__lifo[ctx->op__top]];
+
+                    if ((top < prec) || ((top == prec) && (tok.cc->binary == OP_POW))) {
+                        break;
+                    }
+                    if (!_reduce_op(ctx)) {
+                        return false;
+                    }
+                }
+
+                if (!_push_op(ctx, tok.cc->binary, tok.at)) {
+                    return false;
+                }
+                expect = true;
+            } break;
+
+            case TOK_SEMI:
+            case TOK_END:
+                if (!_reduce_all(ctx)) {
+                    return false;
+                }
+
+                last_def = (def.code >= 0);
+
+                if (last_def) {
+                    if (!_end_definition(ctx, &def)) {
+                        return false;
+                    }
+                    def.code = -1;
+                } else if (tok.kind == TOK_END) {
+                    return true;
+                } else if (!_end_statement(ctx, name_at, name_len, tok.at)) {
+                    return false;
+                }
+
+                if (tok.kind == TOK_END) {
+                    return defs_only || _set_error(ctx, GB_CALC_E_EMPTY_EXPR, tok.at); // no value
+                }
+
+                expect   = true;
+                start    = true;
+                name_len = 0;
+                break;
+
+            default:
+                return _set_error(ctx, GB_CALC_E_SYNTAX, tok.at);
+        }
+    }
+}
+
+/**
+ * @brief Carves the compiler arrays out of the scratch buffer.
+ *
+ * @param[in,out] ctx Compiler context.
+ * @param[in]     len Length of the source expression.
+ *
+ * @return `true` on success, `false` otherwise (the error is recorded).
+ */
+static bool _alloc_context(calc_context_t *ctx, size_t len) {
+    if (len > MAX_EXPR_LEN) {
+        return _set_error(ctx, GB_CALC_E_LIMIT, (int)MAX_EXPR_LEN);
+    }
+
+    const size_t cap = len + 1;
+
+    unsigned char *cursor = _scratch_reserve(_compile_scratch(cap));
+
+    if (!cursor) {
+        return _set_error(ctx, GB_CALC_E_NO_MEMORY, 0);
+    }
+
+    ctx->cap       = (int)cap;
+    ctx->hash_mask = _hash_slots(cap) - 1;
+    ctx->nodes     = _scratch_take(&cursor, cap * sizeof(calc_node_t));
+    ctx->pool      = _scratch_take(&cursor, cap * sizeof(double));
+    ctx->code      = _scratch_take(&cursor, cap * sizeof(calc_insn_t));
+    ctx->op__pos   = _scratch_take(&cursor, cap * sizeof(int));
+    ctx->work_node = _scratch_take(&cursor, cap * sizeof(int32_t));
+    ctx->locals    = _scratch_take(&cursor, cap * sizeof(calc_local_t));
+    ctx->funcs     = _scratch_take(&cursor, cap * sizeof(calc_func_t));
+    ctx->fcode     = _scratch_take(&cursor, cap * sizeof(calc_insn_t));
+    ctx->fpool     = _scratch_take(&cursor, cap * sizeof(double));
+    ctx->calls     = _scratch_take(&cursor, cap * sizeof(calc_call_t));
+    ctx->scan_node = _scratch_take(&cursor, cap * sizeof(int32_t));
+    ctx->capt      = _scratch_take(&cursor, cap * sizeof(int32_t));
+    ctx->bodies    = _scratch_take(&cursor, cap * sizeof(int32_t));
+    ctx->node_hash = _scratch_take(&cursor, (ctx->hash_mask + 1) * sizeof(int32_t));
+    ctx->op__lifo  = _scratch_take(&cursor, cap);
+    ctx->work_done = _scratch_take(&cursor, cap);
+    ctx->digits    = _scratch_take(&cursor, cap);
+
+    return true;
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (Optimizer)
+// *****************************************************************************
+// *****************************************************************************
+
+static inline bool _is_const_node(const calc_context_t *ctx, int32_t n, double value) {
+    return (ctx->nodes[n].op == OP_PUSH) && (ctx->nodes[n].value == value);
+}
+
+static inline bool _fast_math(void) {
+    return atomic_load_explicit(&calc_fast_math, memory_order_relaxed);
+}
+
+/**
+ * @brief Computes an operation on constant operands.
+ *
+ * Operations that would raise a run-time error (division by zero, square root
+ * or logarithm out of domain, `!` or `~` of a value beyond int64_t) are not
+ * folded, so the error is still reported when the program runs.
+ *
+ * @return `true` and the value in `*out` if the operation can be folded.
+ */
+static bool _fold_value(calc_op_t op, double a, double b, double *out) {
+    if (_fast_math()) {
+        switch (op) {
+            // clang-format off
+            case OP_SIN:  *out = gb_fmath_sin(a);     return true;
+            case OP_COS:  *out = gb_fmath_cos(a);     return true;
+            case OP_TAN:  *out = gb_fmath_tan(a);     return true;
+            case OP_EXP:  *out = gb_fmath_exp(a);     return true;
+            case OP_LOG:  *out = gb_fmath_log(a);     return (a > 0);
+            case OP_LOG2: *out = gb_fmath_log2(a);    return (a > 0);
+            case OP_POW:  *out = gb_fmath_pow(a, b);  return true;
+            default:                                  break;
+            // clang-format on
+        }
+    }
+
+    switch (op) {
+        // clang-format off
+        case OP_NEG:  *out = -a;           return true;
+        case OP_NOT:  *out = _is_int_operand(a) ? !(int64_t)a : 0;  return _is_int_operand(a);
+        case OP_BNOT: *out = _is_int_operand(a) ? ~(int64_t)a : 0;  return _is_int_operand(a);
+        case OP_SIN:  *out = sin(a);       return true;
+        case OP_ASIN: *out = asin(a);      return true;
+        case OP_COS:  *out = cos(a);       return true;
+        case OP_ACOS: *out = acos(a);      return true;
+        case OP_TAN:  *out = tan(a);       return true;
+        case OP_ATAN: *out = atan(a);      return true;
+        case OP_SQRT: *out = sqrt(a);      return (a >= 0);
+        case OP_EXP:  *out = exp(a);       return true;
+        case OP_LOG:  *out = log(a);       return (a > 0);
+        case OP_LOG2: *out = log2(a);      return (a > 0);
+        case OP_ADD:  *out = a + b;        return true;
+        case OP_SUB:  *out = a - b;        return true;
+        case OP_MUL:  *out = a * b;        return true;
+        case OP_DIV:  *out = a / b;        return (b != 0);
+        case OP_MOD:  *out = fmod(a, b);   return (b != 0);
+        case OP_POW:  *out = pow(a, b);    return true;
+        default:                           return false;
+        // clang-format on
+    }
+}
+
+/**
+ * @brief Applies value-preserving algebraic identities.
+ *
+ * x+0, 0+x, x-0, x*1, 1*x, x/1, x^1 and -(-x) reduce to an existing operand
+ * (up to the sign of a zero result); x^0 reduces to the constant 1, which is
+ * exactly what pow() returns for every x. Dropping x is only safe when it
+ * cannot fail, so the rule is limited to leaves: a variable, a reduction index
+ * or a finite constant (`sqrt(-1)^0` still reports its error).
+ *
+ * @return The node that replaces the operation, or -1 if no identity applies.
+ *         The special value -2 means "the constant 1".
+ */
+static int32_t _simplify_node(const calc_context_t *ctx, calc_op_t op, int32_t a, int32_t b) {
+    switch (op) {
+        case OP_NEG:
+            return (ctx->nodes[a].op == OP_NEG) ? ctx->nodes[a].a : -1;
+
+        case OP_ADD:
+            if (_is_const_node(ctx, b, 0)) {
+                return a;
+            }
+            return _is_const_node(ctx, a, 0) ? b : -1;
+
+        case OP_SUB:
+            return _is_const_node(ctx, b, 0) ? a : -1;
+
+        case OP_MUL:
+            if (_is_const_node(ctx, b, 1)) {
+                return a;
+            }
+            return _is_const_node(ctx, a, 1) ? b : -1;
+
+        case OP_DIV:
+            return _is_const_node(ctx, b, 1) ? a : -1;
+
+        case OP_POW:
+            if (_is_const_node(ctx, b, 1)) {
+                return a;
+            }
+            if (!_is_const_node(ctx, b, 0)) {
+                return -1;
+            }
+            switch (ctx->nodes[a].op) {
+                case OP_LOAD:
+                case OP_LOOP:
+                    return -2;
+                case OP_PUSH:
+                    return isfinite(ctx->nodes[a].value) ? -2 : -1;
+                default:
+                    return -1;
+            }
+
+        default:
+            return -1;
+    }
+}
+
+/**
+ * @brief Returns the node structurally identical to `tmpl`, creating it if
+ * needed (hash-consing).
+ *
+ * Two nodes are identical when they have the same opcode, the same operand
+ * nodes and the same leaf payload (constant bits or variable ordinal). Since
+ * operands are themselves interned, equal subexpressions map to one node and
+ * the expression becomes a DAG.
+ */
+static int32_t _intern_node(calc_context_t *ctx, const calc_node_t *tmpl) {
+    uint64_t bits;
+    gb_memcpy(&bits, &tmpl->value, sizeof(bits));
+
+    uint32_t hash = 2166136261U;
+    hash          = (hash ^ (uint32_t)tmpl->op) * 16777619U;
+    hash          = (hash ^ (uint32_t)tmpl->a) * 16777619U;
+    hash          = (hash ^ (uint32_t)tmpl->b) * 16777619U;
+    hash          = (hash ^ tmpl->arg) * 16777619U;
+    hash          = (hash ^ (uint32_t)bits) * 16777619U;
+    hash          = (hash ^ (uint32_t)(bits >> 32)) * 16777619U;
+
+    uint32_t slot = hash & ctx->hash_mask;
+
+    for (;;) {
+        const int32_t n = ctx->node_hash[slot];
+
+        if (n < 0) {
+            break;
+        }
+
+        const calc_node_t *node = &ctx->nodes[n];
+
+        uint64_t node_bits;
+        gb_memcpy(&node_bits, &node->value, sizeof(node_bits));
+
+        if ((node->op == tmpl->op) && (node->a == tmpl->a) && (node->b == tmpl->b) && //
+            (node->arg == tmpl->arg) && (node_bits == bits)) {
+            return n;
+        }
+
+        slot = (slot + 1) & ctx->hash_mask;
+    }
+
+    const int32_t n = ctx->node_len++;
+
+    ctx->nodes[n]        = *tmpl;
+    ctx->node_hash[slot] = n;
+
+    return n;
+}
+
+/**
+ * @brief Returns the depth of the innermost reduction a node depends on, or
+ * -1 for a node computed outside every reduction body.
+ */
+static inline int _loop_top(uint32_t loops) {
+    return loops ? 31 - __builtin_clz(loops) : -1;
+}
+
+/**
+ * @brief Lists the values a reduction body takes from outside (captures).
+ *
+ * The body is walked from its root, through nested reductions, down to the
+ * first nodes that do not depend on the reduction index: those are computed
+ * once before the loop and read from registers 1..k of the body (register 0
+ * holds the index). Constants are simply re-emitted; variables are captured
+ * too, so that a batch evaluation reads them from their column.
+ *
+ * @param[in,out] ctx    Compiler context; receives the list in `capt`.
+ * @param[in]     reduce Reduction node.
+ *
+ * @return The number of captured values.
+ */
+static int _scan_captures(calc_context_t *ctx, int32_t reduce) {
+    const calc_node_t *node  = &ctx->nodes[reduce];
+    const int          depth = _loop_top(ctx->nodes[node->a].loops);
+    const int32_t      mark  = ctx->scan_len++;
+    int                count = 0;
+    int                top   = 0;
+
+    ctx->scan_node[0]        = node->b;
+    ctx->nodes[node->b].mark = mark;
+
+    while (top >= 0) {
+        const int32_t      n    = ctx->scan_node[top--];
+        const calc_node_t *item = &ctx->nodes[n];
+        int32_t            next[3];
+        int                len = 0;
+
+        if (item->op == OP_PUSH) {
+            continue;
+        }
+
+        if (_loop_top(item->loops) < depth) {
+            ctx->capt[count++] = n;
+            continue;
+        }
+
+        if (item->op == OP_LOOP) {
+            continue; // this index or the index of a nested reduction
+        }
+
+        if (_is_reduce_opcode(item->op)) {
+            next[len++] = ctx->nodes[item->a].a;
+            next[len++] = ctx->nodes[item->a].b;
+            next[len++] = item->b;
+        } else {
+            next[len++] = item->a;
+            if (item->b >= 0) {
+                next[len++] = item->b;
+            }
+        }
+
+        for (int k = len - 1; k >= 0; --k) {
+            if (ctx->nodes[next[k]].mark != mark) {
+                ctx->nodes[next[k]].mark = mark;
+                ctx->scan_node[++top]    = next[k];
+            }
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Counts a use of `n` made from the code segment `seg`.
+ *
+ * Only uses from the segment computing the node matter: a body reads the
+ * values of enclosing segments through its captures.
+ */
+static inline void _count_use(calc_context_t *ctx, int32_t n, int seg) {
+    if (_loop_top(ctx->nodes[n].loops) == seg) {
+        ctx->nodes[n].uses++;
+    }
+}
+
+/**
+ * @brief Returns `true` if a reduction computes its captures (listed in
+ * `capt`) only when its range is not empty: when one of them can fail.
+ */
+static bool _skips_captures(const calc_context_t *ctx, int count) {
+    for (int k = 0; k < count; ++k) {
+        if (ctx->nodes[ctx->capt[k]].fails) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Propagates to operand `n` whether its consumer `from` is computed
+ * unconditionally, through captures that may be skipped (`skipped`), or both.
+ */
+static inline void _reach(calc_context_t *ctx, int32_t n, const calc_node_t *from, bool skipped) {
+    calc_node_t *node = &ctx->nodes[n];
+
+    node->sure = node->sure || (from->sure && !skipped);
+    node->cond = node->cond || from->cond || skipped;
+}
+
+/**
+ * @brief Emits one code segment: the program or a reduction body.
+ *
+ * The DAG is emitted depth-first from `root`. A non-leaf node used more than
+ * once is computed on its first visit and saved in a register (OP_TEE);
+ * later visits just reload it (OP_REG). In a body, the index is register 0
+ * and the captured values follow it; a reduction emits its bounds and
+ * captures, then its opcode, whose body offset is patched when the body itself
+ * is emitted.
+ *
+ * When a capture can fail, an OP_SKIP between the bounds and the captures
+ * jumps over them on an empty range, so `sum(i, 1, 0, 1/0)` is 0. A register
+ * saved in such skippable code is only trusted while that code is being
+ * emitted; a later visit computes the value again.
+ *
+ * @param[in,out] ctx   Compiler context.
+ * @param[in]     root  Root node of the segment.
+ * @param[in]     index Index node of the body, or -1 for the program.
+ *
+ * @return `true` on success, `false` if the arrays are full.
+ */
+static bool _emit_segment(calc_context_t *ctx, int32_t root, int32_t index) {
+    const int depth = (index < 0) ? -1 : _loop_top(ctx->nodes[index].loops);
+
+    int32_t *work_node = ctx->work_node;
+    int8_t  *work_done = ctx->work_done;
+    int      work_top  = 0;
+    int      sp        = -1;
+    int32_t  zone      = -1; // innermost OP_SKIP being emitted
+
+    work_node[0] = root;
+    work_done[0] = 0;
+
+    while (work_top >= 0) {
+        const int32_t n    = work_node[work_top];
+        calc_node_t  *node = &ctx->nodes[n];
+
+        // Room for the instruction, its OP_TEE and the final OP_RET
+        if ((ctx->code_len + 3 > ctx->cap) || (work_top + 2 >= ctx->cap)) {
+            ctx->grown = true;
+            return _set_error(ctx, GB_CALC_E_LIMIT, 0);
+        }
+
+        // The OP_SKIP is patched once its captures are emitted
+        if ((node->op != OP_PUSH) && (node->slot >= 0) && (node->zone >= 0) && INSN_ARG(ctx->code[node->zone])) {
+            node->slot = -1; // saved by code that may have been skipped
+        }
+
+        if (node->op == OP_PUSH) {
+            if (node->slot < 0) {
+                node->slot            = ctx->pool_len++;
+                ctx->pool[node->slot] = node->value;
+            }
+            ctx->code[ctx->code_len++] = INSN(OP_PUSH, node->slot);
+            sp++;
+            work_top--;
+        } else if (n == index) {
+            ctx->code[ctx->code_len++] = INSN(OP_REG, 0);
+            sp++;
+            work_top--;
+        } else if (_loop_top(node->loops) < depth) {
+            // Computed before the loop
+            ctx->code[ctx->code_len++] = INSN(OP_REG, node->cap);
+            sp++;
+            work_top--;
+        } else if (node->op == OP_LOAD) {
+            ctx->code[ctx->code_len++] = INSN(OP_LOAD, node->arg);
+            sp++;
+            work_top--;
+        } else if (node->slot >= 0) {
+            // Already computed: reload the saved value
+            ctx->code[ctx->code_len++] = INSN(OP_REG, node->slot);
+            sp++;
+            work_top--;
+        } else if (_is_reduce_opcode(node->op) && ((work_done[work_top] == 0) || (work_done[work_top] == 4))) {
+            // Bounds, then captures: the first operand ends on top of the stack
+            const calc_node_t *bounds = &ctx->nodes[node->a];
+            const int          count  = _scan_captures(ctx, n);
+
+            if (work_top + count + 2 >= ctx->cap) {
+                ctx->grown = true;
+                return _set_error(ctx, GB_CALC_E_LIMIT, (int)node->pos);
+            }
+
+            if (work_done[work_top] == 4) {
+                // Bounds emitted: guard the captures
+                node->skip                 = ctx->code_len;
+                zone                       = node->skip;
+                ctx->code[ctx->code_len++] = INSN(OP_SKIP, 0);
+            } else if (_skips_captures(ctx, count)) {
+                node->zone          = zone;
+                work_done[work_top] = 4;
+                work_node[++work_top] = bounds->b;
+                work_done[work_top]   = 0;
+                work_node[++work_top] = bounds->a;
+                work_done[work_top]   = 0;
+                continue;
+            }
+
+            node->cap           = count;
+            work_done[work_top] = 3;
+
+            for (int k = count - 1; k >= 0; --k) {
+                work_node[++work_top] = ctx->capt[k];
+                work_done[work_top]   = 0;
+            }
+            if (node->skip < 0) {
+                work_node[++work_top] = bounds->b;
+                work_done[work_top]   = 0;
+                work_node[++work_top] = bounds->a;
+                work_done[work_top]   = 0;
+            }
+            continue;
+        } else if (work_done[work_top] == 0) {
+            work_done[work_top] = 1;
+            work_top++;
+            work_node[work_top] = node->a;
+            work_done[work_top] = 0;
+            continue;
+        } else if ((work_done[work_top] == 1) && (node->b >= 0)) {
+            work_done[work_top] = 2;
+            work_top++;
+            work_node[work_top] = node->b;
+            work_done[work_top] = 0;
+            continue;
+        } else {
+            if (_is_reduce_opcode(node->op)) {
+                if (node->skip >= 0) {
+                    ctx->code[node->skip] = INSN(OP_SKIP, ctx->code_len - node->skip);
+                    zone                  = node->zone;
+                    node->skip            = -1;
+                }
+
+                // The body offset is patched when the body is emitted; until
+                // then, the instructions of a reduction emitted more than once
+                // are chained through their arguments
+                if (node->arg == 0) {
+                    ctx->bodies[ctx->body_len++] = n;
+                }
+                ctx->code[ctx->code_len] = INSN(node->op, node->arg);
+                node->arg                = (uint32_t)ctx->code_len++;
+                sp -= node->cap + 1;
+            } else {
+                ctx->code[ctx->code_len++] = INSN(node->op, node->pos);
+                sp -= (node->b >= 0) ? 1 : 0;
+            }
+
+            if (node->uses > 1) {
+                node->slot                 = ctx->reg_len++;
+                node->zone                 = zone;
+                ctx->code[ctx->code_len++] = INSN(OP_TEE, node->slot);
+            }
+            work_top--;
+        }
+
+        if (sp > ctx->num_max) {
+            ctx->num_max = sp;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Counts the uses of every node reachable from `root`, per code segment.
+ *
+ * Operands always precede their operator, and a reduction its body, so a
+ * single backward sweep is enough. The same sweep tells which nodes of the
+ * program are computed unconditionally (`sure`) and which are needed by
+ * captures that an empty range skips (`cond`).
+ */
+static void _count_uses(calc_context_t *ctx, int32_t root) {
+    for (int32_t n = 0; n < ctx->node_len; ++n) {
+        ctx->nodes[n].uses = (n == root) ? 1 : 0;
+        ctx->nodes[n].slot = -1;
+        ctx->nodes[n].cap  = -1;
+        ctx->nodes[n].mark = -1;
+        ctx->nodes[n].sure = (n == root);
+        ctx->nodes[n].cond = false;
+        ctx->nodes[n].zone = -1;
+        ctx->nodes[n].skip = -1;
+    }
+
+    ctx->scan_len = 0;
+
+    for (int32_t n = root; n >= 0; --n) {
+        const calc_node_t *node = &ctx->nodes[n];
+        const int          seg  = _loop_top(node->loops);
+
+        if ((node->uses == 0) || (node->op == OP_LOOP)) {
+            continue; // the index reads its bounds through the reduction
+        }
+
+        if (_is_reduce_opcode(node->op)) {
+            const calc_node_t *index   = &ctx->nodes[node->a];
+            const int          count   = _scan_captures(ctx, n);
+            const bool         skipped = _skips_captures(ctx, count);
+
+            _count_use(ctx, index->a, seg);
+            _count_use(ctx, index->b, seg);
+            _reach(ctx, index->a, node, false);
+            _reach(ctx, index->b, node, false);
+
+            for (int k = 0; k < count; ++k) {
+                _count_use(ctx, ctx->capt[k], seg);
+                _reach(ctx, ctx->capt[k], node, skipped);
+            }
+
+            // The root of the body, unless it is the index or captured
+            if ((node->b != node->a) && (_loop_top(ctx->nodes[node->b].loops) == _loop_top(index->loops))) {
+                ctx->nodes[node->b].uses++;
+            }
+        } else {
+            if (node->a >= 0) {
+                _count_use(ctx, node->a, seg);
+                _reach(ctx, node->a, node, false);
+            }
+            if (node->b >= 0) {
+                _count_use(ctx, node->b, seg);
+                _reach(ctx, node->b, node, false);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Folds, simplifies and de-duplicates a compiled expression.
+ *
+ * The postfix code is replayed on a stack of node indices:
+ *  - statement values are bound to their node (OP_TEE) and references to them
+ *    reuse it (OP_REG), so intermediates of a multi-statement program are
+ *    ordinary shared nodes (an unused one that can fail is kept, see below);
+ *  - a reduction turns its bounds into an index node (OP_LOOP), bound to the
+ *    index variable, and then its index and body into the reduction node;
+ *  - every operation whose operands are all constant becomes a constant node;
+ *  - operations matching an identity are replaced by their surviving operand;
+ *  - every node is interned, so repeated subexpressions share one node.
+ *
+ * The DAG is then re-emitted from the root (see _emit_segment()), followed by
+ * one code segment per reduction body: `OP_LOOP k`, the body, and OP_RET
+ * holding the source offset of the reduction. Whatever part of a body does
+ * not depend on its index is computed once, before the loop. The stack depth
+ * is recomputed for the new program.
+ *
+ * @param[in,out] ctx Compiler context holding a valid program.
+ *
+ * @return `true` on success, `false` if the arrays are full.
+ */
+static bool _optimize_code(calc_context_t *ctx) {
+    // The replay stack never outlives the replay, so it borrows the work stack
+    int32_t *stk   = ctx->work_node;
+    int      top   = -1;
+    int      depth = 0; // reduction bodies being replayed
+
+    ctx->node_len = 0;
+
+    for (uint32_t i = 0; i <= ctx->hash_mask; ++i) {
+        ctx->node_hash[i] = -1;
+    }
+
+    for (int pc = 0; pc < ctx->code_len; ++pc) {
+        const calc_op_t op = (calc_op_t)INSN_OP(ctx->code[pc]);
+
+        calc_node_t tmpl = {
+            .op    = op,
+            .a     = -1,
+            .b     = -1,
+            .arg   = 0,
+            .value = 0,
+            .loops = 0,
+            .pos   = 0,
+            .fails = false,
+        };
+
+        if (op == OP_TEE) {
+            ctx->locals[INSN_ARG(ctx->code[pc])].node = stk[top--];
+            continue;
+        }
+
+        if (op == OP_REG) {
+            stk[++top] = ctx->locals[INSN_ARG(ctx->code[pc])].node;
+            continue;
+        }
+
+        if ((op == OP_PUSH) || (op == OP_LOAD)) {
+            tmpl.arg   = (op == OP_LOAD) ? INSN_ARG(ctx->code[pc]) : 0;
+            tmpl.value = (op == OP_PUSH) ? ctx->pool[INSN_ARG(ctx->code[pc])] : 0;
+
+            stk[++top] = _intern_node(ctx, &tmpl);
+            continue;
+        }
+
+        if (op == OP_LOOP) {
+            // The serial number keeps every index distinct
+            tmpl.b     = stk[top--];
+            tmpl.a     = stk[top--];
+            tmpl.arg   = (uint32_t)pc;
+            tmpl.loops = 1U << depth++;
+
+            stk[++top]                                = _intern_node(ctx, &tmpl);
+            ctx->locals[INSN_ARG(ctx->code[pc])].node = stk[top];
+            continue;
+        }
+
+        tmpl.pos = INSN_ARG(ctx->code[pc]);
+
+        if (_is_reduce_opcode(op)) {
+            const calc_node_t *index  = &ctx->nodes[stk[top - 1]];
+            const uint32_t     bounds = ctx->nodes[index->a].loops | ctx->nodes[index->b].loops;
+
+            tmpl.b     = stk[top--];
+            tmpl.a     = stk[top--];
+            tmpl.loops = bounds | (ctx->nodes[tmpl.b].loops & ~index->loops);
+            tmpl.fails = true;
+            depth--;
+
+            stk[++top] = _intern_node(ctx, &tmpl);
+            continue;
+        }
+
+        const int32_t b = _is_binary_opcode(op) ? stk[top--] : -1;
+        const int32_t a = stk[top--];
+
+        const int32_t same = _simplify_node(ctx, op, a, b);
+
+        if (same >= 0) {
+            stk[++top] = same;
+            continue;
+        }
+
+        const bool   a_const = (ctx->nodes[a].op == OP_PUSH);
+        const bool   b_const = (b < 0) || (ctx->nodes[b].op == OP_PUSH);
+        const double b_val   = (b < 0) ? 0 : ctx->nodes[b].value;
+
+        if (same == -2) {
+            tmpl.op    = OP_PUSH;
+            tmpl.value = 1;
+        } else if (a_const && b_const && _fold_value(op, ctx->nodes[a].value, b_val, &tmpl.value)) {
+            tmpl.op = OP_PUSH;
+        } else {
+            tmpl.a     = a;
+            tmpl.b     = b;
+            tmpl.loops = ctx->nodes[a].loops | ((b < 0) ? 0 : ctx->nodes[b].loops);
+            tmpl.fails = _is_checked_opcode(op) || ctx->nodes[a].fails || ((b >= 0) && ctx->nodes[b].fails);
+        }
+
+        stk[++top] = _intern_node(ctx, &tmpl);
+    }
+
+    int32_t root = stk[top];
+
+    _count_uses(ctx, root);
+
+    // A statement whose value is never used, or only by captures that an empty
+    // range skips, still runs for its errors, so `a = 1/0; 5` fails like
+    // `1/0 + 5`: it is chained in front of the root, unless a statement chained
+    // after it already computes it. Error-free ones are simply dropped.
+    for (int k = ctx->local_len - 1; k >= 0; --k) {
+        const int32_t n = ctx->locals[k].node;
+
+        if (ctx->locals[k].stmt && !ctx->nodes[n].sure && ctx->nodes[n].fails) {
+            const calc_node_t tmpl = {.op = OP_SEQ, .a = n, .b = root, .fails = true};
+
+            root = _intern_node(ctx, &tmpl);
+            _count_uses(ctx, root);
+        }
+    }
+
+    // A shared value needed both unconditionally and by skippable captures is
+    // computed first rather than twice (see _emit_segment()), as far as the
+    // node array allows
+    const int32_t len     = ctx->node_len;
+    bool          chained = false;
+
+    for (int32_t n = 0; (n < len) && (ctx->node_len < ctx->cap); ++n) {
+        const calc_node_t *node = &ctx->nodes[n];
+
+        if (node->sure && node->cond && (node->uses > 1) && (node->op != OP_PUSH) && (node->op != OP_LOAD)) {
+            const calc_node_t tmpl = {.op = OP_SEQ, .a = n, .b = root, .fails = true};
+
+            root    = _intern_node(ctx, &tmpl);
+            chained = true;
+        }
+    }
+
+    if (chained) {
+        _count_uses(ctx, root);
+    }
+
+    ctx->code_len = 0;
+    ctx->pool_len = 0;
+    ctx->reg_len  = 0;
+    ctx->body_len = 0;
+    ctx->num_max  = -1;
+
+    if (!_emit_segment(ctx, root, -1)) {
+        return false;
+    }
+
+    ctx->code[ctx->code_len++] = INSN(OP_RET, 0);
+
+    int regs = ctx->reg_len;
+
+    // Reduction bodies, in the order their reductions were emitted
+    for (int k = 0; k < ctx->body_len; ++k) {
+        calc_node_t *node  = &ctx->nodes[ctx->bodies[k]];
+        const int    count = _scan_captures(ctx, ctx->bodies[k]);
+
+        for (int c = 0; c < count; ++c) {
+            ctx->nodes[ctx->capt[c]].cap = 1 + c;
+        }
+
+        if (ctx->code_len >= ctx->cap) {
+            ctx->grown = true;
+            return _set_error(ctx, GB_CALC_E_LIMIT, (int)node->pos);
+        }
+
+        for (uint32_t pc = node->arg; pc != 0;) {
+            const uint32_t next = INSN_ARG(ctx->code[pc]);
+
+            ctx->code[pc] = INSN(node->op, ctx->code_len - (int)pc);
+            pc            = next;
+        }
+        ctx->code[ctx->code_len++] = INSN(OP_LOOP, count);
+        ctx->reg_len               = 1 + count;
+
+        if (!_emit_segment(ctx, node->b, node->a)) {
+            return false;
+        }
+
+        ctx->code[ctx->code_len++] = INSN(OP_RET, node->pos);
+        regs                       = GB_MAX(regs, ctx->reg_len);
+    }
+
+    ctx->reg_len = regs;
+    return true;
+}
+
+/**
+ * @brief Translates an expression into postfix bytecode.
+ *
+ * Runs the precedence-climbing parser directly over the caller's buffer,
+ * which instead of computing values emits one instruction per operand or
+ * operator.
+ * The operand stack is only simulated (num_top), which is enough to record
+ * the deepest stack the program will ever need. The resulting code is then
+ * passed through the optimizer.
+ *
+ * @param[in,out] ctx       Compiler context; receives code and constant pool.
+ * @param[in]     expr      Source expression (need not be null-terminated).
+ * @param[in]     len       Length of the expression.
+ * @param[in]     syms      Symbol table resolving variable names, or NULL.
+ * @param[in]     defs_only Compile function definitions only (no code).
+ * @param[out]    err       Error report (always valid).
+ *
+ * @return `true` if the expression is valid, `false` otherwise.
+ */
+static bool _compile_expr(calc_context_t  *ctx,       //
+                          const char      *expr,      //
+                          size_t           len,       //
+                          gb_calc_syms_t  *syms,      //
+                          bool             defs_only, //
+                          gb_calc_error_t *err) {
+    ctx->expr  = expr;
+    ctx->len   = 0;
+    ctx->syms  = syms;
+    ctx->err   = err;
+    ctx->grown = false;
+
+    err->code = GB_CALC_OK;
+    err->pos  = 0;
+    err->row  = 0;
+
+    if (!expr || !len) {
+        return _set_error(ctx, (!expr) ? GB_CALC_E_NULL_EXPR : GB_CALC_E_EMPTY_EXPR, 0);
+    }
+
+    if (!_alloc_context(ctx, len)) {
+        return false;
+    }
+
+    ctx->len = (int)len;
+
+    for (;;) {
+        ctx->num_top    = -1;
+        ctx->num_max    = -1;
+        ctx->op__top    = -1;
+        ctx->i          = 0;
+        ctx->local_len  = 0;
+        ctx->local_min  = 0;
+        ctx->func_len   = 0;
+        ctx->fcode_len  = 0;
+        ctx->fpool_len  = 0;
+        ctx->call_top   = -1;
+        ctx->loop_depth = 0;
+        ctx->loop_max   = 0;
+        ctx->code_len   = 0;
+        ctx->pool_len   = 0;
+
+        if (_parse_expr(ctx, defs_only) && (defs_only || _optimize_code(ctx))) {
+            return true;
+        }
+
+        // Inlined function bodies or reduction bodies outgrew the arrays:
+        // retry with twice the room
+        if ((err->code != GB_CALC_E_LIMIT) || !ctx->grown || (ctx->cap > (int)MAX_INLINE_LEN)) {
+            return false;
+        }
+
+        err->code = GB_CALC_OK;
+        err->pos  = 0;
+
+        if (!_alloc_context(ctx, GB_MIN(2 * (size_t)ctx->cap, (size_t)MAX_INLINE_LEN + 1))) {
+            return false;
+        }
+    }
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (Evaluator)
+// *****************************************************************************
+// *****************************************************************************
+
+/**
+ * @brief Records a run-time error raised by an instruction.
+ *
+ * @param[out] err  Error report.
+ * @param[in]  code Error code.
+ * @param[in]  insn Failing instruction (its argument is the source offset).
+ * @param[in]  row  Failing element (batch evaluation) or 0.
+ *
+ * @return INFINITY, the result of a failed evaluation.
+ */
+static double _raise_error(gb_calc_error_t *err, gb_calc_errno_t code, calc_insn_t insn, size_t row) {
+    err->code = code;
+    err->pos  = INSN_ARG(insn);
+    err->row  = row;
+    return INFINITY;
+}
+
+/*
+    Dispatch strategy for the scalar evaluator.
+
+    With GCC/Clang the evaluator uses threaded code: every handler ends with
+    its own indirect jump through a label table (computed goto), straight to
+    the handler of the next opcode. Each opcode therefore gets its own branch
+    history instead of sharing the single, badly predicted jump of a switch.
+
+    Elsewhere, or when GB_CALC_SWITCH_DISPATCH is defined, the same handlers
+    are compiled as the cases of a portable switch loop.
+ */
+#if defined(__GNUC__) && !defined(GB_CALC_SWITCH_DISPATCH)
+#define GB_CALC_THREADED 1
+#else
+#define GB_CALC_THREADED 0
+#endif
+
+#if GB_CALC_THREADED
+#define VM_DISPATCH() goto *dispatch[INSN_OP(*ip)];
+#define VM_CASE(op)   L_##op:
+#define VM_NEXT()     goto *dispatch[INSN_OP(*++ip)]
+#define VM_DEFAULT()  L_DEFAULT : __attribute__((unused)); // only the compiler emits code
+#define VM_LABEL(op)  [op] = &&L_##op
+#else
+#define VM_DISPATCH() for (;; ++ip) switch (INSN_OP(*ip))
+#define VM_CASE(op)   case op:
+#define VM_NEXT()     continue
+#define VM_DEFAULT()  default:
+#endif
+
+/**
+ * @brief Returns the value of a reduction over an empty range.
+ */
+static inline double _reduce_identity(calc_op_t op) {
+    switch (op) {
+        case OP_PROD:
+            return 1;
+        case OP_MIN:
+            return INFINITY;
+        case OP_MAX:
+            return -INFINITY;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Counts the indices `lo, lo + 1, ...` of a reduction range, up to
+ * `hi` included.
+ *
+ * An empty range, or one with a NaN bound, has no index.
+ *
+ * @param[in]  body  Body header (OP_LOOP) of the reduction.
+ * @param[in]  lo    Lower bound.
+ * @param[in]  hi    Upper bound.
+ * @param[out] count Number of indices.
+ * @param[out] err   Error report, set if the range is too long (its offset is
+ *                   the argument of the OP_RET ending the body).
+ *
+ * @return `true` on success, `false` on error.
+ */
+static bool _reduce_count(const calc_insn_t *body, double lo, double hi, uint64_t *count, gb_calc_error_t *err) {
+    *count = 0;
+
+    if (!(lo <= hi)) {
+        return true;
+    }
+
+    const double span = floor(hi - lo);
+
+    if (!(span < MAX_LOOP_SPAN)) {
+        const calc_insn_t *ret = body + 1;
+
+        while (INSN_OP(*ret) != OP_RET) {
+            ret++;
+        }
+
+        _raise_error(err, GB_CALC_E_RANGE, *ret, 0);
+        return false;
+    }
+
+    *count = (uint64_t)span + 1;
+    return true;
+}
+
+// The reduction loop runs its body through the block evaluator (see below)
+static void _run_block(const gb_calc_prog_t *prog, //
+                       const double *const  *cols, //
+                       size_t                base, //
+                       size_t                m,    //
+                       double (*stack)[GB_CALC_BLOCK],
+                       double (*regs)[GB_CALC_BLOCK],
+                       double          *out,
+                       gb_calc_error_t *err);
+
+/**
+ * @brief Runs a range reduction.
+ *
+ * The body is a code segment of its own, run GB_CALC_BLOCK indices at a time
+ * by the block evaluator: register 0 holds the indices, registers 1..k the
+ * captured values, broadcast once. The range is never materialized and the
+ * values of each block are combined in index order.
+ *
+ * @param[in]  prog   Program holding the body.
+ * @param[in]  op     Reduction opcode.
+ * @param[in]  body   Body header (OP_LOOP).
+ * @param[in]  args   Lower bound, upper bound and the `k` captured values,
+ *                    `stride` doubles apart.
+ * @param[in]  stride Distance between two arguments.
+ * @param[out] out    Result (may alias `args`).
+ * @param[out] err    Error report, left untouched on success.
+ *
+ * @return `true` on success, `false` on error.
+ */
+static bool _run_reduce(const gb_calc_prog_t *prog, //
+                        calc_op_t             op,   //
+                        const calc_insn_t    *body, //
+                        const double         *args, //
+                        size_t                stride,
+                        double               *out,
+                        gb_calc_error_t      *err) {
+    const double lo  = args[0];
+    double       acc = _reduce_identity(op);
+    uint64_t     count;
+
+    if (!_reduce_count(body, lo, args[stride], &count, err)) {
+        return false;
+    }
+
+    if (count == 0) {
+        *out = acc;
+        return true;
+    }
+
+    // The body runs as a program of its own, with the rows of the enclosing
+    // code left untouched
+    const gb_calc_prog_t sub = {
+        .code  = body + 1,
+        .pool  = prog->pool,
+        .vars  = prog->vars,
+        .depth = prog->depth,
+        .regs  = prog->regs,
+    };
+
+    double local[BATCH_LOCAL_ROWS][GB_CALC_BLOCK];
+    double (*rows)[GB_CALC_BLOCK] = local;
+
+    const size_t size = (sub.depth + sub.regs) * sizeof(local[0]);
+
+    if (sub.depth + sub.regs > BATCH_LOCAL_ROWS) {
+        rows = _scratch_push(size);
+
+        if (!rows) {
+            _raise_error(err, GB_CALC_E_NO_MEMORY, 0, 0);
+            return false;
+        }
+    }
+
+    double (*regs)[GB_CALC_BLOCK] = rows + sub.depth;
+
+    for (uint32_t c = 1; c <= INSN_ARG(*body); ++c) {
+        const double v = args[(1 + c) * stride];
+        for (size_t k = 0; k < GB_CALC_BLOCK; ++k) {
+            regs[c][k] = v;
+        }
+    }
+
+    gb_calc_error_t sub_err = {.code = GB_CALC_OK};
+    double          vals[GB_CALC_BLOCK];
+
+    for (uint64_t done = 0; done < count; done += GB_CALC_BLOCK) {
+        const size_t m = (size_t)GB_MIN(count - done, (uint64_t)GB_CALC_BLOCK);
+
+        for (size_t k = 0; k < m; ++k) {
+            regs[0][k] = lo + (double)(done + k);
+        }
+
+        _run_block(&sub, NULL, 0, m, rows, regs, vals, &sub_err);
+
+        if (sub_err.code != GB_CALC_OK) {
+            break;
+        }
+
+        switch (op) {
+            case OP_SUM:
+                for (size_t k = 0; k < m; ++k) {
+                    acc += vals[k];
+                }
+                break;
+            case OP_PROD:
+                for (size_t k = 0; k < m; ++k) {
+                    acc *= vals[k];
+                }
+                break;
+            case OP_MIN:
+                for (size_t k = 0; k < m; ++k) {
+                    acc = (vals[k] < acc) ? vals[k] : acc;
+                }
+                break;
+            default:
+                for (size_t k = 0; k < m; ++k) {
+                    acc = (vals[k] > acc) ? vals[k] : acc;
+                }
+                break;
+        }
+    }
+
+    if (rows != local) {
+        _scratch_pop(size);
+    }
+
+    if (sub_err.code != GB_CALC_OK) {
+        err->code = sub_err.code;
+        err->pos  = sub_err.pos;
+        err->row  = 0;
+        return false;
+    }
+
+    *out = acc;
+    return true;
+}
+
+/**
+ * @brief Runs a compiled program.
+ *
+ * The compiler guarantees that the program never needs more than
+ * `prog->depth` operand slots and `prog->regs` temporaries, that every
+ * operator finds its operands and that the code ends with OP_RET, so the
+ * handlers perform no stack or bounds checks at all. Only the operations
+ * that can fail test their operands; the first failure stops the program.
+ *
+ * @param[in]  prog  Compiled program.
+ * @param[out] slots Scratch for `prog->depth` operands and `prog->regs`
+ *                   temporaries.
+ * @param[out] err   Error report, left untouched on success.
+ *
+ * @return The value left on top of the operand stack, or INFINITY on error.
+ */
+#if GB_CALC_THREADED
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic" // computed goto is a GNU extension
+#endif
+static double _run_prog(const gb_calc_prog_t *prog, double *slots, gb_calc_error_t *err) {
+    double *regs = slots + prog->depth;
+    double *sp   = slots - 1;
+
+    const calc_insn_t *ip   = prog->code;
+    const double      *pool = prog->pool;
+    const double      *vars = prog->vars;
+
+    const bool fast = _fast_math();
+
+#if GB_CALC_THREADED
+    static const void *const dispatch[OP_COUNT] = {
+        VM_LABEL(OP_PUSH), VM_LABEL(OP_LOAD), VM_LABEL(OP_TEE),  VM_LABEL(OP_REG),  VM_LABEL(OP_RET),
+        VM_LABEL(OP_SEQ),  VM_LABEL(OP_NEG),  VM_LABEL(OP_NOT),  VM_LABEL(OP_BNOT), VM_LABEL(OP_SIN),
+        VM_LABEL(OP_ASIN), VM_LABEL(OP_COS),  VM_LABEL(OP_ACOS), VM_LABEL(OP_TAN),  VM_LABEL(OP_ATAN),
+        VM_LABEL(OP_SQRT), VM_LABEL(OP_EXP),  VM_LABEL(OP_LOG),  VM_LABEL(OP_LOG2), VM_LABEL(OP_ADD),
+        VM_LABEL(OP_SUB),  VM_LABEL(OP_MUL),  VM_LABEL(OP_DIV),  VM_LABEL(OP_MOD),  VM_LABEL(OP_POW),
+        VM_LABEL(OP_LOOP), VM_LABEL(OP_SKIP), VM_LABEL(OP_SUM),  VM_LABEL(OP_PROD), VM_LABEL(OP_MIN),
+        VM_LABEL(OP_MAX),
+    };
+#endif
+
+    VM_DISPATCH() {
+        VM_CASE(OP_PUSH) {
+            *++sp = pool[INSN_ARG(*ip)];
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_LOAD) {
+            *++sp = vars[INSN_ARG(*ip)];
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_TEE) {
+            regs[INSN_ARG(*ip)] = *sp;
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_REG) {
+            *++sp = regs[INSN_ARG(*ip)];
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_RET) {
+            return *sp;
+        }
+
+        VM_CASE(OP_SEQ) {
+            sp--;
+            *sp = sp[1];
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_NEG) {
+            *sp = -*sp;
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_NOT) {
+            if (!_is_int_operand(*sp)) {
+                return _raise_error(err, GB_CALC_E_RANGE, *ip, 0);
+            }
+            *sp = !(int64_t)*sp;
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_BNOT) {
+            if (!_is_int_operand(*sp)) {
+                return _raise_error(err, GB_CALC_E_RANGE, *ip, 0);
+            }
+            *sp = (double)~(int64_t)*sp;
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_SIN) {
+            *sp = fast ? gb_fmath_sin(*sp) : sin(*sp);
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_ASIN) {
+            *sp = asin(*sp);
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_COS) {
+            *sp = fast ? gb_fmath_cos(*sp) : cos(*sp);
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_ACOS) {
+            *sp = acos(*sp);
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_TAN) {
+            *sp = fast ? gb_fmath_tan(*sp) : tan(*sp);
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_ATAN) {
+            *sp = atan(*sp);
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_SQRT) {
+            if (*sp < 0) {
+                return _raise_error(err, GB_CALC_E_SQRT, *ip, 0);
+            }
+            *sp = sqrt(*sp);
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_EXP) {
+            *sp = fast ? gb_fmath_exp(*sp) : exp(*sp);
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_LOG) {
+            if (*sp <= 0) {
+                return _raise_error(err, GB_CALC_E_LOG, *ip, 0);
+            }
+            *sp = fast ? gb_fmath_log(*sp) : log(*sp);
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_LOG2) {
+            if (*sp <= 0) {
+                return _raise_error(err, GB_CALC_E_LOG, *ip, 0);
+            }
+            *sp = fast ? gb_fmath_log2(*sp) : log2(*sp);
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_ADD) {
+            sp--;
+            *sp = sp[0] + sp[1];
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_SUB) {
+            sp--;
+            *sp = sp[0] - sp[1];
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_MUL) {
+            sp--;
+            *sp = sp[0] * sp[1];
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_DIV) {
+            sp--;
+            if (sp[1] == 0) {
+                return _raise_error(err, GB_CALC_E_DIV_ZERO, *ip, 0);
+            }
+            *sp = sp[0] / sp[1];
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_MOD) {
+            sp--;
+            if (sp[1] == 0) {
+                return _raise_error(err, GB_CALC_E_MOD_ZERO, *ip, 0);
+            }
+            *sp = fmod(sp[0], sp[1]);
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_POW) {
+            sp--;
+            *sp = fast ? gb_fmath_pow(sp[0], sp[1]) : pow(sp[0], sp[1]);
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_SKIP) {
+            if (!(sp[-1] <= sp[0])) {
+                // Empty range: the reduction never reads its captures
+                const calc_insn_t *red = ip + INSN_ARG(*ip);
+
+                sp += INSN_ARG(red[INSN_ARG(*red)]);
+                ip = red - 1;
+            }
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_SUM)
+        VM_CASE(OP_PROD)
+        VM_CASE(OP_MIN)
+        VM_CASE(OP_MAX) {
+            const calc_insn_t *body = ip + INSN_ARG(*ip);
+
+            sp -= INSN_ARG(*body) + 1;
+            if (!_run_reduce(prog, (calc_op_t)INSN_OP(*ip), body, sp, 1, sp, err)) {
+                return INFINITY;
+            }
+            VM_NEXT();
+        }
+
+        VM_CASE(OP_LOOP) // body headers are jumped over, never run
+        VM_DEFAULT() {
+            return _raise_error(err, GB_CALC_E_BAD_PROG, 0, 0);
+        }
+    }
+}
+#if GB_CALC_THREADED
+#pragma GCC diagnostic pop
+#endif
+
+#undef VM_DISPATCH
+#undef VM_CASE
+#undef VM_NEXT
+#undef VM_DEFAULT
+#undef VM_LABEL
+
+// Block evaluator helpers: each one applies a single operation to a whole
+// row of the block stack, so the loops are plain element-wise kernels the
+// compiler can unroll and vectorize.
+#define BLOCK_UNARY(expr)                \
+    {                                    \
+        double *restrict d = stack[top]; \
+        for (size_t k = 0; k < m; ++k) { \
+            const double x = d[k];       \
+            d[k]           = (expr);     \
+        }                                \
+    }
+
+#define BLOCK_BINARY(expr)                         \
+    {                                              \
+        double *restrict       d = stack[top - 1]; \
+        const double *restrict r = stack[top];     \
+        for (size_t k = 0; k < m; ++k) {           \
+            const double a = d[k];                 \
+            const double b = r[k];                 \
+            d[k]           = (expr);               \
+        }                                          \
+        top--;                                     \
+    }
+
+// Elementary functions run a whole row through the vector kernels of gb_vmath
+#define BLOCK_UNARY_VEC(func) func(stack[top], stack[top], m)
+
+// Row functions of the fast-math mode, with the signature of gb_vmath
+#define FMATH_ROW(name)                                                          \
+    static void _fmath_row_##name(double *dst, const double *src, size_t n) { \
+        for (size_t k = 0; k < n; ++k) {                                       \
+            dst[k] = gb_fmath_##name(src[k]);                                  \
+        }                                                                      \
+    }
+
+FMATH_ROW(sin)
+FMATH_ROW(cos)
+FMATH_ROW(tan)
+FMATH_ROW(exp)
+FMATH_ROW(log)
+FMATH_ROW(log2)
+
+// Row function of an elementary function in the current math mode
+#define BLOCK_MATH(name) (fast ? _fmath_row_##name : gb_vmath_##name)
+
+// Checked variants for the operations that can fail: the lanes whose operand
+// is out of domain are flagged in `bad` and reported once per instruction.
+// Lanes computing captures that their empty range skips (`idle`) never fail.
+#define BLOCK_UNARY_VEC_CHECKED(func, fail, code)            \
+    {                                                        \
+        double *restrict d   = stack[top];                   \
+        unsigned         any = 0;                            \
+        for (size_t k = 0; k < m; ++k) {                     \
+            const double   x = d[k];                         \
+            const unsigned f = (fail) && !idle[k];           \
+            bad[k] |= (unsigned char)f;                      \
+            any |= f;                                        \
+        }                                                    \
+        func(d, d, m);                                       \
+        if (any) {                                           \
+            _raise_block_error(err, code, *ip, bad, base, m); \
+        }                                                    \
+    }
+
+#define BLOCK_UNARY_CHECKED(expr, fail, code)                \
+    {                                                        \
+        double *restrict d   = stack[top];                   \
+        unsigned         any = 0;                            \
+        for (size_t k = 0; k < m; ++k) {                     \
+            const double   x   = d[k];                       \
+            const unsigned out = (fail);                     \
+            const unsigned f   = out && !idle[k];            \
+            bad[k] |= (unsigned char)f;                      \
+            any |= f;                                        \
+            d[k] = out ? 0 : (expr);                         \
+        }                                                    \
+        if (any) {                                           \
+            _raise_block_error(err, code, *ip, bad, base, m); \
+        }                                                    \
+    }
+
+#define BLOCK_BINARY_CHECKED(expr, fail, code)               \
+    {                                                        \
+        double *restrict       d   = stack[top - 1];         \
+        const double *restrict r   = stack[top];             \
+        unsigned               any = 0;                      \
+        for (size_t k = 0; k < m; ++k) {                     \
+            const double   a = d[k];                         \
+            const double   b = r[k];                         \
+            const unsigned f = (fail) && !idle[k];           \
+            bad[k] |= (unsigned char)f;                      \
+            any |= f;                                        \
+            d[k] = (expr);                                   \
+        }                                                    \
+        if (any) {                                           \
+            _raise_block_error(err, code, *ip, bad, base, m); \
+        }                                                    \
+        top--;                                               \
+    }
+
+/**
+ * @brief Records the first run-time error of a batch evaluation.
+ *
+ * Until an error is recorded every flagged lane belongs to the current
+ * instruction, so the first flagged lane is the failing element.
+ */
+static void _raise_block_error(gb_calc_error_t     *err,  //
+                               gb_calc_errno_t      code, //
+                               calc_insn_t          insn, //
+                               const unsigned char *bad,  //
+                               size_t               base, //
+                               size_t               m) {
+    if (err->code != GB_CALC_OK) {
+        return;
+    }
+
+    size_t k = 0;
+    while ((k < m) && !bad[k]) {
+        k++;
+    }
+
+    _raise_error(err, code, insn, base + k);
+}
+
+/**
+ * @brief Runs a compiled program over one block of inputs.
+ *
+ * The interpreter dispatches once per instruction and then loops over all `m`
+ * lanes, so the dispatch cost is shared by the whole block. Every stack slot
+ * is a row of GB_CALC_BLOCK values.
+ *
+ * @param[in]  prog  Compiled program.
+ * @param[in]  cols  Input columns indexed by symbol ordinal (may be NULL).
+ * @param[in]  base  Index of the first element of the block.
+ * @param[in]  m     Number of elements in the block (<= GB_CALC_BLOCK).
+ * @param[out] stack Scratch rows, at least `prog->depth` of them.
+ * @param[out] regs  Scratch rows, at least `prog->regs` of them.
+ * @param[out] out   Destination for the `m` results (INFINITY where failed).
+ * @param[out] err   Error report, set by the first failing element only.
+ */
+static void _run_block(const gb_calc_prog_t *prog, //
+                       const double *const  *cols, //
+                       size_t                base, //
+                       size_t                m,    //
+                       double (*stack)[GB_CALC_BLOCK],
+                       double (*regs)[GB_CALC_BLOCK],
+                       double          *out,
+                       gb_calc_error_t *err) {
+    unsigned char bad[GB_CALC_BLOCK]  = {0};
+    unsigned char idle[GB_CALC_BLOCK] = {0}; // pending OP_SKIP taken per lane
+    int           top                 = -1;
+    const bool    fast                = _fast_math();
+
+    const calc_insn_t *ip = prog->code;
+
+    // Reductions of the pending OP_SKIP, innermost last
+    const calc_insn_t *skips[MAX_LOOP_DEPTH];
+    int                skip_len = 0;
+
+    for (; INSN_OP(*ip) != OP_RET; ++ip) {
+        switch (INSN_OP(*ip)) {
+            case OP_PUSH: {
+                const double v = prog->pool[INSN_ARG(*ip)];
+                double      *d = stack[++top];
+                for (size_t k = 0; k < m; ++k) {
+                    d[k] = v;
+                }
+            } break;
+
+            case OP_LOAD: {
+                const uint32_t ord = INSN_ARG(*ip);
+                double        *d   = stack[++top];
+
+                if (cols && cols[ord]) {
+                    gb_memcpy(d, cols[ord] + base, m * sizeof(double));
+                } else {
+                    const double v = prog->vars[ord];
+                    for (size_t k = 0; k < m; ++k) {
+                        d[k] = v;
+                    }
+                }
+            } break;
+
+            case OP_TEE:
+                gb_memcpy(regs[INSN_ARG(*ip)], stack[top], m * sizeof(double));
+                break;
+
+            case OP_REG:
+                top++;
+                gb_memcpy(stack[top], regs[INSN_ARG(*ip)], m * sizeof(double));
+                break;
+
+            case OP_SEQ:
+                gb_memcpy(stack[top - 1], stack[top], m * sizeof(double));
+                top--;
+                break;
+
+            case OP_NEG:
+                BLOCK_UNARY(-x);
+                break;
+
+            case OP_NOT:
+                BLOCK_UNARY_CHECKED(!(int64_t)x, !_is_int_operand(x), GB_CALC_E_RANGE);
+                break;
+
+            case OP_BNOT:
+                BLOCK_UNARY_CHECKED((double)~(int64_t)x, !_is_int_operand(x), GB_CALC_E_RANGE);
+                break;
+
+            case OP_SIN:
+                BLOCK_UNARY_VEC(BLOCK_MATH(sin));
+                break;
+
+            case OP_ASIN:
+                BLOCK_UNARY_VEC(gb_vmath_asin);
+                break;
+
+            case OP_COS:
+                BLOCK_UNARY_VEC(BLOCK_MATH(cos));
+                break;
+
+            case OP_ACOS:
+                BLOCK_UNARY_VEC(gb_vmath_acos);
+                break;
+
+            case OP_TAN:
+                BLOCK_UNARY_VEC(BLOCK_MATH(tan));
+                break;
+
+            case OP_ATAN:
+                BLOCK_UNARY_VEC(gb_vmath_atan);
+                break;
+
+            case OP_SQRT:
+                BLOCK_UNARY_VEC_CHECKED(gb_vmath_sqrt, x < 0, GB_CALC_E_SQRT);
+                break;
+
+            case OP_EXP:
+                BLOCK_UNARY_VEC(BLOCK_MATH(exp));
+                break;
+
+            case OP_LOG:
+                BLOCK_UNARY_VEC_CHECKED(BLOCK_MATH(log), x <= 0, GB_CALC_E_LOG);
+                break;
+
+            case OP_LOG2:
+                BLOCK_UNARY_VEC_CHECKED(BLOCK_MATH(log2), x <= 0, GB_CALC_E_LOG);
+                break;
+
+            case OP_ADD:
+                BLOCK_BINARY(a + b);
+                break;
+
+            case OP_SUB:
+                BLOCK_BINARY(a - b);
+                break;
+
+            case OP_MUL:
+                BLOCK_BINARY(a * b);
+                break;
+
+            case OP_DIV:
+                BLOCK_BINARY_CHECKED(a / b, b == 0, GB_CALC_E_DIV_ZERO);
+                break;
+
+            case OP_MOD:
+                BLOCK_BINARY_CHECKED(fmod(a, b), b == 0, GB_CALC_E_MOD_ZERO);
+                break;
+
+            case OP_POW:
+                BLOCK_BINARY(fast ? gb_fmath_pow(a, b) : pow(a, b));
+                break;
+
+            case OP_SKIP: {
+                // A lane with an empty range runs the captures without effect;
+                // when all of them do, the captures are jumped over
+                const calc_insn_t *red  = ip + INSN_ARG(*ip);
+                const double      *lo   = stack[top - 1];
+                const double      *hi   = stack[top];
+                bool               live = false;
+
+                for (size_t k = 0; k < m; ++k) {
+                    idle[k] += !(lo[k] <= hi[k]);
+                    live = live || !idle[k];
+                }
+
+                skips[skip_len++] = red;
+                if (!live) {
+                    top += (int)INSN_ARG(red[INSN_ARG(*red)]);
+                    ip = red - 1;
+                }
+            } break;
+
+            case OP_SUM:
+            case OP_PROD:
+            case OP_MIN:
+            case OP_MAX: {
+                // Each lane runs its own range
+                const calc_insn_t *body = ip + INSN_ARG(*ip);
+
+                top -= (int)INSN_ARG(*body) + 1;
+
+                if ((skip_len > 0) && (skips[skip_len - 1] == ip)) {
+                    skip_len--;
+                    for (size_t k = 0; k < m; ++k) {
+                        idle[k] -= !(stack[top][k] <= stack[top + 1][k]);
+                    }
+                }
+
+                for (size_t k = 0; k < m; ++k) {
+                    gb_calc_error_t lane_err = {.code = GB_CALC_OK};
+
+                    if (bad[k] || idle[k] || _run_reduce(prog, (calc_op_t)INSN_OP(*ip), body, &stack[top][k], GB_CALC_BLOCK,
+                                              &stack[top][k], &lane_err)) {
+                        continue;
+                    }
+
+                    bad[k] = 1;
+                    if (err->code == GB_CALC_OK) {
+                        *err     = lane_err;
+                        err->row = base + k;
+                    }
+                }
+            } break;
+
+            default:
+                if (err->code == GB_CALC_OK) {
+                    _raise_error(err, GB_CALC_E_BAD_PROG, 0, base);
+                }
+                for (size_t k = 0; k < m; ++k) {
+                    out[k] = INFINITY;
+                }
+                return;
+        }
+    }
+
+    for (size_t k = 0; k < m; ++k) {
+        out[k] = bad[k] ? INFINITY : stack[0][k];
+    }
+}
+
+#undef BLOCK_UNARY
+#undef BLOCK_BINARY
+#undef BLOCK_UNARY_VEC
+#undef BLOCK_UNARY_VEC_CHECKED
+#undef BLOCK_UNARY_CHECKED
+#undef BLOCK_BINARY_CHECKED
+#undef BLOCK_MATH
+#undef FMATH_ROW
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (Differentiation)
+// *****************************************************************************
+// *****************************************************************************
+
+/**
+ * @brief Computes an operation and its partial derivatives.
+ *
+ * `d[0]` receives the result, `d[1]` its derivative with respect to the first
+ * operand and `d[2]` with respect to the second (0 for unary operations). The
+ * values match _run_prog(), fast-math mode included. `!` and `~` are
+ * piecewise constant, so their derivative is 0.
+ *
+ * @return GB_CALC_OK, or the run-time error raised by the operation.
+ */
+static gb_calc_errno_t _dual_rule(calc_op_t op, double x, double y, bool fast, double d[3]) {
+    d[2] = 0;
+
+    switch (op) {
+        case OP_NEG:
+            d[0] = -x;
+            d[1] = -1;
+            break;
+
+        case OP_NOT:
+            if (!_is_int_operand(x)) {
+                return GB_CALC_E_RANGE;
+            }
+            d[0] = !(int64_t)x;
+            d[1] = 0;
+            break;
+
+        case OP_BNOT:
+            if (!_is_int_operand(x)) {
+                return GB_CALC_E_RANGE;
+            }
+            d[0] = (double)~(int64_t)x;
+            d[1] = 0;
+            break;
+
+        case OP_SIN:
+            d[0] = fast ? gb_fmath_sin(x) : sin(x);
+            d[1] = fast ? gb_fmath_cos(x) : cos(x);
+            break;
+
+        case OP_ASIN:
+            d[0] = asin(x);
+            d[1] = 1 / sqrt(1 - (x * x));
+            break;
+
+        case OP_COS:
+            d[0] = fast ? gb_fmath_cos(x) : cos(x);
+            d[1] = fast ? -gb_fmath_sin(x) : -sin(x);
+            break;
+
+        case OP_ACOS:
+            d[0] = acos(x);
+            d[1] = -1 / sqrt(1 - (x * x));
+            break;
+
+        case OP_TAN:
+            d[0] = fast ? gb_fmath_tan(x) : tan(x);
+            d[1] = 1 + (d[0] * d[0]);
+            break;
+
+        case OP_ATAN:
+            d[0] = atan(x);
+            d[1] = 1 / (1 + (x * x));
+            break;
+
+        case OP_SQRT:
+            if (x < 0) {
+                return GB_CALC_E_SQRT;
+            }
+            d[0] = sqrt(x);
+            d[1] = 0.5 / d[0];
+            break;
+
+        case OP_EXP:
+            d[0] = fast ? gb_fmath_exp(x) : exp(x);
+            d[1] = d[0];
+            break;
+
+        case OP_LOG:
+            if (x <= 0) {
+                return GB_CALC_E_LOG;
+            }
+            d[0] = fast ? gb_fmath_log(x) : log(x);
+            d[1] = 1 / x;
+            break;
+
+        case OP_LOG2:
+            if (x <= 0) {
+                return GB_CALC_E_LOG;
+            }
+            d[0] = fast ? gb_fmath_log2(x) : log2(x);
+            d[1] = 1 / (x * M_LN2);
+            break;
+
+        case OP_ADD:
+            d[0] = x + y;
+            d[1] = 1;
+            d[2] = 1;
+            break;
+
+        case OP_SUB:
+            d[0] = x - y;
+            d[1] = 1;
+            d[2] = -1;
+            break;
+
+        case OP_MUL:
+            d[0] = x * y;
+            d[1] = y;
+            d[2] = x;
+            break;
+
+        case OP_DIV:
+            if (y == 0) {
+                return GB_CALC_E_DIV_ZERO;
+            }
+            d[0] = x / y;
+            d[1] = 1 / y;
+            d[2] = -d[0] / y;
+            break;
+
+        case OP_MOD:
+            // fmod(x, y) = x - trunc(x / y) * y, with a piecewise constant quotient
+            if (y == 0) {
+                return GB_CALC_E_MOD_ZERO;
+            }
+            d[0] = fmod(x, y);
+            d[1] = 1;
+            d[2] = -trunc(x / y);
+            break;
+
+        case OP_POW:
+            // x^0 is constant in x, and x^y only varies with y for x > 0
+            d[0] = fast ? gb_fmath_pow(x, y) : pow(x, y);
+            d[1] = (y == 0) ? 0 : y * (fast ? gb_fmath_pow(x, y - 1) : pow(x, y - 1));
+            d[2] = (x > 0) ? d[0] * (fast ? gb_fmath_log(x) : log(x)) : 0;
+            break;
+
+        default:
+            return GB_CALC_E_BAD_PROG;
+    }
+
+    return GB_CALC_OK;
+}
+
+/**
+ * @brief Chain rule term: partial derivative times operand tangent.
+ *
+ * An operand that does not depend on a variable contributes nothing, even
+ * where the partial derivative is infinite (e.g. sqrt(y) at y = 0 when
+ * differentiating with respect to x).
+ */
+static inline double _dual_term(double partial, double tangent) {
+    return (tangent == 0) ? 0 : partial * tangent;
+}
+
+// The reduction loop runs its body through the dual evaluator (see below)
+static double _run_dual(const gb_calc_prog_t *prog, //
+                        const int            *wrt,  //
+                        size_t                n,    //
+                        double               *slots,
+                        double               *grad,
+                        gb_calc_error_t      *err);
+
+/**
+ * @brief Runs a range reduction on dual numbers.
+ *
+ * The body runs once per index, with the index in register 0 (a constant:
+ * the tangents of the bounds do not matter) and the captured values, with
+ * their tangents, in registers 1..k. The tangent of the result follows the
+ * combination: sum of the tangents, product rule, or the tangent of the
+ * selected value.
+ *
+ * @param[in]     prog Program holding the body.
+ * @param[in]     op   Reduction opcode.
+ * @param[in]     body Body header (OP_LOOP).
+ * @param[in]     wrt  Ordinals of the `n` variables to differentiate against.
+ * @param[in]     n    Number of variables.
+ * @param[in,out] args Lower bound, upper bound and the captured values, `n + 1`
+ *                     doubles each; receives the result.
+ * @param[out]    err  Error report, left untouched on success.
+ *
+ * @return `true` on success, `false` on error.
+ */
+static bool _run_reduce_dual(const gb_calc_prog_t *prog, //
+                             calc_op_t             op,   //
+                             const calc_insn_t    *body, //
+                             const int            *wrt,  //
+                             size_t                n,    //
+                             double               *args,
+                             gb_calc_error_t      *err) {
+    const size_t w  = n + 1;
+    const double lo = args[0];
+    uint64_t     count;
+
+    if (!_reduce_count(body, lo, args[w], &count, err)) {
+        return false;
+    }
+
+    if (count == 0) {
+        // The captures may not have been computed (see OP_SKIP)
+        args[0] = _reduce_identity(op);
+        for (size_t k = 1; k < w; ++k) {
+            args[k] = 0;
+        }
+        return true;
+    }
+
+    const gb_calc_prog_t sub = {
+        .code  = body + 1,
+        .pool  = prog->pool,
+        .vars  = prog->vars,
+        .depth = prog->depth,
+        .regs  = prog->regs,
+    };
+
+    // Body slots, then the accumulator and the value of one index
+    const size_t size = (sub.depth + sub.regs + 2) * w;
+
+    double  local[EVAL_LOCAL_SLOTS];
+    double *slots = local;
+
+    if (size > EVAL_LOCAL_SLOTS) {
+        slots = _scratch_push(size * sizeof(double));
+
+        if (!slots) {
+            _raise_error(err, GB_CALC_E_NO_MEMORY, 0, 0);
+            return false;
+        }
+    }
+
+    double *regs = slots + (sub.depth * w);
+    double *acc  = regs + (sub.regs * w);
+    double *val  = acc + w;
+
+    gb_memcpy(regs + w, args + (2 * w), INSN_ARG(*body) * w * sizeof(double));
+
+    for (size_t k = 1; k < w; ++k) {
+        regs[k] = 0;
+        acc[k]  = 0;
+    }
+    acc[0] = _reduce_identity(op);
+
+    bool ok = true;
+
+    for (uint64_t i = 0; i < count; ++i) {
+        regs[0] = lo + (double)i;
+        val[0]  = _run_dual(&sub, wrt, n, slots, val + 1, err);
+
+        if (err->code != GB_CALC_OK) {
+            ok = false;
+            break;
+        }
+
+        switch (op) {
+            case OP_SUM:
+                for (size_t k = 0; k < w; ++k) {
+                    acc[k] += val[k];
+                }
+                break;
+            case OP_PROD:
+                for (size_t k = 1; k < w; ++k) {
+                    acc[k] = _dual_term(val[0], acc[k]) + _dual_term(acc[0], val[k]);
+                }
+                acc[0] *= val[0];
+                break;
+            case OP_MIN:
+                if (val[0] < acc[0]) {
+                    gb_memcpy(acc, val, w * sizeof(double));
+                }
+                break;
+            default:
+                if (val[0] > acc[0]) {
+                    gb_memcpy(acc, val, w * sizeof(double));
+                }
+                break;
+        }
+    }
+
+    if (ok) {
+        gb_memcpy(args, acc, w * sizeof(double));
+    }
+
+    if (slots != local) {
+        _scratch_pop(size * sizeof(double));
+    }
+
+    return ok;
+}
+
+/**
+ * @brief Runs a compiled program on dual numbers (forward-mode AD).
+ *
+ * Every stack slot and temporary holds a value followed by its `n` tangents,
+ * the derivatives with respect to the variables in `wrt`. A variable load
+ * seeds the tangent of its own ordinal with 1; every operation then applies
+ * the chain rule to all tangents at once, so one pass yields the value and
+ * the whole gradient.
+ *
+ * @param[in]  prog  Compiled program.
+ * @param[in]  wrt   Ordinals of the `n` variables to differentiate against.
+ * @param[in]  n     Number of variables.
+ * @param[out] slots Scratch for `(prog->depth + prog->regs) * (n + 1)` values.
+ * @param[out] grad  Destination for the `n` derivatives.
+ * @param[out] err   Error report, left untouched on success.
+ *
+ * @return The value of the program, or INFINITY on error.
+ */
+static double _run_dual(const gb_calc_prog_t *prog, //
+                        const int            *wrt,  //
+                        size_t                n,    //
+                        double               *slots,
+                        double               *grad,
+                        gb_calc_error_t      *err) {
+    const size_t w    = n + 1; // slot width: value, then one tangent per variable
+    double      *regs = slots + (prog->depth * w);
+    double      *sp   = slots - w;
+    const bool   fast = _fast_math();
+
+    for (const calc_insn_t *ip = prog->code;; ++ip) {
+        const calc_op_t op = (calc_op_t)INSN_OP(*ip);
+
+        switch (op) {
+            case OP_PUSH:
+                sp += w;
+                sp[0] = prog->pool[INSN_ARG(*ip)];
+                for (size_t k = 1; k < w; ++k) {
+                    sp[k] = 0;
+                }
+                continue;
+
+            case OP_LOAD:
+                sp += w;
+                sp[0] = prog->vars[INSN_ARG(*ip)];
+                for (size_t k = 1; k < w; ++k) {
+                    sp[k] = ((uint32_t)wrt[k - 1] == INSN_ARG(*ip)) ? 1 : 0;
+                }
+                continue;
+
+            case OP_TEE:
+                gb_memcpy(regs + (INSN_ARG(*ip) * w), sp, w * sizeof(double));
+                continue;
+
+            case OP_REG:
+                sp += w;
+                gb_memcpy(sp, regs + (INSN_ARG(*ip) * w), w * sizeof(double));
+                continue;
+
+            case OP_RET:
+                gb_memcpy(grad, sp + 1, n * sizeof(double));
+                return sp[0];
+
+            case OP_SEQ:
+                sp -= w;
+                gb_memcpy(sp, sp + w, w * sizeof(double));
+                continue;
+
+            case OP_SKIP:
+                if (!(sp[-w] <= sp[0])) {
+                    const calc_insn_t *red = ip + INSN_ARG(*ip);
+
+                    sp += INSN_ARG(red[INSN_ARG(*red)]) * w;
+                    ip = red - 1;
+                }
+                continue;
+
+            default:
+                break;
+        }
+
+        if (_is_reduce_opcode(op)) {
+            const calc_insn_t *body = ip + INSN_ARG(*ip);
+
+            sp -= (INSN_ARG(*body) + 1) * w;
+            if (!_run_reduce_dual(prog, op, body, wrt, n, sp, err)) {
+                return INFINITY;
+            }
+            continue;
+        }
+
+        const bool binary = _is_binary_opcode(op);
+
+        if (!binary && !_is_unary_opcode(op)) {
+            return _raise_error(err, GB_CALC_E_BAD_PROG, 0, 0);
+        }
+
+        double       *a = binary ? sp - w : sp; // first operand, receives the result
+        const double *b = sp;                   // second operand (binary only)
+        double        d[3];
+
+        const gb_calc_errno_t code = _dual_rule(op, a[0], b[0], fast, d);
+
+        if (code != GB_CALC_OK) {
+            return _raise_error(err, code, *ip, 0);
+        }
+
+        a[0] = d[0];
+
+        if (binary) {
+            for (size_t k = 1; k < w; ++k) {
+                a[k] = _dual_term(d[1], a[k]) + _dual_term(d[2], b[k]);
+            }
+            sp -= w;
+        } else {
+            for (size_t k = 1; k < w; ++k) {
+                a[k] = _dual_term(d[1], a[k]);
+            }
+        }
+    }
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (Cache)
+// *****************************************************************************
+// *****************************************************************************
+
+static inline bool _is_literal_char(char ch) {
+    return (calc_chars[(unsigned char)ch].kind == TOK_NUMBER) || _is_ident_tail(ch);
+}
+
+/**
+ * @brief Tells whether whitespace between two characters separates tokens.
+ *
+ * That is the case between two characters of a name or a number ("1 2" is
+ * not "12") and before the sign of what could be an exponent ("1e -3" is not
+ * "1e-3"). Anywhere else whitespace can be dropped without changing tokens.
+ */
+static inline bool _is_separator(char prev, char next) {
+    if (!_is_literal_char(prev)) {
+        return false;
+    }
+
+    const char lower = (char)(prev | 0x20);
+
+    return _is_literal_char(next) || (((next == '+') || (next == '-')) && ((lower == 'e') || (lower == 'p')));
+}
+
+/**
+ * @brief Builds the cache key of an expression: its text without the
+ * whitespace that does not separate tokens.
+ *
+ * Whitespace that does separate tokens is kept as one space, so expressions
+ * with the same key always have the same value.
+ *
+ * @return The key length, or 0 if the expression is too long to be cached.
+ */
+static size_t _cache_key(const char *expr, char *key, uint32_t *hash) {
+    uint32_t h     = 2166136261U;
+    size_t   len   = 0;
+    bool     space = false; // whitespace seen since the last kept character
+
+    for (; *expr; ++expr) {
+        if (calc_chars[(unsigned char)*expr].kind == TOK_SPACE) {
+            space = true;
+            continue;
+        }
+
+        space = space && (len > 0) && _is_separator(key[len - 1], *expr);
+
+        if (len + space >= CACHE_KEY_MAX) {
+            return 0;
+        }
+
+        if (space) {
+            key[len++] = ' ';
+            h          = (h ^ (unsigned char)' ') * 16777619U;
+            space      = false;
+        }
+
+        key[len++] = *expr;
+        h          = (h ^ (unsigned char)*expr) * 16777619U;
+    }
+
+    *hash = h;
+    return len;
+}
+
+static void _cache_unlink(gb_calc_cache_t *cache, int32_t n) {
+    calc_cache_entry_t *entry = &cache->entries[n];
+
+    if (entry->prev >= 0) {
+        cache->entries[entry->prev].next = entry->next;
+    } else {
+        cache->head = entry->next;
+    }
+
+    if (entry->next >= 0) {
+        cache->entries[entry->next].prev = entry->prev;
+    } else {
+        cache->tail = entry->prev;
+    }
+}
+
+static void _cache_push_front(gb_calc_cache_t *cache, int32_t n) {
+    calc_cache_entry_t *entry = &cache->entries[n];
+
+    entry->prev = -1;
+    entry->next = cache->head;
+
+    if (cache->head >= 0) {
+        cache->entries[cache->head].prev = n;
+    } else {
+        cache->tail = n;
+    }
+
+    cache->head = n;
+}
+
+static void _cache_unchain(gb_calc_cache_t *cache, int32_t n) {
+    int32_t *link = &cache->buckets[cache->entries[n].hash & cache->mask];
+
+    while (*link != n) {
+        link = &cache->entries[*link].chain;
+    }
+
+    *link = cache->entries[n].chain;
+}
+
+static int32_t _cache_find(const gb_calc_cache_t *cache, const char *key, size_t len, uint32_t hash) {
+    int32_t n = cache->buckets[hash & cache->mask];
+
+    while (n >= 0) {
+        const calc_cache_entry_t *entry = &cache->entries[n];
+
+        if ((entry->hash == hash) && (entry->len == len) && _name_equals(entry->key, key, len)) {
+            return n;
+        }
+
+        n = entry->chain;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Stores a result, evicting the least recently used entry if full.
+ */
+static void _cache_insert(gb_calc_cache_t *cache, const char *key, size_t len, uint32_t hash, double value) {
+    int32_t n;
+
+    if (cache->count < cache->limit) {
+        n = (int32_t)cache->count++;
+    } else {
+        n = cache->tail;
+        _cache_unlink(cache, n);
+        _cache_unchain(cache, n);
+    }
+
+    calc_cache_entry_t *entry = &cache->entries[n];
+
+    entry->value = value;
+    entry->hash  = hash;
+    entry->len   = (uint8_t)len;
+    gb_memcpy(entry->key, key, len);
+
+    entry->chain                        = cache->buckets[hash & cache->mask];
+    cache->buckets[hash & cache->mask] = n;
+
+    _cache_push_front(cache, n);
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (Library)
+// *****************************************************************************
+// *****************************************************************************
+
+/**
+ * @brief Checks that a program loaded from an image is safe to run.
+ *
+ * The evaluators trust the compiler and perform no checks, so a program that
+ * did not come from gb_calc_compile() is replayed once on a simulated stack:
+ * every opcode must be known, every argument in range, every operator must
+ * find its operands, the stack must stay within `depth` and every code
+ * segment (the program, then each reduction body) must end with its only
+ * OP_RET, leaving exactly one value. A reduction must refer to the header of
+ * a later body and find its bounds and captured values on the stack. An
+ * OP_SKIP must jump to a later reduction of its segment, past exactly the
+ * captured values, and nest within the other pending ones.
+ *
+ * Bodies only refer forward, so each header gets its nesting level (that of
+ * its deepest caller plus one) before it is reached: deeper than
+ * MAX_LOOP_DEPTH, which the compiler never emits, the recursion of the
+ * evaluators could exhaust the stack.
+ *
+ * @param[in]  prog  Program to check.
+ * @param[in]  nvars Number of variables of the library.
+ * @param[out] level Scratch for `prog->code_len` nesting levels.
+ */
+static bool _verify_prog(const gb_calc_prog_t *prog, uint32_t nvars, uint8_t *level) {
+    uint32_t top   = 0; // operands on the simulated stack
+    uint8_t  depth = 0; // nesting level of the current segment
+
+    // Pending OP_SKIP: target reduction and stack height expected there
+    uint32_t skip_pc[MAX_LOOP_DEPTH];
+    uint32_t skip_top[MAX_LOOP_DEPTH];
+    int      skip_len = 0;
+
+    if ((prog->code_len == 0) || (prog->depth > INSN_ARG_MAX) || (prog->regs > INSN_ARG_MAX)) {
+        return false;
+    }
+
+    gb_memset(level, 0, prog->code_len);
+
+    for (uint32_t pc = 0; pc < prog->code_len; ++pc) {
+        const calc_op_t op  = (calc_op_t)INSN_OP(prog->code[pc]);
+        const uint32_t  arg = INSN_ARG(prog->code[pc]);
+
+        switch (op) {
+            case OP_PUSH:
+                if (arg >= prog->pool_len) {
+                    return false;
+                }
+                top++;
+                break;
+
+            case OP_LOAD:
+                if (arg >= nvars) {
+                    return false;
+                }
+                top++;
+                break;
+
+            case OP_REG:
+                if (arg >= prog->regs) {
+                    return false;
+                }
+                top++;
+                break;
+
+            case OP_TEE:
+                if ((arg >= prog->regs) || (top < 1)) {
+                    return false;
+                }
+                break;
+
+            case OP_SEQ:
+                if (top < 2) {
+                    return false;
+                }
+                top--;
+                break;
+
+            case OP_RET:
+                if ((top != 1) || (skip_len > 0)) {
+                    return false;
+                }
+                if (pc == prog->code_len - 1) {
+                    return true;
+                }
+                if (INSN_OP(prog->code[pc + 1]) != OP_LOOP) {
+                    return false;
+                }
+                top = 0; // a reduction body follows
+                break;
+
+            case OP_LOOP:
+                // Register 0 holds the index, 1..arg the captured values
+                if ((pc == 0) || (INSN_OP(prog->code[pc - 1]) != OP_RET) || (arg >= prog->regs)) {
+                    return false;
+                }
+                depth = level[pc];
+                break;
+
+            case OP_SKIP: {
+                if ((top < 2) || (arg == 0) || (arg >= prog->code_len - pc) || (skip_len == MAX_LOOP_DEPTH)) {
+                    return false;
+                }
+
+                const uint32_t target = pc + arg;
+                const uint32_t body   = INSN_ARG(prog->code[target]);
+
+                if (!_is_reduce_opcode((calc_op_t)INSN_OP(prog->code[target])) || (body == 0) ||
+                    (body >= prog->code_len - target) || (INSN_OP(prog->code[target + body]) != OP_LOOP) ||
+                    ((skip_len > 0) && (target >= skip_pc[skip_len - 1]))) {
+                    return false;
+                }
+
+                skip_pc[skip_len]  = target;
+                skip_top[skip_len] = top + INSN_ARG(prog->code[target + body]);
+                skip_len++;
+            } break;
+
+            default:
+                if (_is_unary_opcode(op) && (top >= 1)) {
+                    break;
+                }
+                if (_is_binary_opcode(op) && (top >= 2)) {
+                    top--;
+                    break;
+                }
+                if (_is_reduce_opcode(op) && (arg > 0) && (arg < prog->code_len - pc)) {
+                    const calc_insn_t head = prog->code[pc + arg];
+
+                    if ((skip_len > 0) && (skip_pc[skip_len - 1] == pc)) {
+                        if (top != skip_top[skip_len - 1]) {
+                            return false;
+                        }
+                        skip_len--;
+                    }
+
+                    if (depth >= MAX_LOOP_DEPTH) {
+                        return false;
+                    }
+                    level[pc + arg] = GB_MAX(level[pc + arg], (uint8_t)(depth + 1));
+
+                    if ((INSN_OP(head) == OP_LOOP) && (top >= INSN_ARG(head) + 2)) {
+                        top -= INSN_ARG(head) + 1;
+                        break;
+                    }
+                }
+                return false;
+        }
+
+        if (top > prog->depth) {
+            return false;
+        }
+    }
+
+    return false; // no OP_RET
+}
+
+static inline bool _lib_range_ok(uint64_t off, uint64_t len, uint64_t size) {
+    return (off <= size) && (len <= size - off);
+}
+
+static gb_calc_lib_t *_lib_fail(gb_calc_error_t *err, gb_calc_errno_t code) {
+    _raise_error(err, code, 0, 0);
+    return NULL;
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Functions
+// *****************************************************************************
+// *****************************************************************************
+
+/**
+ * @brief Evaluates a mathematical expression.
+ *
+ * This function evaluates a mathematical expression represented as a string. It
+ * supports arithmetic operators, parentheses, and a set of mathematical
+ * functions.
+ *
+ * @param[in] expr A null-terminated string containing the mathematical
+ *                 expression to be evaluated.
+ *
+ * @return The result of the expression as a double. In case of an error, it
+ *         returns INFINITY and prints an error message to stderr.
+ */
+double gb_calc(const char *expr) {
+    gb_calc_error_t err;
+
+    const double value = gb_calc_ex(expr, &err);
+
+    if (err.code != GB_CALC_OK) {
+        char msg[96];
+
+        gb_calc_format_error(&err, expr, msg, sizeof(msg));
+        fprintf(stderr, "Error: %s\n", msg);
+    }
+
+    return value;
+}
+
+/**
+ * @brief Evaluates a mathematical expression, reporting errors silently.
+ *
+ * The expression is compiled into a scratch program that lives on the stack
+ * and is run once, so no memory is allocated.
+ *
+ * @param[in]  expr A null-terminated string containing the mathematical
+ *                  expression to be evaluated.
+ * @param[out] err  Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The result of the expression, or INFINITY on error.
+ */
+double gb_calc_ex(const char *expr, gb_calc_error_t *err) {
+    gb_calc_error_t dummy;
+    calc_context_t  ctx;
+
+    if (!err) {
+        err = &dummy;
+    }
+
+    if (!_compile_expr(&ctx, expr, expr ? gb_strlen(expr) : 0, NULL, false, err)) {
+        return INFINITY;
+    }
+
+    const gb_calc_prog_t prog = {
+        .code     = ctx.code,
+        .pool     = ctx.pool,
+        .vars     = NULL,
+        .code_len = (uint32_t)ctx.code_len,
+        .pool_len = (uint32_t)ctx.pool_len,
+        .depth    = (uint32_t)(ctx.num_max + 1),
+        .regs     = (uint32_t)ctx.reg_len,
+    };
+
+    double  local[EVAL_LOCAL_SLOTS];
+    double *slots = local;
+
+    if (prog.depth + prog.regs > EVAL_LOCAL_SLOTS) {
+        // Depth and registers are both bounded by the node count, and the
+        // nodes are no longer needed once the code is emitted
+        slots = (double *)(void *)ctx.nodes;
+    }
+
+    // The compiler arrays stay held while the program runs, so reductions
+    // take their rows above them
+    const size_t held = _compile_scratch((size_t)ctx.cap);
+
+    if (!_scratch_push(held)) {
+        return _raise_error(err, GB_CALC_E_NO_MEMORY, 0, 0);
+    }
+
+    const double value = _run_prog(&prog, slots, err);
+
+    _scratch_pop(held);
+    return value;
+}
+
+/**
+ * @brief Compiles a mathematical expression into a reusable program.
+ *
+ * The program header, bytecode and constant pool are packed into a single
+ * aligned allocation: [header][code][pool].
+ *
+ * Variables are resolved against `syms` once, here; the program keeps reading
+ * their current values from the table, so the caller may update them in place
+ * between evaluations. The table must outlive the program.
+ *
+ * @param[in]  expr A null-terminated string containing the mathematical
+ *                  expression to be compiled.
+ * @param[in]  syms Symbol table resolving variable names, or NULL.
+ * @param[out] err  Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The compiled program, or NULL on error. Release it with
+ *         gb_calc_free().
+ */
+gb_calc_prog_t *gb_calc_compile(const char *expr, gb_calc_syms_t *syms, gb_calc_error_t *err) {
+    return gb_calc_compile_n(expr, expr ? gb_strlen(expr) : 0, syms, err);
+}
+
+/**
+ * @brief Compiles the first `len` characters of a buffer into a program.
+ *
+ * The parser reads the buffer in place and never past `len`, so an
+ * expression can be compiled straight out of a larger line or file image.
+ *
+ * @param[in]  expr Expression text (need not be null-terminated).
+ * @param[in]  len  Length of the expression.
+ * @param[in]  syms Symbol table resolving variable names, or NULL.
+ * @param[out] err  Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The compiled program, or NULL on error. Release it with
+ *         gb_calc_free().
+ */
+gb_calc_prog_t *gb_calc_compile_n(const char *expr, size_t len, gb_calc_syms_t *syms, gb_calc_error_t *err) {
+    gb_calc_error_t dummy;
+    calc_context_t  ctx;
+
+    if (!err) {
+        err = &dummy;
+    }
+
+    if (!_compile_expr(&ctx, expr, len, syms, false, err)) {
+        return NULL;
+    }
+
+    const size_t pool_off = sizeof(gb_calc_prog_t) + (size_t)ctx.code_len * sizeof(calc_insn_t);
+    const size_t pool_pad = (sizeof(double) - (pool_off % sizeof(double))) % sizeof(double);
+    const size_t size     = pool_off + pool_pad + (size_t)ctx.pool_len * sizeof(double);
+
+    unsigned char *raw = gb_malloc(size, sizeof(double));
+
+    if (!raw) {
+        err->code = GB_CALC_E_NO_MEMORY;
+        return NULL;
+    }
+
+    gb_calc_prog_t *prog = (gb_calc_prog_t *)raw;
+    calc_insn_t    *code = (calc_insn_t *)(raw + sizeof(gb_calc_prog_t));
+    double         *pool = (double *)(raw + pool_off + pool_pad);
+
+    gb_memcpy(code, ctx.code, (size_t)ctx.code_len * sizeof(calc_insn_t));
+    gb_memcpy(pool, ctx.pool, (size_t)ctx.pool_len * sizeof(double));
+
+    prog->code     = code;
+    prog->pool     = pool;
+    prog->vars     = syms ? syms->values : NULL;
+    prog->code_len = (uint32_t)ctx.code_len;
+    prog->pool_len = (uint32_t)ctx.pool_len;
+    prog->depth    = (uint32_t)(ctx.num_max + 1);
+    prog->regs     = (uint32_t)ctx.reg_len;
+
+    return prog;
+}
+
+/**
+ * @brief Evaluates a compiled program.
+ *
+ * @param[in]  prog Program returned by gb_calc_compile().
+ * @param[out] err  Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The result of the program as a double, or INFINITY on error.
+ */
+double gb_calc_eval(const gb_calc_prog_t *prog, gb_calc_error_t *err) {
+    gb_calc_error_t dummy;
+
+    if (!err) {
+        err = &dummy;
+    }
+
+    err->code = GB_CALC_OK;
+    err->pos  = 0;
+    err->row  = 0;
+
+    if (!prog) {
+        return _raise_error(err, GB_CALC_E_BAD_PROG, 0, 0);
+    }
+
+    double  local[EVAL_LOCAL_SLOTS];
+    double *slots = local;
+
+    const size_t size = (prog->depth + prog->regs) * sizeof(double);
+
+    if (prog->depth + prog->regs > EVAL_LOCAL_SLOTS) {
+        slots = _scratch_push(size);
+
+        if (!slots) {
+            return _raise_error(err, GB_CALC_E_NO_MEMORY, 0, 0);
+        }
+    }
+
+    const double value = _run_prog(prog, slots, err);
+
+    if (slots != local) {
+        _scratch_pop(size);
+    }
+
+    return value;
+}
+
+/**
+ * @brief Evaluates a compiled program over arrays of inputs.
+ *
+ * The inputs are processed GB_CALC_BLOCK elements at a time: each instruction
+ * is dispatched once per block and applied to every element of the block.
+ * A failing element does not stop the batch: its result is INFINITY and only
+ * the first failure is reported.
+ *
+ * @param[in]  prog Program returned by gb_calc_compile().
+ * @param[in]  cols Input columns indexed by symbol ordinal (see
+ *                  gb_calc_sym_index()); each holds `n` values. A NULL entry,
+ *                  or a NULL `cols`, uses the scalar value in the table.
+ * @param[out] out  Destination for the `n` results.
+ * @param[in]  n    Number of elements.
+ * @param[out] err  Report of the first error, or NULL.
+ */
+void gb_calc_eval_batch(const gb_calc_prog_t *prog, //
+                        const double *const  *cols, //
+                        double               *out,  //
+                        size_t                n,    //
+                        gb_calc_error_t      *err) {
+    gb_calc_error_t dummy;
+
+    if (!err) {
+        err = &dummy;
+    }
+
+    err->code = GB_CALC_OK;
+    err->pos  = 0;
+    err->row  = 0;
+
+    if (!prog || !out) {
+        _raise_error(err, GB_CALC_E_BAD_PROG, 0, 0);
+        return;
+    }
+
+    // Operand rows first, then one row per temporary
+    double local[BATCH_LOCAL_ROWS][GB_CALC_BLOCK];
+    double (*rows)[GB_CALC_BLOCK] = local;
+
+    const size_t size = (prog->depth + prog->regs) * sizeof(local[0]);
+
+    if (prog->depth + prog->regs > BATCH_LOCAL_ROWS) {
+        rows = _scratch_push(size);
+
+        if (!rows) {
+            _raise_error(err, GB_CALC_E_NO_MEMORY, 0, 0);
+            return;
+        }
+    }
+
+    for (size_t base = 0; base < n; base += GB_CALC_BLOCK) {
+        const size_t m = GB_MIN(n - base, (size_t)GB_CALC_BLOCK);
+
+        _run_block(prog, cols, base, m, rows, rows + prog->depth, out + base, err);
+    }
+
+    if (rows != local) {
+        _scratch_pop(size);
+    }
+}
+
+/**
+ * @brief Evaluates a compiled program and its gradient in one pass.
+ *
+ * The program runs once on dual numbers: each slot carries its value and one
+ * tangent per requested variable, so the cost grows with `n` but there is no
+ * re-evaluation per derivative.
+ *
+ * @param[in]  prog Program returned by gb_calc_compile().
+ * @param[in]  wrt  Ordinals of the variables (see gb_calc_sym_index()).
+ * @param[in]  n    Number of variables.
+ * @param[out] grad Destination for the `n` derivatives (INFINITY on error).
+ * @param[out] err  Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The result of the program as a double, or INFINITY on error.
+ */
+double gb_calc_eval_grad(const gb_calc_prog_t *prog, //
+                         const int            *wrt,  //
+                         size_t                n,    //
+                         double               *grad, //
+                         gb_calc_error_t      *err) {
+    gb_calc_error_t dummy;
+
+    if (!err) {
+        err = &dummy;
+    }
+
+    err->code = GB_CALC_OK;
+    err->pos  = 0;
+    err->row  = 0;
+
+    if (!prog || ((n > 0) && (!wrt || !grad))) {
+        return _raise_error(err, GB_CALC_E_BAD_PROG, 0, 0);
+    }
+
+    const size_t count = (prog->depth + prog->regs) * (n + 1);
+
+    double  local[EVAL_LOCAL_SLOTS];
+    double *slots = local;
+
+    if (count > EVAL_LOCAL_SLOTS) {
+        slots = _scratch_push(count * sizeof(double));
+
+        if (!slots) {
+            _raise_error(err, GB_CALC_E_NO_MEMORY, 0, 0);
+        }
+    }
+
+    const double value = slots ? _run_dual(prog, wrt, n, slots, grad, err) : INFINITY;
+
+    if (slots && (slots != local)) {
+        _scratch_pop(count * sizeof(double));
+    }
+
+    if (err->code != GB_CALC_OK) {
+        for (size_t k = 0; k < n; ++k) {
+            grad[k] = INFINITY;
+        }
+    }
+
+    return value;
+}
+
+/**
+ * @brief Returns the description of an error code.
+ *
+ * @param[in] code Error code.
+ *
+ * @return Static, null-terminated description (never NULL).
+ */
+const char *gb_calc_strerror(gb_calc_errno_t code) {
+    // clang-format off
+    static const char *const messages[GB_CALC_E_COUNT] = {
+        [GB_CALC_OK]           = "No error",
+        [GB_CALC_E_NULL_EXPR]  = "Null expression",
+        [GB_CALC_E_EMPTY_EXPR] = "Empty expression",
+        [GB_CALC_E_LIMIT]      = "Expression too long or too complex",
+        [GB_CALC_E_SYNTAX]     = "Invalid expression",
+        [GB_CALC_E_OPERAND]    = "Operator without operand(s)",
+        [GB_CALC_E_PARENS]     = "Mismatched parentheses",
+        [GB_CALC_E_IDENT]      = "Unknown identifier",
+        [GB_CALC_E_NO_MEMORY]  = "Out of memory",
+        [GB_CALC_E_DIV_ZERO]   = "Division by zero",
+        [GB_CALC_E_MOD_ZERO]   = "Modulo by zero",
+        [GB_CALC_E_SQRT]       = "Square root of negative number",
+        [GB_CALC_E_LOG]        = "Logarithm of non-positive number",
+        [GB_CALC_E_BAD_PROG]   = "Invalid program",
+        [GB_CALC_E_RANGE]      = "Value out of range",
+        [GB_CALC_E_IO]         = "Cannot access file",
+        [GB_CALC_E_ARGS]       = "Wrong number of arguments",
+    };
+    // clang-format on
+
+    if (((unsigned)code >= GB_CALC_E_COUNT) || !messages[code]) {
+        return "Unknown error";
+    }
+
+    return messages[code];
+}
+
+/**
+ * @brief Formats an error report into a message.
+ *
+ * @param[in]  err  Error report.
+ * @param[in]  expr Source expression the report refers to, or NULL.
+ * @param[out] buf  Destination buffer.
+ * @param[in]  len  Size of the destination buffer.
+ *
+ * @return The length of the full message (as snprintf()).
+ */
+int gb_calc_format_error(const gb_calc_error_t *err, const char *expr, char *buf, size_t len) {
+    return gb_calc_format_error_n(err, expr, expr ? gb_strlen(expr) : 0, buf, len);
+}
+
+/**
+ * @brief Formats an error report into a message.
+ *
+ * Same as gb_calc_format_error(), for an expression given as pointer and
+ * length (see gb_calc_compile_n()): the quoted identifier never reads past
+ * `expr_len` characters.
+ *
+ * @param[in]  err      Error report.
+ * @param[in]  expr     Source expression the report refers to, or NULL.
+ * @param[in]  expr_len Length of the expression in characters.
+ * @param[out] buf      Destination buffer.
+ * @param[in]  len      Size of the destination buffer.
+ *
+ * @return The length of the full message (as snprintf()).
+ */
+int gb_calc_format_error_n(const gb_calc_error_t *err, const char *expr, size_t expr_len, char *buf, size_t len) {
+    if (!err) {
+        return snprintf(buf, len, "Unknown error");
+    }
+
+    const char *what = gb_calc_strerror(err->code);
+
+    if (err->code == GB_CALC_OK) {
+        return snprintf(buf, len, "%s", what);
+    }
+
+    if ((err->code == GB_CALC_E_IDENT) && expr && (err->pos < expr_len)) {
+        const char  *cp   = expr + err->pos;
+        const size_t tail = expr_len - err->pos;
+
+        int n = 0;
+        while (((size_t)n < tail) && _is_ident_tail(cp[n]) && (n < GB_CALC_NAME_MAX)) {
+            n++;
+        }
+
+        return snprintf(buf, len, "%s '%.*s' at offset %zu", what, n, cp, err->pos);
+    }
+
+    return snprintf(buf, len, "%s at offset %zu", what, err->pos);
+}
+
+/**
+ * @brief Selects the scratch memory of the calling thread.
+ *
+ * With a buffer, that memory is used as is (aligned to a double boundary)
+ * and never reallocated. Without one, any buffer owned by the library is
+ * released and a new one will be grown on demand.
+ *
+ * @param[in] buf  Caller-supplied buffer, or NULL for library-owned memory.
+ * @param[in] size Size of the buffer in bytes.
+ */
+void gb_calc_scratch(void *buf, size_t size) {
+    calc_scratch_t *scratch = &calc_scratch;
+
+    if (!scratch->borrowed) {
+        gb_free(scratch->base);
+    }
+
+    scratch->base     = NULL;
+    scratch->size     = 0;
+    scratch->borrowed = (buf != NULL);
+
+    if (buf) {
+        const size_t skew = (sizeof(double) - ((uintptr_t)buf % sizeof(double))) % sizeof(double);
+
+        if (size > skew) {
+            scratch->base = (unsigned char *)buf + skew;
+            scratch->size = size - skew;
+        }
+    }
+}
+
+/**
+ * @brief Returns the scratch size needed by an expression.
+ *
+ * @param[in] expr_len Length of the source expression.
+ *
+ * @return Bytes of scratch needed to compile (and run once) an expression of
+ *         that length, plus the worst-case alignment loss.
+ */
+size_t gb_calc_scratch_size(size_t expr_len) {
+    return _compile_scratch(expr_len + 1) + sizeof(double);
+}
+
+/**
+ * @brief Selects the precision of the elementary functions.
+ *
+ * @param[in] enable Nonzero for the tables of gb_fmath, zero for libm.
+ */
+void gb_calc_fast_math(int enable) {
+    // The tables are filled before the first evaluation can read them
+    if (enable) {
+        gb_fmath_init();
+    }
+
+    atomic_store(&calc_fast_math, enable != 0);
+}
+
+/**
+ * @brief Returns nonzero when fast-math mode is on.
+ */
+int gb_calc_fast_math_enabled(void) {
+    return _fast_math();
+}
+
+/**
+ * @brief Creates a result cache for variable-free expressions.
+ *
+ * Header, bucket index and entries are packed into a single aligned
+ * allocation of at most `max_bytes`; the number of entries follows from it.
+ *
+ * @param[in] max_bytes Memory budget of the cache.
+ *
+ * @return The cache, or NULL if the budget cannot hold a single entry or the
+ *         allocation fails. Release it with gb_calc_cache_free().
+ */
+gb_calc_cache_t *gb_calc_cache_new(size_t max_bytes) {
+    const size_t header = _align_up(sizeof(gb_calc_cache_t));
+
+    // Every entry costs at most two bucket slots (load factor >= 50%)
+    const size_t per_entry = sizeof(calc_cache_entry_t) + (2 * sizeof(int32_t));
+
+    if (max_bytes < header + per_entry) {
+        return NULL;
+    }
+
+    const size_t limit = GB_MIN((max_bytes - header) / per_entry, (size_t)1 << 24);
+
+    uint32_t slots = 1;
+    while (slots < limit) {
+        slots <<= 1;
+    }
+
+    const size_t entries_off = header;
+    const size_t buckets_off = entries_off + (limit * sizeof(calc_cache_entry_t));
+    const size_t size        = buckets_off + (slots * sizeof(int32_t));
+
+    unsigned char *raw = gb_malloc(size, sizeof(double));
+
+    if (!raw) {
+        return NULL;
+    }
+
+    gb_calc_cache_t *cache = (gb_calc_cache_t *)raw;
+
+    cache->mask    = slots - 1;
+    cache->limit   = (uint32_t)limit;
+    cache->entries = (calc_cache_entry_t *)(raw + entries_off);
+    cache->buckets = (int32_t *)(raw + buckets_off);
+    cache->bytes   = size;
+
+    gb_calc_cache_clear(cache);
+
+    return cache;
+}
+
+/**
+ * @brief Releases a result cache.
+ *
+ * @param[in] cache Cache returned by gb_calc_cache_new(), or NULL (no-op).
+ */
+void gb_calc_cache_free(gb_calc_cache_t *cache) {
+    gb_free(cache);
+}
+
+/**
+ * @brief Drops every cached result and resets the counters.
+ *
+ * @param[in] cache Result cache.
+ */
+void gb_calc_cache_clear(gb_calc_cache_t *cache) {
+    if (!cache) {
+        return;
+    }
+
+    cache->count  = 0;
+    cache->head   = -1;
+    cache->tail   = -1;
+    cache->hits   = 0;
+    cache->misses = 0;
+
+    for (uint32_t i = 0; i <= cache->mask; ++i) {
+        cache->buckets[i] = -1;
+    }
+}
+
+/**
+ * @brief Evaluates an expression through a result cache.
+ *
+ * A hit costs one pass over the text (whitespace folding and hashing) plus a
+ * key comparison. On a miss the expression is evaluated with gb_calc_ex() and
+ * the result is stored, unless an error occurred.
+ *
+ * @param[in]  cache Result cache, or NULL (plain gb_calc_ex()).
+ * @param[in]  expr  A null-terminated string containing the mathematical
+ *                   expression to be evaluated.
+ * @param[out] err   Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The result of the expression, or INFINITY on error.
+ */
+double gb_calc_cached(gb_calc_cache_t *cache, const char *expr, gb_calc_error_t *err) {
+    // The cache holds libm results only
+    if (!cache || !expr || _fast_math()) {
+        return gb_calc_ex(expr, err);
+    }
+
+    char     key[CACHE_KEY_MAX];
+    uint32_t hash = 0;
+
+    const size_t len = _cache_key(expr, key, &hash);
+
+    if (len > 0) {
+        const int32_t n = _cache_find(cache, key, len, hash);
+
+        if (n >= 0) {
+            cache->hits++;
+
+            if (n != cache->head) {
+                _cache_unlink(cache, n);
+                _cache_push_front(cache, n);
+            }
+
+            if (err) {
+                err->code = GB_CALC_OK;
+                err->pos  = 0;
+                err->row  = 0;
+            }
+
+            return cache->entries[n].value;
+        }
+    }
+
+    cache->misses++;
+
+    gb_calc_error_t local;
+
+    if (!err) {
+        err = &local;
+    }
+
+    const double value = gb_calc_ex(expr, err);
+
+    if ((len > 0) && (err->code == GB_CALC_OK)) {
+        _cache_insert(cache, key, len, hash, value);
+    }
+
+    return value;
+}
+
+/**
+ * @brief Reads the counters of a result cache.
+ *
+ * @param[in]  cache Result cache.
+ * @param[out] stats Destination for the counters.
+ */
+void gb_calc_cache_stats(const gb_calc_cache_t *cache, gb_calc_cache_stats_t *stats) {
+    if (!cache || !stats) {
+        return;
+    }
+
+    stats->hits     = cache->hits;
+    stats->misses   = cache->misses;
+    stats->entries  = cache->count;
+    stats->capacity = cache->limit;
+    stats->bytes    = cache->bytes;
+}
+
+/**
+ * @brief Releases a compiled program.
+ *
+ * @param[in] prog Program returned by gb_calc_compile(), or NULL (no-op).
+ */
+void gb_calc_free(gb_calc_prog_t *prog) {
+    gb_free(prog);
+}
+
+/**
+ * @brief Creates an empty symbol table.
+ *
+ * Index, names and values are packed into a single aligned allocation. The
+ * capacity is fixed, so the address of every value stays valid for the whole
+ * life of the table.
+ *
+ * @param[in] max_syms Maximum number of symbols the table can hold.
+ *
+ * @return The symbol table, or NULL on failure. Release it with
+ *         gb_calc_syms_free().
+ */
+gb_calc_syms_t *gb_calc_syms_new(size_t max_syms) {
+    if (!max_syms || (max_syms > 0x10000U)) {
+        return NULL;
+    }
+
+    // Keep the load factor at or below 50%
+    uint32_t slots = 2;
+    while (slots < 2 * max_syms) {
+        slots <<= 1;
+    }
 
-            case 'c': { // cos
-                ctx->num_lifo[++ctx->num_top] = cos(num);
-                ctx->op__top--;
-                result = true;
-            } break;
+    const size_t values_off  = sizeof(gb_calc_syms_t);
+    const size_t entries_off = values_off + max_syms * sizeof(double);
+    const size_t index_off   = entries_off + max_syms * sizeof(calc_sym_t);
+    const size_t size        = index_off + slots * sizeof(int32_t);
 
-            case 'C': { // acos
-                ctx->num_lifo[++ctx->num_top] = acos(num);
-                ctx->op__top--;
-                result = true;
-            } break;
+    unsigned char *raw = gb_malloc(size, sizeof(double));
 
-            case 't': { // tan
-                ctx->num_lifo[++ctx->num_top] = tan(num);
-                ctx->op__top--;
-                result = true;
-            } break;
+    if (!raw) {
+        return NULL;
+    }
 
-            case 'T': { // atan
-                ctx->num_lifo[++ctx->num_top] = atan(num);
-                ctx->op__top--;
-                result = true;
-            } break;
+    gb_calc_syms_t *syms = (gb_calc_syms_t *)raw;
 
-            case 'q': { // sqrt
-                if (num < 0) {
-                    fprintf(stderr, "Error: Square root of negative number\n");
-                    ctx->num_lifo[++ctx->num_top] = INFINITY;
-                } else {
-                    ctx->num_lifo[++ctx->num_top] = sqrt(num);
-                }
-                ctx->op__top--;
-                result = true;
-            } break;
+    syms->mask    = slots - 1;
+    syms->count   = 0;
+    syms->limit   = (uint32_t)max_syms;
+    syms->values  = (double *)(raw + values_off);
+    syms->entries = (calc_sym_t *)(raw + entries_off);
+    syms->index   = (int32_t *)(raw + index_off);
+    syms->funcs   = NULL;
 
-            case 'e': { // exp
-                ctx->num_lifo[++ctx->num_top] = exp(num);
-                ctx->op__top--;
-                result = true;
-            } break;
+    for (uint32_t i = 0; i < slots; ++i) {
+        syms->index[i] = -1;
+    }
 
-            case 'l': { // e-base log
-                if (num <= 0) {
-                    fprintf(stderr, "Error: Logarithm of non-positive number\n");
-                    ctx->num_lifo[++ctx->num_top] = INFINITY;
-                } else {
-                    ctx->num_lifo[++ctx->num_top] = log(num);
-                }
-                ctx->op__top--;
-                result = true;
-            } break;
+    return syms;
+}
 
-            case 'L': { // 2-base log
-                if (num <= 0) {
-                    fprintf(stderr, "Error: Logarithm of non-positive number\n");
-                    ctx->num_lifo[++ctx->num_top] = INFINITY;
-                } else {
-                    ctx->num_lifo[++ctx->num_top] = log2(num);
-                }
-                ctx->op__top--;
-                result = true;
-            } break;
+/**
+ * @brief Releases a symbol table.
+ *
+ * @param[in] syms Table returned by gb_calc_syms_new(), or NULL (no-op).
+ */
+void gb_calc_syms_free(gb_calc_syms_t *syms) {
+    if (syms) {
+        while (syms->funcs) {
+            calc_func_t *next = syms->funcs->next;
 
-            default: {
-                // Not a unary function
-            }
+            gb_free(syms->funcs);
+            syms->funcs = next;
         }
     }
-
-    return result;
+    gb_free(syms);
 }
 
-static bool _is_binary_op(char op) {
-    switch (op) {
-        case '+':
-        case '-':
-        case '*':
-        case '/':
-        case '%':
-        case '^':
-            return true;
+/**
+ * @brief Defines a variable or updates its value.
+ *
+ * @param[in] syms  Symbol table.
+ * @param[in] name  Identifier ([A-Za-z_][A-Za-z0-9_]*, at most
+ *                  GB_CALC_NAME_MAX characters) that is not a built-in
+ *                  function or constant.
+ * @param[in] value Value to store.
+ *
+ * @return Stable pointer to the variable value, or NULL if the name is
+ *         invalid or the table is full.
+ */
+double *gb_calc_sym_bind(gb_calc_syms_t *syms, const char *name, double value) {
+    if (!syms || !name || !_is_ident_head(*name)) {
+        return NULL;
+    }
 
-        default:
-            return false;
+    size_t len = 1;
+    while (_is_ident_tail(name[len])) {
+        len++;
     }
-}
 
-static double _apply_binary_op(double a, double b, char op) {
-    switch (op) {
-        case '+':
-            return (a + b);
+    if ((name[len] != '\0') || (len > GB_CALC_NAME_MAX)) {
+        return NULL;
+    }
 
-        case '-':
-            return (a - b);
+    if (_find_keyword(name, len)) {
+        return NULL;
+    }
 
-        case '*':
-            return (a * b);
+    const uint32_t hash = _hash_name(name, len);
+    const uint32_t slot = _syms_slot(syms, name, len, hash);
 
-        case '/':
-            if (b == 0) {
-                fprintf(stderr, "Error: Division by zero\n");
-                return INFINITY;
-            }
-            return (a / b);
+    int32_t ord = syms->index[slot];
 
-        case '%':
-            if (b == 0) {
-                fprintf(stderr, "Error: Modulo by zero\n");
-                return INFINITY;
-            }
-            return fmod(a, b);
+    if (ord < 0) {
+        if (syms->count >= syms->limit) {
+            return NULL;
+        }
 
-        case '^':
-            return pow(a, b);
+        ord = (int32_t)syms->count++;
 
-        default:
-            fprintf(stderr, "Error: Unknown operator '%c'\n", op);
-            return INFINITY;
+        calc_sym_t *sym = &syms->entries[ord];
+
+        sym->hash = hash;
+        sym->len  = (uint32_t)len;
+        gb_memcpy(sym->name, name, len + 1);
+
+        syms->index[slot] = ord;
     }
+
+    syms->values[ord] = value;
+
+    return &syms->values[ord];
 }
 
-static bool _apply_operator(calc_context_t *ctx) {
-    if (ctx->num_top < 0) {
-        fprintf(stderr, "Error: Operator without operand(s)\n");
-        return false;
+/**
+ * @brief Returns the ordinal of a variable.
+ *
+ * Ordinals are assigned in definition order, starting at 0, and index the
+ * input columns of gb_calc_eval_batch().
+ *
+ * @param[in] syms Symbol table.
+ * @param[in] name Null-terminated variable name.
+ *
+ * @return The ordinal, or -1 if the variable is not defined.
+ */
+int gb_calc_sym_index(const gb_calc_syms_t *syms, const char *name) {
+    if (!name) {
+        return -1;
     }
 
-    double b = ctx->num_lifo[ctx->num_top--];
+    return (int)_syms_lookup(syms, name, gb_strlen(name));
+}
 
-    if (_apply_unary_op(ctx, b)) {
-        return true;
+/**
+ * @brief Looks up a variable.
+ *
+ * @param[in] syms Symbol table.
+ * @param[in] name Null-terminated variable name.
+ *
+ * @return Stable pointer to the variable value, or NULL if it is not defined.
+ */
+double *gb_calc_sym_find(gb_calc_syms_t *syms, const char *name) {
+    if (!name) {
+        return NULL;
     }
 
-    if (_apply_unary_func(ctx, b)) {
-        return true;
-    }
+    const int32_t ord = _syms_lookup(syms, name, gb_strlen(name));
 
-    if (ctx->num_top < 0) {
-        fprintf(stderr, "Error: Operator without operand(s)\n");
-        return false;
+    return (ord >= 0) ? &syms->values[ord] : NULL;
+}
+
+/**
+ * @brief Defines user functions, `name(p1, p2, ...) = expression`.
+ *
+ * The definitions are separated by ';' and parsed once; every program
+ * compiled against `syms` afterwards can call them. A call copies the
+ * compiled body into the calling program, so redefining a function only
+ * affects the programs (and functions) compiled after it.
+ *
+ * @param[in]  syms Symbol table.
+ * @param[in]  defs Null-terminated function definitions.
+ * @param[out] err  Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The number of functions defined, or -1 on error (no function is
+ *         defined).
+ */
+int gb_calc_func_def(gb_calc_syms_t *syms, const char *defs, gb_calc_error_t *err) {
+    gb_calc_error_t dummy;
+    calc_context_t  ctx;
+
+    if (!err) {
+        err = &dummy;
     }
 
-    double a  = ctx->num_lifo[ctx->num_top--];
-    char   op = ctx->op__lifo[ctx->op__top--]; // NOSONAR (negative offset)
+    if (!syms) {
+        err->code = GB_CALC_E_NULL_EXPR;
+        err->pos  = 0;
+        err->row  = 0;
+        return -1;
+    }
 
-    if (ctx->num_top >= MAX_LIFO_DEPTH - 1) {
-        fprintf(stderr, "Error: Stack overflow\n");
-        return false;
+    if (!_compile_expr(&ctx, defs, defs ? gb_strlen(defs) : 0, syms, true, err)) {
+        return -1;
     }
-    ctx->num_lifo[++ctx->num_top] = _apply_binary_op(a, b, op);
 
-    return true;
-}
+    // One block per function: header, code, constants and name
+    calc_func_t  *list = NULL;
+    calc_func_t **tail = &list;
 
-static bool _process_operators(calc_context_t *ctx) {
-    while (ctx->op__top >= 0) {
-        if (ctx->op__lifo[ctx->op__top] == '(') {
-            fprintf(stderr, "Error: Mismatched parentheses\n");
-            return false;
-        }
+    for (int k = 0; k < ctx.func_len; ++k) {
+        const calc_func_t *func = &ctx.funcs[k];
 
-        if (!_apply_operator(ctx)) {
-            return false;
-        }
-    }
+        const size_t code_off = _align_up(sizeof(calc_func_t));
+        const size_t pool_off = _align_up(code_off + func->code_len * sizeof(calc_insn_t));
+        const size_t name_off = pool_off + func->pool_len * sizeof(double);
 
-    return true;
-}
+        unsigned char *raw = gb_malloc(name_off + func->name_len, sizeof(double));
 
-static int _get_precedence(char op) {
-    // Precedence for 2-operand operators
-    switch (op) {
-        case '^':
-            return 4;
+        if (!raw) {
+            while (list) {
+                calc_func_t *next = list->next;
 
-        case '*':
-        case '/':
-        case '%':
-            return 3;
+                gb_free(list);
+                list = next;
+            }
+            err->code = GB_CALC_E_NO_MEMORY;
+            return -1;
+        }
 
-        case '+':
-        case '-':
-            return 2;
+        calc_func_t *copy = (calc_func_t *)raw;
+        calc_insn_t *code = (calc_insn_t *)(raw + code_off);
+        double      *pool = (double *)(raw + pool_off);
 
-        default:
-            return 0;
-    }
-}
+        gb_memcpy(code, func->code, func->code_len * sizeof(calc_insn_t));
+        gb_memcpy(pool, func->pool, func->pool_len * sizeof(double));
+        gb_memcpy(raw + name_off, func->name, func->name_len);
 
-static bool _process_binary(calc_context_t *ctx) {
-    const char *cp = &ctx->expr[ctx->i];
-    const char  ch = *cp;
+        *copy      = *func;
+        copy->code = code;
+        copy->pool = pool;
+        copy->name = (const char *)(raw + name_off);
+        copy->next = NULL;
 
-    if (!_is_binary_op(ch)) {
-        return false;
+        *tail = copy;
+        tail  = &copy->next;
     }
 
-    while (ctx->op__top >= 0) {
-        const int top_prec = _get_precedence(ctx->op__lifo[ctx->op__top]);
-        const int cur_prec = _get_precedence(ch);
+    // Prepend in definition order, replacing the functions of the same name
+    while (list) {
+        calc_func_t *func = list;
 
-        if (cur_prec > top_prec) {
-            break; // Current operator has higher precedence
-        }
+        list = list->next;
 
-        double b  = ctx->num_lifo[ctx->num_top--]; // NOSONAR (negative offset)
-        double a  = ctx->num_lifo[ctx->num_top--];
-        char   op = ctx->op__lifo[ctx->op__top--];
+        for (calc_func_t **link = &syms->funcs; *link; link = &(*link)->next) {
+            if (((*link)->name_len == func->name_len) && _name_equals((*link)->name, func->name, func->name_len)) {
+                calc_func_t *old = *link;
 
-        if (ctx->num_top >= MAX_LIFO_DEPTH - 1) {
-            return false;
+                *link = old->next;
+                gb_free(old);
+                break;
+            }
         }
-        ctx->num_lifo[++ctx->num_top] = _apply_binary_op(a, b, op);
-    }
 
-    if (ctx->op__top >= MAX_LIFO_DEPTH - 1) {
-        return false;
+        func->next  = syms->funcs;
+        syms->funcs = func;
     }
-    ctx->op__lifo[++ctx->op__top] = ch;
-    ctx->i++;
 
-    return true;
+    return ctx.func_len;
 }
 
-static bool _process_close_paren(calc_context_t *ctx) {
-    const char *cp = &ctx->expr[ctx->i];
-    const char  ch = *cp;
+/**
+ * @brief Serializes compiled programs into a library image.
+ *
+ * The image holds, for every program, its bytecode, constant pool, stack
+ * depth and register count, plus the names of the variables in ordinal
+ * order. Call it once with a NULL buffer to learn the size.
+ *
+ * @param[in]  progs Programs to store, all compiled against `syms` (or
+ *                   without variables).
+ * @param[in]  count Number of programs.
+ * @param[in]  syms  Symbol table the programs were compiled against, or NULL.
+ * @param[out] buf   Destination buffer, or NULL.
+ * @param[in]  len   Size of the destination buffer.
+ * @param[out] err   Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The size of the image (the image is only written if it fits `len`),
+ *         or 0 on error.
+ */
+size_t gb_calc_lib_write(const gb_calc_prog_t *const *progs, //
+                         size_t                       count, //
+                         const gb_calc_syms_t        *syms,  //
+                         void                        *buf,   //
+                         size_t                       len,   //
+                         gb_calc_error_t             *err) {
+    gb_calc_error_t dummy;
 
-    if (ch != ')') {
-        return false;
+    if (!err) {
+        err = &dummy;
     }
 
-    while ((ctx->op__top >= 0) && (ctx->op__lifo[ctx->op__top] != '(')) {
-        if (!_apply_operator(ctx)) {
-            return false;
-        }
+    err->code = GB_CALC_OK;
+    err->pos  = 0;
+    err->row  = 0;
+
+    if (!progs || (count == 0)) {
+        _raise_error(err, GB_CALC_E_BAD_PROG, 0, 0);
+        return 0;
     }
 
-    if ((ctx->op__top >= 0) && (ctx->op__lifo[ctx->op__top] == '(')) {
-        ctx->op__top--; // Pop the '('
+    const uint32_t nsyms      = syms ? syms->count : 0;
+    size_t         code_words = 0;
+    size_t         pool_words = 0;
 
-        double num = ctx->num_lifo[ctx->num_top--]; // NOSONAR (negative offset)
+    for (size_t i = 0; i < count; ++i) {
+        const gb_calc_prog_t *prog = progs[i];
 
-        if (!_apply_unary_op(ctx, num) && !_apply_unary_func(ctx, num)) {
-            ctx->num_top++;
+        // Ordinals only make sense against the table the names come from
+        if (!prog || (prog->vars && (!syms || (prog->vars != syms->values)))) {
+            _raise_error(err, GB_CALC_E_BAD_PROG, 0, i);
+            return 0;
         }
-    } else {
-        fprintf(stderr, "Error: Mismatched parentheses\n");
-        return false;
-    }
 
-    ctx->i++;
-    return true;
-}
+        code_words += prog->code_len;
+        pool_words += prog->pool_len;
+    }
 
-static bool _process_open_paren(calc_context_t *ctx) {
-    const char *cp = &ctx->expr[ctx->i];
-    const char  ch = *cp;
+    const size_t names_off   = sizeof(calc_lib_header_t);
+    const size_t entries_off = names_off + (nsyms * sizeof(calc_lib_name_t));
+    const size_t pools_off   = _align_up(entries_off + (count * sizeof(calc_lib_entry_t)));
+    const size_t code_off    = pools_off + (pool_words * sizeof(double));
+    const size_t size        = code_off + (code_words * sizeof(calc_insn_t));
 
-    if (ch != '(') {
-        return false;
+    if (size > UINT32_MAX) {
+        _raise_error(err, GB_CALC_E_LIMIT, 0, 0);
+        return 0;
     }
 
-    if (ctx->op__top >= MAX_LIFO_DEPTH - 1) {
-        return false;
+    if (!buf || (len < size)) {
+        return size;
     }
-    ctx->op__lifo[++ctx->op__top] = ch;
-    ctx->i++;
-    return true;
-}
 
-static bool _process_function(calc_context_t *ctx) {
-    const char *cp = &ctx->expr[ctx->i];
+    unsigned char *raw = (unsigned char *)buf;
 
-    if (ctx->op__top >= MAX_LIFO_DEPTH - 1) {
-        return false;
-    }
+    gb_bzero(raw, pools_off);
 
-    if (gb_strncmp(cp, "sin", 3) == 0) {
-        ctx->op__lifo[++ctx->op__top] = 's';
-        ctx->i += 3;
-        return true;
-    }
+    calc_lib_header_t header = {
+        .version = LIB_VERSION,
+        .endian  = LIB_ENDIAN,
+        .size    = (uint32_t)size,
+        .count   = (uint32_t)count,
+        .nsyms   = nsyms,
+    };
 
-    if (gb_strncmp(cp, "asin", 4) == 0) {
-        ctx->op__lifo[++ctx->op__top] = 'S';
-        ctx->i += 4;
-        return true;
-    }
+    gb_memcpy(header.magic, LIB_MAGIC, sizeof(header.magic));
+    gb_memcpy(raw, &header, sizeof(header));
 
-    if (gb_strncmp(cp, "cos", 3) == 0) {
-        ctx->op__lifo[++ctx->op__top] = 'c';
-        ctx->i += 3;
-        return true;
+    for (uint32_t k = 0; k < nsyms; ++k) {
+        gb_memcpy(raw + names_off + (k * sizeof(calc_lib_name_t)), syms->entries[k].name, syms->entries[k].len);
     }
 
-    if (gb_strncmp(cp, "acos", 4) == 0) {
-        ctx->op__lifo[++ctx->op__top] = 'C';
-        ctx->i += 4;
-        return true;
-    }
+    size_t pool_at = pools_off;
+    size_t code_at = code_off;
 
-    if (gb_strncmp(cp, "tan", 3) == 0) {
-        ctx->op__lifo[++ctx->op__top] = 't';
-        ctx->i += 3;
-        return true;
+    for (size_t i = 0; i < count; ++i) {
+        const gb_calc_prog_t *prog = progs[i];
+
+        const calc_lib_entry_t entry = {
+            .code_off = (uint32_t)code_at,
+            .code_len = prog->code_len,
+            .pool_off = (uint32_t)pool_at,
+            .pool_len = prog->pool_len,
+            .depth    = prog->depth,
+            .regs     = prog->regs,
+        };
+
+        gb_memcpy(raw + entries_off + (i * sizeof(entry)), &entry, sizeof(entry));
+        gb_memcpy(raw + code_at, prog->code, prog->code_len * sizeof(calc_insn_t));
+        gb_memcpy(raw + pool_at, prog->pool, prog->pool_len * sizeof(double));
+
+        code_at += prog->code_len * sizeof(calc_insn_t);
+        pool_at += prog->pool_len * sizeof(double);
     }
 
-    if (gb_strncmp(cp, "atan", 4) == 0) {
-        ctx->op__lifo[++ctx->op__top] = 'T';
-        ctx->i += 4;
-        return true;
+    return size;
+}
+
+/**
+ * @brief Serializes compiled programs into a library file.
+ *
+ * @param[in]  path  Destination file (created or truncated).
+ * @param[in]  progs Programs to store (see gb_calc_lib_write()).
+ * @param[in]  count Number of programs.
+ * @param[in]  syms  Symbol table the programs were compiled against, or NULL.
+ * @param[out] err   Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The size of the file, or 0 on error.
+ */
+size_t gb_calc_lib_save(const char                  *path,  //
+                        const gb_calc_prog_t *const *progs, //
+                        size_t                       count, //
+                        const gb_calc_syms_t        *syms,  //
+                        gb_calc_error_t             *err) {
+    gb_calc_error_t dummy;
+
+    if (!err) {
+        err = &dummy;
     }
 
-    if (gb_strncmp(cp, "sqrt", 4) == 0) {
-        ctx->op__lifo[++ctx->op__top] = 'q';
-        ctx->i += 4;
-        return true;
+    const size_t size = gb_calc_lib_write(progs, count, syms, NULL, 0, err);
+
+    if (size == 0) {
+        return 0;
     }
 
-    if (gb_strncmp(cp, "exp", 3) == 0) {
-        ctx->op__lifo[++ctx->op__top] = 'e';
-        ctx->i += 3;
-        return true;
+    unsigned char *image = gb_malloc(size, sizeof(double));
+
+    if (!image) {
+        _raise_error(err, GB_CALC_E_NO_MEMORY, 0, 0);
+        return 0;
     }
 
-    if (gb_strncmp(cp, "log2", 4) == 0) {
-        ctx->op__lifo[++ctx->op__top] = 'L';
-        ctx->i += 4;
-        return true;
+    gb_calc_lib_write(progs, count, syms, image, size, err);
+
+    FILE *file = path ? fopen(path, "wb") : NULL;
+    bool  ok   = file && (fwrite(image, 1, size, file) == size);
+
+    if (file && (fclose(file) != 0)) {
+        ok = false;
     }
 
-    if (gb_strncmp(cp, "log", 3) == 0) {
-        ctx->op__lifo[++ctx->op__top] = 'l';
-        ctx->i += 3;
-        return true;
+    gb_free(image);
+
+    if (!ok) {
+        _raise_error(err, GB_CALC_E_IO, 0, 0);
+        return 0;
     }
 
-    return false;
+    return size;
 }
 
-static bool _process_number(calc_context_t *ctx) {
-    const char *cp = &ctx->expr[ctx->i];
-    const char  ch = *cp;
+/**
+ * @brief Loads a program library from an image in memory.
+ *
+ * The image is used in place: the bytecode and constant pools are never
+ * copied, and one allocation holds the handles of all the programs. Every
+ * program is verified in a single linear pass before it is handed out.
+ *
+ * @param[in]  image Library image (aligned to 8 bytes), e.g. a flash region.
+ *                   It must stay valid until the library is closed.
+ * @param[in]  size  Size of the image in bytes.
+ * @param[out] err   Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The library, or NULL on error. Release it with gb_calc_lib_close().
+ */
+gb_calc_lib_t *gb_calc_lib_load(const void *image, size_t size, gb_calc_error_t *err) {
+    gb_calc_error_t dummy;
 
-    if (isdigit(ch) || (ch == '.')) {
-        char  *ep;
-        double num = strtod(cp, &ep);
+    if (!err) {
+        err = &dummy;
+    }
 
-        if (!_apply_unary_op(ctx, num)) {
-            if (ctx->num_top >= MAX_LIFO_DEPTH - 1) {
-                return false;
-            }
-            ctx->num_lifo[++ctx->num_top] = num;
-        }
+    err->code = GB_CALC_OK;
+    err->pos  = 0;
+    err->row  = 0;
 
-        ctx->i += (int)(ep - cp);
-        return true;
+    if (!image || ((uintptr_t)image % sizeof(double)) || (size < sizeof(calc_lib_header_t))) {
+        return _lib_fail(err, GB_CALC_E_BAD_PROG);
     }
 
-    return false;
-}
+    const unsigned char     *raw    = (const unsigned char *)image;
+    const calc_lib_header_t *header = (const calc_lib_header_t *)image;
 
-static bool _process_constant(calc_context_t *ctx) {
-    const char *cp = &ctx->expr[ctx->i];
-    const char  ch = *cp;
+    if (!_name_equals(header->magic, LIB_MAGIC, sizeof(header->magic)) || //
+        (header->version != LIB_VERSION) ||                               //
+        (header->endian != LIB_ENDIAN) ||                                 //
+        (header->size > size) ||                                          //
+        (header->nsyms > 0x10000U)) {
+        return _lib_fail(err, GB_CALC_E_BAD_PROG);
+    }
 
-    if (gb_strncmp(cp, "pi", 2) == 0) {
-        if (!_apply_unary_op(ctx, M_PI)) {
-            if (ctx->num_top >= MAX_LIFO_DEPTH - 1) {
-                return false;
-            }
-            ctx->num_lifo[++ctx->num_top] = M_PI;
-        }
+    const uint64_t names_off   = sizeof(calc_lib_header_t);
+    const uint64_t entries_off = names_off + ((uint64_t)header->nsyms * sizeof(calc_lib_name_t));
+    const uint64_t entries_len = (uint64_t)header->count * sizeof(calc_lib_entry_t);
 
-        ctx->i += 2;
-        return true;
+    if (!_lib_range_ok(entries_off, entries_len, header->size)) {
+        return _lib_fail(err, GB_CALC_E_BAD_PROG);
     }
 
-    if ((ch == 'e') && (gb_strncmp(cp, "exp", 3) != 0)) {
-        if (!_apply_unary_op(ctx, M_E)) {
-            if (ctx->num_top >= MAX_LIFO_DEPTH - 1) {
-                return false;
-            }
-            ctx->num_lifo[++ctx->num_top] = M_E;
-        }
+    const size_t   head = _align_up(sizeof(gb_calc_lib_t));
+    unsigned char *mem  = gb_malloc(head + (header->count * sizeof(gb_calc_prog_t)), sizeof(double));
 
-        ctx->i += 1;
-        return true;
+    if (!mem) {
+        return _lib_fail(err, GB_CALC_E_NO_MEMORY);
     }
 
-    return false;
-}
+    gb_calc_lib_t *lib = (gb_calc_lib_t *)mem;
+
+    lib->progs   = (gb_calc_prog_t *)(mem + head);
+    lib->syms    = gb_calc_syms_new(GB_MAX(header->nsyms, 1U));
+    lib->count   = header->count;
+    lib->map     = NULL;
+    lib->map_len = 0;
 
-static bool _is_unary_op(const char *cp, int i) {
-    // The operator is unary if:
-    // 1. It's at the start of the expression, or
-    // 2. It follows another operator or opening parenthesis
-    if (i == 0) {
-        return true; // Unary operator at the expression start
+    if (!lib->syms) {
+        gb_calc_lib_close(lib);
+        return _lib_fail(err, GB_CALC_E_NO_MEMORY);
     }
 
-    char prev = *(cp - 1);
+    // Rebinding the names in order gives every variable its stored ordinal
+    for (uint32_t k = 0; k < header->nsyms; ++k) {
+        const char *name = (const char *)(raw + names_off + (k * sizeof(calc_lib_name_t)));
 
-    return (prev == '!' || //
-            prev == '%' || //
-            prev == '(' || //
-            prev == '*' || //
-            prev == '+' || //
-            prev == '-' || //
-            prev == '/' || //
-            prev == '^' || //
-            prev == '~');
-}
+        if ((name[GB_CALC_NAME_MAX] != '\0') ||     //
+            !gb_calc_sym_bind(lib->syms, name, 0) || //
+            (lib->syms->count != k + 1)) {
+            gb_calc_lib_close(lib);
+            return _lib_fail(err, GB_CALC_E_BAD_PROG);
+        }
+    }
 
-static bool _process_unary(calc_context_t *ctx) {
-    const char *cp = &ctx->expr[ctx->i];
-    const char  ch = *cp;
+    for (uint32_t i = 0; i < header->count; ++i) {
+        calc_lib_entry_t entry;
+        gb_memcpy(&entry, raw + entries_off + (i * sizeof(entry)), sizeof(entry));
 
-    if (_is_unary_op(cp, ctx->i)) {
-        if (ch == '+') {
-            // Skip unary plus operator
-            ctx->i++;
-            return true;
-        }
+        gb_calc_prog_t *prog = &lib->progs[i];
 
-        if ((ch == '!') || (ch == '-') || (ch == '~')) {
-            // Push unary operator (extended ID)
-            if (ctx->op__top >= MAX_LIFO_DEPTH - 1) {
-                return false;
-            }
-            ctx->op__lifo[++ctx->op__top] = (char)(ch + 128);
-            ctx->i++;
-            return true;
+        const bool placed = ((entry.code_off % sizeof(calc_insn_t)) == 0) && //
+                            ((entry.pool_off % sizeof(double)) == 0) &&      //
+                            _lib_range_ok(entry.code_off, (uint64_t)entry.code_len * sizeof(calc_insn_t), header->size) &&
+                            _lib_range_ok(entry.pool_off, (uint64_t)entry.pool_len * sizeof(double), header->size);
+
+        if (placed) {
+            prog->code     = (const calc_insn_t *)(const void *)(raw + entry.code_off);
+            prog->pool     = (const double *)(const void *)(raw + entry.pool_off);
+            prog->vars     = lib->syms->values;
+            prog->code_len = entry.code_len;
+            prog->pool_len = entry.pool_len;
+            prog->depth    = entry.depth;
+            prog->regs     = entry.regs;
         }
-    }
 
-    return false;
-}
+        uint8_t *level = placed ? _scratch_push(prog->code_len) : NULL;
 
-static bool _sanitize_expr(const char *src, char *dst, size_t dst_len) {
-    if (!src || !*src) {
-        fprintf(stderr, "Error: %s expression\n", (!src) ? "Null" : "Empty");
-        return false;
-    }
+        if (placed && !level) {
+            gb_calc_lib_close(lib);
+            return _lib_fail(err, GB_CALC_E_NO_MEMORY);
+        }
 
-    if (!dst || dst_len < gb_strlen(src) + 1) {
-        fprintf(stderr, "Error: Wrong destination buffer\n");
-        return false;
-    }
+        const bool valid = placed && _verify_prog(prog, header->nsyms, level);
+
+        if (level) {
+            _scratch_pop(prog->code_len);
+        }
 
-    while (*src) {
-        if (!isspace(*src)) {
-            *dst = *src;
-            dst++;
+        if (!valid) {
+            gb_calc_lib_close(lib);
+            _raise_error(err, GB_CALC_E_BAD_PROG, 0, i);
+            return NULL;
         }
-        src++;
     }
-    *dst = '\0';
 
-    return true;
+    return lib;
 }
 
-// *****************************************************************************
-// *****************************************************************************
-// Public Functions
-// *****************************************************************************
-// *****************************************************************************
-
 /**
- * @brief Evaluates a mathematical expression.
+ * @brief Maps a program library file and loads it.
  *
- * This function evaluates a mathematical expression represented as a string. It
- * supports arithmetic operators, parentheses, and a set of mathematical
- * functions.
+ * The whole file is mapped read-only with a single mmap(); see
+ * gb_calc_lib_load() for the rest.
  *
- * @param[in] expr A null-terminated string containing the mathematical
- *                 expression to be evaluated.
+ * @param[in]  path Library file written by gb_calc_lib_save().
+ * @param[out] err  Error report (GB_CALC_OK on success), or NULL.
  *
- * @return The result of the expression as a double. In case of an error, it
- *         returns INFINITY and prints an error message to stderr.
+ * @return The library, or NULL on error. Release it with gb_calc_lib_close().
  */
-double gb_calc(const char *expr) {
-    char dst[256];
+gb_calc_lib_t *gb_calc_lib_open(const char *path, gb_calc_error_t *err) {
+    gb_calc_error_t dummy;
 
-    if (!_sanitize_expr(expr, dst, sizeof(dst))) {
-        return INFINITY;
+    if (!err) {
+        err = &dummy;
     }
 
-    calc_context_t ctx = {
-        .expr    = dst,
-        .num_top = -1,
-        .op__top = -1,
-        .i       = 0,
-    };
-
-    char ch;
-    while ((ch = ctx.expr[ctx.i]) != '\0') { // NOSONAR (never read)
-        if (_process_unary(&ctx)) {
-            continue;
-        }
+    const int fd = path ? open(path, O_RDONLY) : -1;
 
-        if (_process_constant(&ctx)) {
-            continue;
-        }
+    struct stat st;
 
-        if (_process_number(&ctx)) {
-            continue;
+    if ((fd < 0) || (fstat(fd, &st) != 0) || (st.st_size <= 0)) {
+        if (fd >= 0) {
+            close(fd);
         }
+        return _lib_fail(err, GB_CALC_E_IO);
+    }
 
-        if (_process_function(&ctx)) {
-            continue;
-        }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
 
-        if (_process_open_paren(&ctx)) {
-            continue;
-        }
+    close(fd); // the mapping keeps the file alive
 
-        if (_process_close_paren(&ctx)) {
-            continue;
-        }
+    if (map == MAP_FAILED) {
+        return _lib_fail(err, GB_CALC_E_IO);
+    }
 
-        if (_process_binary(&ctx)) {
-            continue;
-        }
+    gb_calc_lib_t *lib = gb_calc_lib_load(map, (size_t)st.st_size, err);
 
-        fprintf(stderr, "Error: Invalid expression\n");
-        return INFINITY;
+    if (!lib) {
+        munmap(map, (size_t)st.st_size);
+        return NULL;
     }
 
-    if (!_process_operators(&ctx)) {
-        fprintf(stderr, "Error: Invalid expression\n");
-        return INFINITY;
+    lib->map     = map;
+    lib->map_len = (size_t)st.st_size;
+
+    return lib;
+}
+
+/**
+ * @brief Releases a program library (and unmaps its file).
+ *
+ * @param[in] lib Library returned by gb_calc_lib_load() or gb_calc_lib_open(),
+ *                or NULL (no-op).
+ */
+void gb_calc_lib_close(gb_calc_lib_t *lib) {
+    if (!lib) {
+        return;
     }
 
-    if (ctx.num_top != 0) {
-        fprintf(stderr, "Error: Invalid expression\n");
-        return INFINITY;
+    gb_calc_syms_free(lib->syms);
+
+    if (lib->map) {
+        munmap(lib->map, lib->map_len);
     }
 
-    return ctx.num_lifo[ctx.num_top];
+    gb_free(lib);
+}
+
+/**
+ * @brief Returns the number of programs in a library.
+ *
+ * @param[in] lib Program library.
+ */
+size_t gb_calc_lib_count(const gb_calc_lib_t *lib) {
+    return lib ? lib->count : 0;
+}
+
+/**
+ * @brief Returns a program of a library.
+ *
+ * @param[in] lib   Program library.
+ * @param[in] index Position of the program in the image.
+ *
+ * @return The program, or NULL if the index is out of range. It belongs to
+ *         the library: never pass it to gb_calc_free().
+ */
+const gb_calc_prog_t *gb_calc_lib_prog(const gb_calc_lib_t *lib, size_t index) {
+    return (lib && (index < lib->count)) ? &lib->progs[index] : NULL;
+}
+
+/**
+ * @brief Returns the symbol table of a library.
+ *
+ * @param[in] lib Program library.
+ *
+ * @return The table holding the variables read by the programs.
+ */
+gb_calc_syms_t *gb_calc_lib_syms(gb_calc_lib_t *lib) {
+    return lib ? lib->syms : NULL;
 }
 
 /* *****************************************************************************
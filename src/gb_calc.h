@@ -17,6 +17,98 @@
 #ifndef GB_CALC_H
 #define GB_CALC_H
 
+#include <stddef.h> // size_t
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Macros
+// *****************************************************************************
+// *****************************************************************************
+
+// Maximum length of a variable name (excluding the null terminator)
+#define GB_CALC_NAME_MAX 31
+
+// Number of elements processed per dispatch by gb_calc_eval_batch()
+#define GB_CALC_BLOCK 128
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**
+ * @brief Opaque handle to a compiled expression (postfix bytecode program).
+ */
+typedef struct gb_calc_prog gb_calc_prog_t;
+
+/**
+ * @brief Opaque handle to a symbol table binding variable names to values.
+ */
+typedef struct gb_calc_syms gb_calc_syms_t;
+
+/**
+ * @brief Opaque handle to a library of compiled programs loaded from an image.
+ */
+typedef struct gb_calc_lib gb_calc_lib_t;
+
+/**
+ * @brief Opaque handle to a bounded LRU cache of expression results.
+ */
+typedef struct gb_calc_cache gb_calc_cache_t;
+
+/**
+ * @brief Counters of a result cache.
+ */
+typedef struct {
+    size_t hits;     // lookups answered from the cache
+    size_t misses;   // lookups that evaluated the expression
+    size_t entries;  // results currently stored
+    size_t capacity; // maximum number of stored results
+    size_t bytes;    // memory used by the cache
+} gb_calc_cache_stats_t;
+
+/**
+ * @brief Error codes reported through gb_calc_error_t.
+ */
+typedef enum {
+    GB_CALC_OK = 0,
+    // compile-time errors
+    GB_CALC_E_NULL_EXPR,  // null expression
+    GB_CALC_E_EMPTY_EXPR, // empty expression
+    GB_CALC_E_LIMIT,      // expression too long or too deeply nested
+    GB_CALC_E_SYNTAX,     // invalid expression
+    GB_CALC_E_OPERAND,    // operator without operand(s)
+    GB_CALC_E_PARENS,     // mismatched parentheses
+    GB_CALC_E_IDENT,      // unknown identifier
+    GB_CALC_E_NO_MEMORY,  // out of memory
+    // run-time errors
+    GB_CALC_E_DIV_ZERO,   // division by zero
+    GB_CALC_E_MOD_ZERO,   // modulo by zero
+    GB_CALC_E_SQRT,       // square root of negative number
+    GB_CALC_E_LOG,        // logarithm of non-positive number
+    GB_CALC_E_BAD_PROG,   // null or corrupted program
+    GB_CALC_E_RANGE,      // result too large, negative exponent, reduction range too long, or ! / ~ out of int64 range
+    // library errors
+    GB_CALC_E_IO,         // cannot read or write a program library file
+    // user-defined functions
+    GB_CALC_E_ARGS,       // wrong number of arguments in a function call
+    GB_CALC_E_COUNT
+} gb_calc_errno_t;
+
+/**
+ * @brief Error report filled in by the library without any I/O.
+ *
+ * `pos` is the character offset, in the source expression, of the token that
+ * caused the error (the operator or function for run-time errors). Use
+ * gb_calc_format_error() to turn the report into a message.
+ */
+typedef struct {
+    gb_calc_errno_t code;
+    size_t          pos; // character offset in the source expression
+    size_t          row; // failing element (gb_calc_eval_batch() only)
+} gb_calc_error_t;
+
 // *****************************************************************************
 // *****************************************************************************
 // Public Functions
@@ -38,6 +130,469 @@
  */
 double gb_calc(const char *expr);
 
+/**
+ * @brief Evaluates a mathematical expression, reporting errors silently.
+ *
+ * Same as gb_calc(), but failures are stored in `err` instead of printed.
+ *
+ * @param[in]  expr A null-terminated string containing the mathematical
+ *                  expression to be evaluated.
+ * @param[out] err  Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The result of the expression, or INFINITY on error.
+ */
+double gb_calc_ex(const char *expr, gb_calc_error_t *err);
+
+/**
+ * @brief Compiles a mathematical expression into a reusable program.
+ *
+ * The expression is parsed once and translated into compact postfix bytecode.
+ * The exact operand stack depth is computed at compile time, so evaluating
+ * the program never parses again and needs no overflow checks.
+ *
+ * Identifiers that are not built-in functions or constants are resolved
+ * against `syms` once, at compile time. The program then reads the current
+ * values straight from the table, so the caller can update them in place
+ * between evaluations without reparsing. The table must outlive the program.
+ *
+ * @param[in]  expr A null-terminated string containing the mathematical
+ *                  expression to be compiled.
+ * @param[in]  syms Symbol table resolving variable names, or NULL.
+ * @param[out] err  Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The compiled program, or NULL on error. Release it with
+ *         gb_calc_free().
+ */
+gb_calc_prog_t *gb_calc_compile(const char *expr, gb_calc_syms_t *syms, gb_calc_error_t *err);
+
+/**
+ * @brief Compiles an expression given as a pointer and a length.
+ *
+ * Same as gb_calc_compile(), but the text is read in place from `expr` up to
+ * `len` characters and does not need a terminator, so an expression can be
+ * compiled directly out of a larger buffer. Error offsets are relative to
+ * `expr`; format the report with gb_calc_format_error_n().
+ *
+ * @param[in]  expr Expression text.
+ * @param[in]  len  Length of the expression in characters.
+ * @param[in]  syms Symbol table resolving variable names, or NULL.
+ * @param[out] err  Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The compiled program, or NULL on error. Release it with
+ *         gb_calc_free().
+ */
+gb_calc_prog_t *gb_calc_compile_n(const char *expr, size_t len, gb_calc_syms_t *syms, gb_calc_error_t *err);
+
+/**
+ * @brief Evaluates a compiled program.
+ *
+ * Evaluation stops at the first run-time error (division or modulo by zero,
+ * square root or logarithm out of domain). Infinities produced by ordinary
+ * IEEE 754 arithmetic, e.g. exp(1000), are valid results and are not errors.
+ *
+ * @param[in]  prog Program returned by gb_calc_compile().
+ * @param[out] err  Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The result of the program as a double, or INFINITY on error.
+ */
+double gb_calc_eval(const gb_calc_prog_t *prog, gb_calc_error_t *err);
+
+/**
+ * @brief Evaluates a compiled program over arrays of inputs.
+ *
+ * Structure-of-arrays batch evaluation: `cols[k]` holds the `n` input values
+ * of the variable with ordinal `k`. Each instruction is applied to a block of
+ * GB_CALC_BLOCK elements at a time, which shares the interpreter dispatch cost
+ * across the block and lets the compiler vectorize the element loops.
+ *
+ * @param[in]  prog Program returned by gb_calc_compile().
+ * @param[in]  cols Input columns indexed by symbol ordinal (see
+ *                  gb_calc_sym_index()). A NULL entry, or a NULL `cols`, uses
+ *                  the scalar value currently stored in the symbol table.
+ * @param[out] out  Destination for the `n` results; elements that fail are
+ *                  set to INFINITY.
+ * @param[in]  n    Number of elements.
+ * @param[out] err  Report of the first error (`row` is the failing element),
+ *                  GB_CALC_OK if every element succeeded, or NULL.
+ */
+void gb_calc_eval_batch(const gb_calc_prog_t *prog, //
+                        const double *const  *cols, //
+                        double               *out,  //
+                        size_t                n,    //
+                        gb_calc_error_t      *err);
+
+/**
+ * @brief Evaluates a compiled program and its partial derivatives.
+ *
+ * Forward-mode automatic differentiation: a single pass over the program
+ * yields the value and the derivatives with respect to every variable in
+ * `wrt`, replacing the 2N+1 evaluations of central finite differences. The
+ * derivatives are exact up to rounding. `!`, `~` and the quotient of `%` are
+ * piecewise constant and contribute 0; at points where a derivative does not
+ * exist (e.g. sqrt(x) at 0) it is reported as an IEEE infinity or NaN.
+ *
+ * @param[in]  prog Program returned by gb_calc_compile().
+ * @param[in]  wrt  Ordinals of the `n` variables to differentiate against
+ *                  (see gb_calc_sym_index()); an ordinal the program does not
+ *                  read gets a derivative of 0.
+ * @param[in]  n    Number of variables (0 just evaluates the program).
+ * @param[out] grad Destination for the `n` derivatives, in the order of `wrt`;
+ *                  set to INFINITY on error.
+ * @param[out] err  Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The result of the program as a double, or INFINITY on error.
+ */
+double gb_calc_eval_grad(const gb_calc_prog_t *prog, //
+                         const int            *wrt,  //
+                         size_t                n,    //
+                         double               *grad, //
+                         gb_calc_error_t      *err);
+
+/**
+ * @brief Returns the description of an error code.
+ *
+ * @param[in] code Error code.
+ *
+ * @return Static, null-terminated description (never NULL).
+ */
+const char *gb_calc_strerror(gb_calc_errno_t code);
+
+/**
+ * @brief Formats an error report into a message.
+ *
+ * The message contains the error description and the character offset, e.g.
+ * "Division by zero at offset 4". When the source expression is given, an
+ * unknown identifier is quoted as well.
+ *
+ * @param[in]  err  Error report.
+ * @param[in]  expr Source expression the report refers to, or NULL.
+ * @param[out] buf  Destination buffer.
+ * @param[in]  len  Size of the destination buffer.
+ *
+ * @return The length of the full message (as snprintf()).
+ */
+int gb_calc_format_error(const gb_calc_error_t *err, const char *expr, char *buf, size_t len);
+
+/**
+ * @brief Formats an error report into a message.
+ *
+ * Same as gb_calc_format_error(), for an expression given as pointer and
+ * length, as to gb_calc_compile_n(): the text is not read past `expr_len`
+ * characters and needs no terminator.
+ *
+ * @param[in]  err      Error report.
+ * @param[in]  expr     Source expression the report refers to, or NULL.
+ * @param[in]  expr_len Length of the expression in characters.
+ * @param[out] buf      Destination buffer.
+ * @param[in]  len      Size of the destination buffer.
+ *
+ * @return The length of the full message (as snprintf()).
+ */
+int gb_calc_format_error_n(const gb_calc_error_t *err, const char *expr, size_t expr_len, char *buf, size_t len);
+
+/**
+ * @brief Selects the scratch memory of the calling thread.
+ *
+ * Compiling needs scratch memory proportional to the expression length;
+ * evaluating needs it only for programs with very deep operand stacks. There
+ * are no fixed limits on the expression length or nesting depth (apart from
+ * the 16M characters addressable by the bytecode).
+ *
+ * By default the library owns a per-thread buffer that grows on demand and is
+ * reused by every later call, so there is no allocation per call in steady
+ * state. Embedded callers can supply a static arena instead: the library then
+ * never allocates, and an expression that does not fit fails with
+ * GB_CALC_E_NO_MEMORY (see gb_calc_scratch_size()).
+ *
+ * @param[in] buf  Caller-supplied buffer, or NULL to switch back to (and
+ *                 release) library-owned memory. The buffer must stay valid
+ *                 until it is replaced.
+ * @param[in] size Size of the buffer in bytes.
+ */
+void gb_calc_scratch(void *buf, size_t size);
+
+/**
+ * @brief Returns the scratch size needed by an expression.
+ *
+ * Batch evaluation of programs deeper than 16 operands and temporaries needs
+ * GB_CALC_BLOCK * sizeof(double) bytes per slot on top of this, and so does
+ * each nested reduction level of such a program, however it is evaluated.
+ *
+ * @param[in] expr_len Length of the source expression.
+ *
+ * @return Bytes of scratch needed to compile and evaluate an expression of
+ *         that length with gb_calc_ex(), gb_calc_compile() and gb_calc_eval().
+ */
+size_t gb_calc_scratch_size(size_t expr_len);
+
+/**
+ * @brief Selects the precision of the elementary functions.
+ *
+ * In fast-math mode sin, cos, tan, exp, log, log2 and `^` are computed by the
+ * table-driven functions of gb_fmath (see gb_fmath.h for the table size and
+ * gb_fmath_report() for the error) instead of libm; the other functions are
+ * unchanged. The mode is global and off by default. It applies to constant
+ * folding too, so programs compiled in one mode keep the folded constants of
+ * that mode. Switch it while no other thread is evaluating; results cached by
+ * gb_calc_cached() are bypassed while it is on.
+ *
+ * @param[in] enable Nonzero for the tables, zero for libm.
+ */
+void gb_calc_fast_math(int enable);
+
+/**
+ * @brief Returns nonzero when fast-math mode is on (see gb_calc_fast_math()).
+ */
+int gb_calc_fast_math_enabled(void);
+
+/**
+ * @brief Creates a result cache for variable-free expressions.
+ *
+ * The cache maps the whitespace-normalized text of an expression to its
+ * value, evicting the least recently used result when full. It lives in a
+ * single allocation bounded by `max_bytes` (roughly 128 bytes per result).
+ * Expressions longer than 95 non-blank characters and failed evaluations are
+ * never stored. A cache must not be shared between threads without locking.
+ *
+ * @param[in] max_bytes Memory budget of the cache.
+ *
+ * @return The cache, or NULL if the budget cannot hold a single result or the
+ *         allocation fails. Release it with gb_calc_cache_free().
+ */
+gb_calc_cache_t *gb_calc_cache_new(size_t max_bytes);
+
+/**
+ * @brief Releases a result cache.
+ *
+ * @param[in] cache Cache returned by gb_calc_cache_new(), or NULL (no-op).
+ */
+void gb_calc_cache_free(gb_calc_cache_t *cache);
+
+/**
+ * @brief Drops every cached result and resets the counters.
+ *
+ * @param[in] cache Result cache.
+ */
+void gb_calc_cache_clear(gb_calc_cache_t *cache);
+
+/**
+ * @brief Evaluates an expression through a result cache.
+ *
+ * Same as gb_calc_ex(), but a repeated expression returns the stored value
+ * without parsing or evaluating it again.
+ *
+ * @param[in]  cache Result cache, or NULL (plain gb_calc_ex()).
+ * @param[in]  expr  A null-terminated string containing the mathematical
+ *                   expression to be evaluated.
+ * @param[out] err   Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The result of the expression, or INFINITY on error.
+ */
+double gb_calc_cached(gb_calc_cache_t *cache, const char *expr, gb_calc_error_t *err);
+
+/**
+ * @brief Reads the counters of a result cache.
+ *
+ * @param[in]  cache Result cache.
+ * @param[out] stats Destination for the counters.
+ */
+void gb_calc_cache_stats(const gb_calc_cache_t *cache, gb_calc_cache_stats_t *stats);
+
+/**
+ * @brief Releases a compiled program.
+ *
+ * @param[in] prog Program returned by gb_calc_compile(), or NULL (no-op).
+ */
+void gb_calc_free(gb_calc_prog_t *prog);
+
+/**
+ * @brief Serializes compiled programs into a library image.
+ *
+ * The image is a compact, versioned binary holding the bytecode, constant
+ * pool, stack depth and register count of every program, plus the names of
+ * the variables they read. It can be loaded with gb_calc_lib_load() or, as a
+ * file, with gb_calc_lib_open(), with no parsing at all. Images are only
+ * portable between builds with the same byte order and format version.
+ *
+ * @param[in]  progs Programs to store, all compiled against `syms` (or
+ *                   without variables).
+ * @param[in]  count Number of programs.
+ * @param[in]  syms  Symbol table the programs were compiled against, or NULL.
+ * @param[out] buf   Destination buffer, or NULL to only compute the size.
+ * @param[in]  len   Size of the destination buffer.
+ * @param[out] err   Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The size of the image, or 0 on error. The image is written only
+ *         when it fits in `len` bytes.
+ */
+size_t gb_calc_lib_write(const gb_calc_prog_t *const *progs, //
+                         size_t                       count, //
+                         const gb_calc_syms_t        *syms,  //
+                         void                        *buf,   //
+                         size_t                       len,   //
+                         gb_calc_error_t             *err);
+
+/**
+ * @brief Serializes compiled programs into a library file.
+ *
+ * @param[in]  path  Destination file (created or truncated).
+ * @param[in]  progs Programs to store (see gb_calc_lib_write()).
+ * @param[in]  count Number of programs.
+ * @param[in]  syms  Symbol table the programs were compiled against, or NULL.
+ * @param[out] err   Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The size of the file, or 0 on error.
+ */
+size_t gb_calc_lib_save(const char                  *path,  //
+                        const gb_calc_prog_t *const *progs, //
+                        size_t                       count, //
+                        const gb_calc_syms_t        *syms,  //
+                        gb_calc_error_t             *err);
+
+/**
+ * @brief Loads a program library from an image in memory.
+ *
+ * The programs run straight from the image: nothing is parsed or copied, and
+ * a single allocation holds the handles of all the programs. Each program is
+ * verified once (opcodes, operands, stack depth, reduction nesting), so a corrupted image fails
+ * with GB_CALC_E_BAD_PROG (`row` is the failing program) instead of crashing
+ * the evaluator. The variables get a fresh symbol table, see
+ * gb_calc_lib_syms().
+ *
+ * @param[in]  image Image written by gb_calc_lib_write(), aligned to 8 bytes;
+ *                   it must stay valid until the library is closed.
+ * @param[in]  size  Size of the image in bytes.
+ * @param[out] err   Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The library, or NULL on error. Release it with gb_calc_lib_close().
+ */
+gb_calc_lib_t *gb_calc_lib_load(const void *image, size_t size, gb_calc_error_t *err);
+
+/**
+ * @brief Maps a program library file with a single mmap() and loads it.
+ *
+ * @param[in]  path Library file written by gb_calc_lib_save().
+ * @param[out] err  Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The library, or NULL on error. Release it with gb_calc_lib_close().
+ */
+gb_calc_lib_t *gb_calc_lib_open(const char *path, gb_calc_error_t *err);
+
+/**
+ * @brief Releases a program library and unmaps its file.
+ *
+ * @param[in] lib Library returned by gb_calc_lib_load() or gb_calc_lib_open(),
+ *                or NULL (no-op).
+ */
+void gb_calc_lib_close(gb_calc_lib_t *lib);
+
+/**
+ * @brief Returns the number of programs in a library.
+ *
+ * @param[in] lib Program library.
+ */
+size_t gb_calc_lib_count(const gb_calc_lib_t *lib);
+
+/**
+ * @brief Returns a program of a library.
+ *
+ * The program can be passed to every evaluator, but it belongs to the
+ * library: never release it with gb_calc_free().
+ *
+ * @param[in] lib   Program library.
+ * @param[in] index Position of the program, in the order it was written.
+ *
+ * @return The program, or NULL if the index is out of range.
+ */
+const gb_calc_prog_t *gb_calc_lib_prog(const gb_calc_lib_t *lib, size_t index);
+
+/**
+ * @brief Returns the symbol table of a library.
+ *
+ * The table holds the variables read by the programs, with the ordinals they
+ * had when the library was written, all set to 0. Bind or look them up to
+ * drive the programs; the table lives as long as the library.
+ *
+ * @param[in] lib Program library.
+ *
+ * @return The symbol table, or NULL if `lib` is NULL.
+ */
+gb_calc_syms_t *gb_calc_lib_syms(gb_calc_lib_t *lib);
+
+/**
+ * @brief Creates an empty symbol table.
+ *
+ * @param[in] max_syms Maximum number of symbols the table can hold.
+ *
+ * @return The symbol table, or NULL on failure. Release it with
+ *         gb_calc_syms_free().
+ */
+gb_calc_syms_t *gb_calc_syms_new(size_t max_syms);
+
+/**
+ * @brief Releases a symbol table.
+ *
+ * @param[in] syms Table returned by gb_calc_syms_new(), or NULL (no-op).
+ */
+void gb_calc_syms_free(gb_calc_syms_t *syms);
+
+/**
+ * @brief Defines a variable or updates its value.
+ *
+ * The returned pointer stays valid for the life of the table: writing through
+ * it is the fastest way to drive a compiled program with new inputs.
+ *
+ * @param[in] syms  Symbol table.
+ * @param[in] name  Identifier ([A-Za-z_][A-Za-z0-9_]*, at most
+ *                  GB_CALC_NAME_MAX characters) that is not a built-in
+ *                  function or constant.
+ * @param[in] value Value to store.
+ *
+ * @return Stable pointer to the variable value, or NULL if the name is
+ *         invalid or the table is full.
+ */
+double *gb_calc_sym_bind(gb_calc_syms_t *syms, const char *name, double value);
+
+/**
+ * @brief Returns the ordinal of a variable.
+ *
+ * Ordinals are assigned in definition order, starting at 0, and index the
+ * input columns of gb_calc_eval_batch().
+ *
+ * @param[in] syms Symbol table.
+ * @param[in] name Null-terminated variable name.
+ *
+ * @return The ordinal, or -1 if the variable is not defined.
+ */
+int gb_calc_sym_index(const gb_calc_syms_t *syms, const char *name);
+
+/**
+ * @brief Looks up a variable.
+ *
+ * @param[in] syms Symbol table.
+ * @param[in] name Null-terminated variable name.
+ *
+ * @return Stable pointer to the variable value, or NULL if it is not defined.
+ */
+double *gb_calc_sym_find(gb_calc_syms_t *syms, const char *name);
+
+/**
+ * @brief Defines user functions, `name(p1, p2, ...) = expression`.
+ *
+ * The definitions are separated by ';'. A body sees its parameters, the
+ * variables of `syms` and the functions defined before it. Programs compiled
+ * against `syms` afterwards can call the functions; calls are inlined at
+ * compile time, so redefining a function does not change existing programs.
+ *
+ * @param[in]  syms Symbol table.
+ * @param[in]  defs Null-terminated function definitions.
+ * @param[out] err  Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return The number of functions defined, or -1 on error (no function is
+ *         defined).
+ */
+int gb_calc_func_def(gb_calc_syms_t *syms, const char *defs, gb_calc_error_t *err);
+
 #endif // GB_CALC_H
 
 /* *****************************************************************************
@@ -0,0 +1,730 @@
+/* ************************************************************************** */
+/*
+    @file
+        gb_calc_bench.c
+
+    @date
+        October, 2026
+
+    @author
+        Gino Francesco Bogo (ᛊᛟᚱᚱᛖ ᛗᛖᚨ ᛁᛊᛏᚨᛗᛁ ᚨcᚢᚱᛉᚢ)
+
+    @license
+        MIT
+ */
+/* ************************************************************************** */
+
+#include <ctype.h>   // isalpha, isalnum, isdigit, isspace
+#include <math.h>    // M_E, M_PI, NAN, acos, asin, atan, cos, exp, fabs, fmod, isnan, log, log2, pow, ...
+#include <stdbool.h> // bool, false, true
+#include <stdint.h>  // int64_t, uint32_t
+#include <stdio.h>   // FILE, fclose, fopen, fprintf, ftell, printf, snprintf
+#include <stdlib.h>  // strtod, strtoul
+#include <string.h>  // strcmp, strlen, strncmp
+#include <time.h>    // timespec, clock_gettime, CLOCK_MONOTONIC, time
+
+#include "gb_calc.h"
+#include "gb_utils.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Defines & Macros
+// *****************************************************************************
+// *****************************************************************************
+
+#define DEFAULT_MIN_MS (100UL)
+#define DEFAULT_SEED   (12345UL)
+
+// Expressions generated per corpus case, and their maximum length
+#define CASE_EXPRS     (16)
+#define BENCH_EXPR_MAX (16384)
+
+#if defined(__GNUC__) && !defined(GB_CALC_SWITCH_DISPATCH)
+#define DISPATCH_NAME "threaded"
+#else
+#define DISPATCH_NAME "switch"
+#endif
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Types & Structures
+// *****************************************************************************
+// *****************************************************************************
+
+/*
+    Corpus case: the generator builds expressions of about `tokens` tokens,
+    nested at most `depth` levels, wrapping `funcs` percent of the operands in
+    a function call. A chain always nests the right operand, which gives the
+    deepest expression for its length.
+ */
+typedef struct {
+    const char *name;
+    int         tokens;
+    int         depth;
+    int         funcs;
+    bool        chain;
+} bench_spec_t;
+
+typedef struct {
+    char               *buf;
+    size_t              len;
+    uint32_t            seed;
+    int                 tokens;    // tokens emitted so far
+    int                 depth;     // current parenthesis depth
+    int                 max_depth; // deepest parenthesis reached
+    const bench_spec_t *spec;
+} bench_gen_t;
+
+typedef struct {
+    char           *text[CASE_EXPRS];
+    gb_calc_prog_t *prog[CASE_EXPRS];
+    int             tokens; // total over the expressions
+    int             depth;  // deepest expression
+    gb_calc_syms_t *syms;
+    double         *x;
+    double         *y;
+} bench_case_t;
+
+typedef void (*bench_run_t)(bench_case_t *bc, unsigned long iters);
+
+// Reference evaluator state
+typedef struct {
+    const char *cp;
+    double      x;
+    double      y;
+    bool        fail;
+} ref_ctx_t;
+
+typedef struct {
+    const char *name;
+    double (*func)(double);
+} ref_func_t;
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Variables
+// *****************************************************************************
+// *****************************************************************************
+
+// clang-format off
+static const bench_spec_t bench_specs[] = {
+    {"short-arith",    8,   3,  0, false},
+    {"short-func",     8,   3, 50, false},
+    {"medium-arith",  64,   6,  0, false},
+    {"medium-func",   64,   6, 30, false},
+    {"long-arith",   512,  12,  0, false},
+    {"long-func",    512,  12, 20, false},
+    {"deep-chain",   256, 256, 10,  true},
+};
+
+static const ref_func_t ref_funcs[] = {
+    {"sin",  sin }, {"cos",  cos }, {"tan",  tan }, {"asin", asin}, {"acos", acos},
+    {"atan", atan}, {"sqrt", sqrt}, {"exp",  exp }, {"log",  log }, {"log2", log2},
+};
+// clang-format on
+
+// Prevents the compiler from discarding the evaluated results
+static volatile double bench_sink;
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (Reference Evaluator)
+// *****************************************************************************
+// *****************************************************************************
+
+/*
+    A plain recursive-descent evaluator built on libc only (strtod and libm).
+    It reparses the text on every call, which is the baseline gb_calc has to
+    beat. Same grammar as gb_calc: unary operators bind tightest, then `^`
+    (right-associative), `* / %` and `+ -`.
+ */
+static double _ref_expr(ref_ctx_t *r);
+
+static void _ref_blank(ref_ctx_t *r) {
+    while (isspace((unsigned char)*r->cp)) {
+        r->cp++;
+    }
+}
+
+static double _ref_fail(ref_ctx_t *r) {
+    r->fail = true;
+    return NAN;
+}
+
+// Operand of `!` and `~` that converts to int64_t, as in the library
+static bool _ref_int_operand(double x) {
+    return (x >= -9223372036854775808.0) && (x < 9223372036854775808.0);
+}
+
+static double _ref_primary(ref_ctx_t *r) {
+    _ref_blank(r);
+
+    const char *cp = r->cp;
+
+    if (isdigit((unsigned char)*cp) || (*cp == '.')) {
+        char *ep;
+        double num = strtod(cp, &ep);
+
+        r->cp = ep;
+        return num;
+    }
+
+    if (*cp == '(') {
+        r->cp++;
+
+        const double value = _ref_expr(r);
+
+        _ref_blank(r);
+
+        if (*r->cp != ')') {
+            return _ref_fail(r);
+        }
+
+        r->cp++;
+        return value;
+    }
+
+    size_t len = 0;
+    while (isalnum((unsigned char)cp[len]) || (cp[len] == '_')) {
+        len++;
+    }
+
+    r->cp += len;
+
+    if ((len == 1) && (*cp == 'x')) {
+        return r->x;
+    }
+    if ((len == 1) && (*cp == 'y')) {
+        return r->y;
+    }
+    if ((len == 1) && (*cp == 'e')) {
+        return M_E;
+    }
+    if ((len == 2) && !strncmp(cp, "pi", 2)) {
+        return M_PI;
+    }
+
+    for (size_t i = 0; i < SIZE_OF(ref_funcs); ++i) {
+        if ((strlen(ref_funcs[i].name) == len) && !strncmp(cp, ref_funcs[i].name, len)) {
+            const double arg = _ref_primary(r);
+
+            if (((ref_funcs[i].func == sqrt) && (arg < 0)) || //
+                (((ref_funcs[i].func == log) || (ref_funcs[i].func == log2)) && (arg <= 0))) {
+                return _ref_fail(r);
+            }
+
+            return ref_funcs[i].func(arg);
+        }
+    }
+
+    return _ref_fail(r);
+}
+
+static double _ref_unary(ref_ctx_t *r) {
+    _ref_blank(r);
+
+    switch (*r->cp) {
+        case '-':
+            r->cp++;
+            return -_ref_unary(r);
+
+        case '+':
+            r->cp++;
+            return _ref_unary(r);
+
+        case '!': {
+            r->cp++;
+            const double x = _ref_unary(r);
+            return _ref_int_operand(x) ? !(int64_t)x : _ref_fail(r);
+        }
+
+        case '~': {
+            r->cp++;
+            const double x = _ref_unary(r);
+            return _ref_int_operand(x) ? (double)~(int64_t)x : _ref_fail(r);
+        }
+
+        default:
+            return _ref_primary(r);
+    }
+}
+
+static double _ref_power(ref_ctx_t *r) {
+    const double base = _ref_unary(r);
+
+    _ref_blank(r);
+
+    if (*r->cp != '^') {
+        return base;
+    }
+
+    r->cp++;
+    return pow(base, _ref_power(r));
+}
+
+static double _ref_term(ref_ctx_t *r) {
+    double value = _ref_power(r);
+
+    for (;;) {
+        _ref_blank(r);
+
+        const char op = *r->cp;
+
+        if ((op != '*') && (op != '/') && (op != '%')) {
+            return value;
+        }
+
+        r->cp++;
+
+        const double rhs = _ref_power(r);
+
+        if ((op != '*') && (rhs == 0)) {
+            return _ref_fail(r);
+        }
+
+        value = (op == '*') ? value * rhs : (op == '/') ? value / rhs : fmod(value, rhs);
+    }
+}
+
+static double _ref_expr(ref_ctx_t *r) {
+    double value = _ref_term(r);
+
+    for (;;) {
+        _ref_blank(r);
+
+        const char op = *r->cp;
+
+        if ((op != '+') && (op != '-')) {
+            return value;
+        }
+
+        r->cp++;
+
+        const double rhs = _ref_term(r);
+
+        value = (op == '+') ? value + rhs : value - rhs;
+    }
+}
+
+/**
+ * @brief Evaluates an expression with the reference evaluator.
+ *
+ * @return The value, or NAN if the expression is invalid or out of domain.
+ */
+static double _ref_calc(const char *expr, double x, double y) {
+    ref_ctx_t r = {expr, x, y, false};
+
+    const double value = _ref_expr(&r);
+
+    _ref_blank(&r);
+
+    return (r.fail || *r.cp) ? NAN : value;
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (Corpus)
+// *****************************************************************************
+// *****************************************************************************
+
+static uint32_t _rand(bench_gen_t *g) {
+    // xorshift32: the same seed always gives the same corpus
+    g->seed ^= g->seed << 13;
+    g->seed ^= g->seed >> 17;
+    g->seed ^= g->seed << 5;
+    return g->seed;
+}
+
+static void _emit(bench_gen_t *g, const char *text, int tokens) {
+    const size_t len = strlen(text);
+
+    if (g->len + len < BENCH_EXPR_MAX) {
+        gb_memcpy(g->buf + g->len, text, len + 1);
+        g->len += len;
+    }
+
+    g->tokens += tokens;
+}
+
+static void _open(bench_gen_t *g, const char *text, int tokens) {
+    _emit(g, text, tokens);
+
+    if (++g->depth > g->max_depth) {
+        g->max_depth = g->depth;
+    }
+}
+
+static void _close(bench_gen_t *g) {
+    _emit(g, ")", 1);
+    g->depth--;
+}
+
+static void _gen_leaf(bench_gen_t *g) {
+    char num[16];
+
+    switch (_rand(g) % 4) {
+        case 0:
+            _emit(g, "x", 1);
+            break;
+
+        case 1:
+            _emit(g, "y", 1);
+            break;
+
+        default:
+            snprintf(num, sizeof(num), "%u.%u", 1 + (_rand(g) % 9), _rand(g) % 100);
+            _emit(g, num, 1);
+    }
+}
+
+static void _gen_expr(bench_gen_t *g, int budget, int depth);
+
+static void _gen_operand(bench_gen_t *g, int budget, int depth) {
+    if ((budget < 3) || (depth <= 0)) {
+        _gen_leaf(g);
+        return;
+    }
+
+    _open(g, "(", 1);
+    _gen_expr(g, budget - 2, depth - 1);
+    _close(g);
+}
+
+static void _gen_call(bench_gen_t *g, int budget, int depth) {
+    static const char *const safe[] = {"sin(", "cos(", "tan(", "atan(", "exp("};
+
+    // sqrt and log only see arguments in [1, 3], so they never fail
+    if ((_rand(g) % 4) == 0) {
+        _open(g, (_rand(g) & 1) ? "sqrt(" : "log(", 2);
+        _emit(g, "2 + ", 2);
+        _open(g, "cos(", 2);
+        _gen_expr(g, budget - 7, depth - 2);
+        _close(g);
+        _close(g);
+        return;
+    }
+
+    _open(g, safe[_rand(g) % SIZE_OF(safe)], 2);
+    _gen_expr(g, budget - 3, depth - 1);
+    _close(g);
+}
+
+static void _gen_expr(bench_gen_t *g, int budget, int depth) {
+    if ((budget < 3) || (depth <= 0)) {
+        _gen_leaf(g);
+        return;
+    }
+
+    if ((budget >= 4) && ((int)(_rand(g) % 100) < g->spec->funcs)) {
+        _gen_call(g, budget, depth);
+        return;
+    }
+
+    const int left = g->spec->chain ? 1 : 1 + (int)(_rand(g) % (uint32_t)(budget - 2));
+    int       used = left + 1;
+
+    _gen_operand(g, left, depth);
+
+    // Divisions and powers take a literal, so they never fail
+    switch (_rand(g) % 8) {
+        case 0:
+            _emit(g, " / ", 1);
+            _emit(g, (_rand(g) & 1) ? "3" : "7", 1);
+            used += 2;
+            break;
+
+        case 1:
+            _emit(g, "^", 1);
+            _emit(g, (_rand(g) & 1) ? "2" : "3", 1);
+            used += 2;
+            break;
+
+        default:
+            break;
+    }
+
+    switch (_rand(g) % 3) {
+        case 0:
+            _emit(g, " - ", 1);
+            break;
+
+        case 1:
+            _emit(g, " * ", 1);
+            break;
+
+        default:
+            _emit(g, " + ", 1);
+    }
+
+    _gen_operand(g, budget - used, depth);
+}
+
+/**
+ * @brief Generates one corpus expression.
+ *
+ * @return The number of tokens of the expression.
+ */
+static int _generate(const bench_spec_t *spec, uint32_t seed, char *buf, int *depth) {
+    bench_gen_t g = {
+        .buf  = buf,
+        .seed = seed ? seed : 1,
+        .spec = spec,
+    };
+
+    buf[0] = '\0';
+    _gen_expr(&g, spec->tokens, spec->depth);
+
+    *depth = g.max_depth;
+    return g.tokens;
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (Measurements)
+// *****************************************************************************
+// *****************************************************************************
+
+static double _elapsed_ns(const struct timespec *t0, const struct timespec *t1) {
+    return ((double)(t1->tv_sec - t0->tv_sec) * 1e9) + (double)(t1->tv_nsec - t0->tv_nsec);
+}
+
+static void _run_parse(bench_case_t *bc, unsigned long iters) {
+    for (unsigned long i = 0; i < iters; ++i) {
+        gb_calc_free(gb_calc_compile(bc->text[i % CASE_EXPRS], bc->syms, NULL));
+    }
+}
+
+static void _run_eval(bench_case_t *bc, unsigned long iters) {
+    double acc = 0;
+
+    for (unsigned long i = 0; i < iters; ++i) {
+        *bc->x = (double)(i & 1023) * 0.001;
+        *bc->y = (double)(i & 511) * 0.002;
+        acc += gb_calc_eval(bc->prog[i % CASE_EXPRS], NULL);
+    }
+
+    bench_sink = acc;
+}
+
+static void _run_ref(bench_case_t *bc, unsigned long iters) {
+    double acc = 0;
+
+    for (unsigned long i = 0; i < iters; ++i) {
+        acc += _ref_calc(bc->text[i % CASE_EXPRS], (double)(i & 1023) * 0.001, (double)(i & 511) * 0.002);
+    }
+
+    bench_sink = acc;
+}
+
+/**
+ * @brief Measures the average time of one iteration.
+ *
+ * The iteration count doubles until a run lasts at least `min_ms`, so short
+ * and long expressions are both timed with enough resolution. Counts are
+ * multiples of the corpus size, so every expression weighs the same.
+ *
+ * @return Nanoseconds per iteration.
+ */
+static double _measure(bench_run_t run, bench_case_t *bc, unsigned long min_ms) {
+    unsigned long iters = CASE_EXPRS;
+
+    for (;;) {
+        struct timespec t0;
+        struct timespec t1;
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        run(bc, iters);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+
+        const double ns = _elapsed_ns(&t0, &t1);
+
+        if ((ns >= (double)min_ms * 1e6) || (iters >= (1UL << 30))) {
+            return ns / (double)iters;
+        }
+
+        iters *= 2;
+    }
+}
+
+/**
+ * @brief Counts the expressions on which gb_calc and the reference disagree.
+ */
+static int _check(bench_case_t *bc) {
+    int mismatches = 0;
+
+    for (int i = 0; i < CASE_EXPRS; ++i) {
+        *bc->x = 0.25;
+        *bc->y = 0.75;
+
+        const double got  = gb_calc_eval(bc->prog[i], NULL);
+        const double want = _ref_calc(bc->text[i], 0.25, 0.75);
+
+        const bool same = (isnan(got) && isnan(want)) || (got == want) ||
+                          (fabs(got - want) <= 1e-9 * GB_MAX(fabs(got), fabs(want)));
+
+        if (!same) {
+            mismatches++;
+        }
+    }
+
+    return mismatches;
+}
+
+static void _free_case(bench_case_t *bc) {
+    for (int i = 0; i < CASE_EXPRS; ++i) {
+        gb_calc_free(bc->prog[i]);
+        gb_free(bc->text[i]);
+    }
+}
+
+static bool _build_case(bench_case_t *bc, const bench_spec_t *spec, uint32_t seed) {
+    bc->tokens = 0;
+    bc->depth  = 0;
+
+    for (int i = 0; i < CASE_EXPRS; ++i) {
+        bc->text[i] = NULL;
+        bc->prog[i] = NULL;
+    }
+
+    for (int i = 0; i < CASE_EXPRS; ++i) {
+        int depth;
+
+        bc->text[i] = gb_malloc(BENCH_EXPR_MAX, 1);
+
+        if (!bc->text[i]) {
+            return false;
+        }
+
+        bc->tokens += _generate(spec, seed + (uint32_t)i * 7919U, bc->text[i], &depth);
+        bc->depth = GB_MAX(bc->depth, depth);
+
+        gb_calc_error_t err;
+
+        bc->prog[i] = gb_calc_compile(bc->text[i], bc->syms, &err);
+
+        if (!bc->prog[i]) {
+            char msg[96];
+
+            gb_calc_format_error(&err, bc->text[i], msg, sizeof(msg));
+            fprintf(stderr, "%s: %s\n", spec->name, msg);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Main
+// *****************************************************************************
+// *****************************************************************************
+
+static void _usage(const char *name) {
+    fprintf(stderr, "Usage: %s [-t ms] [-s seed] [-c file.csv]\n", name);
+    fprintf(stderr, "  -t    minimum duration of each measurement (default %lu ms)\n", DEFAULT_MIN_MS);
+    fprintf(stderr, "  -s    corpus seed (default %lu)\n", DEFAULT_SEED);
+    fprintf(stderr, "  -c    append the results to a CSV file\n");
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long min_ms = DEFAULT_MIN_MS;
+    unsigned long seed   = DEFAULT_SEED;
+    const char   *csv    = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-t") && (i + 1 < argc)) {
+            min_ms = strtoul(argv[++i], NULL, 10);
+        } else if (!strcmp(argv[i], "-s") && (i + 1 < argc)) {
+            seed = strtoul(argv[++i], NULL, 10);
+        } else if (!strcmp(argv[i], "-c") && (i + 1 < argc)) {
+            csv = argv[++i];
+        } else {
+            _usage(argv[0]);
+            return 2;
+        }
+    }
+
+    bench_case_t bc;
+
+    bc.syms = gb_calc_syms_new(4);
+
+    if (!bc.syms || !min_ms) {
+        _usage(argv[0]);
+        return 2;
+    }
+
+    bc.x = gb_calc_sym_bind(bc.syms, "x", 0);
+    bc.y = gb_calc_sym_bind(bc.syms, "y", 0);
+
+    FILE *out = NULL;
+
+    if (csv) {
+        out = fopen(csv, "a");
+
+        if (!out) {
+            perror(csv);
+            return 2;
+        }
+
+        // A new file gets the header; later runs append below it
+        if (ftell(out) == 0) {
+            fprintf(out, "time,dispatch,case,exprs,tokens,depth,parse_ns,parse_ns_per_token,"
+                         "evals_per_sec,eval_ns_per_token,ref_ns,ref_ns_per_token\n");
+        }
+    }
+
+    const long stamp = (long)time(NULL);
+
+    printf("dispatch: %s, seed: %lu, %d expressions per case\n\n", DISPATCH_NAME, seed, CASE_EXPRS);
+    printf("%-13s %6s %5s | %10s %7s | %12s %7s | %10s %7s\n", //
+           "case", "tokens", "depth", "parse ns", "ns/tok", "evals/sec", "ns/tok", "ref ns", "ns/tok");
+
+    int status = 0;
+
+    for (size_t s = 0; s < SIZE_OF(bench_specs); ++s) {
+        const bench_spec_t *spec = &bench_specs[s];
+
+        if (!_build_case(&bc, spec, (uint32_t)seed + (uint32_t)s)) {
+            _free_case(&bc);
+            status = 1;
+            continue;
+        }
+
+        const double tokens   = (double)bc.tokens / CASE_EXPRS;
+        const double parse_ns = _measure(_run_parse, &bc, min_ms);
+        const double eval_ns  = _measure(_run_eval, &bc, min_ms);
+        const double ref_ns   = _measure(_run_ref, &bc, min_ms);
+        const int    bad      = _check(&bc);
+
+        printf("%-13s %6.0f %5d | %10.0f %7.2f | %12.0f %7.2f | %10.0f %7.2f%s\n", //
+               spec->name, tokens, bc.depth,                                     //
+               parse_ns, parse_ns / tokens,                                      //
+               1e9 / eval_ns, eval_ns / tokens,                                  //
+               ref_ns, ref_ns / tokens,                                          //
+               bad ? "  (results differ from the reference)" : "");
+
+        if (out) {
+            fprintf(out, "%ld,%s,%s,%d,%.0f,%d,%.1f,%.3f,%.0f,%.3f,%.1f,%.3f\n", //
+                    stamp, DISPATCH_NAME, spec->name, CASE_EXPRS, tokens, bc.depth,
+                    parse_ns, parse_ns / tokens, 1e9 / eval_ns, eval_ns / tokens, ref_ns, ref_ns / tokens);
+        }
+
+        if (bad) {
+            status = 1;
+        }
+
+        _free_case(&bc);
+    }
+
+    if (out) {
+        fclose(out);
+    }
+
+    gb_calc_syms_free(bc.syms);
+    return status;
+}
+
+/*******************************************************************************
+ End of File
+*/
@@ -0,0 +1,345 @@
+/* ************************************************************************** */
+/*
+    @file
+        gb_calc_check.c
+
+    @date
+        October, 2026
+
+    @author
+        Gino Francesco Bogo (ᛊᛟᚱᚱᛖ ᛗᛖᚨ ᛁᛊᛏᚨᛗᛁ ᚨcᚢᚱᛉᚢ)
+
+    @license
+        MIT
+ */
+/* ************************************************************************** */
+
+// The library checks build programs that the compiler never emits, which needs
+// the private opcodes and program layout: the engine is compiled in here
+#include "gb_calc.c"
+
+#include <string.h> // strcmp
+
+#include "gb_bigint.h"
+#include "gb_intcalc.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Types & Structures
+// *****************************************************************************
+// *****************************************************************************
+
+/*
+    Expression checked through gb_calc_ex(): its value when `code` is
+    GB_CALC_OK, else the error code and source offset.
+ */
+typedef struct {
+    const char     *expr;
+    double          value;
+    gb_calc_errno_t code;
+    size_t          pos;
+} check_case_t;
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Variables
+// *****************************************************************************
+// *****************************************************************************
+
+// clang-format off
+static const check_case_t check_cases[] = {
+    // precedence
+    {"1 + 2 * 3",                      7,      GB_CALC_OK,          0},
+    {"2^3^2",                          512,    GB_CALC_OK,          0},
+    {"-2^2",                           4,      GB_CALC_OK,          0},
+    {"2^-2^2",                         0.0625, GB_CALC_OK,          0},
+    {"-sqrt(4)^2",                     4,      GB_CALC_OK,          0},
+    {"~5 + !0",                        -5,     GB_CALC_OK,          0},
+    // errors and their offsets
+    {"1 + ",                           0,      GB_CALC_E_OPERAND,   2},
+    {"(1 + 2",                         0,      GB_CALC_E_PARENS,    0},
+    {"2 * foo",                        0,      GB_CALC_E_IDENT,     4},
+    {"1 + 1/0",                        0,      GB_CALC_E_DIV_ZERO,  5},
+    {"sqrt(-1)^0",                     0,      GB_CALC_E_SQRT,      0},
+    // statements and user functions
+    {"a = 3; a * a",                   9,      GB_CALC_OK,          0},
+    {"1/0; 2",                         0,      GB_CALC_E_DIV_ZERO,  1},
+    {"a = 1/0; 5",                     0,      GB_CALC_E_DIV_ZERO,  5},
+    {"f(x, y) = sqrt(x^2 + y^2); f(3, 4)", 5,  GB_CALC_OK,          0},
+    {"f(x) = x; f(1, 2)",              0,      GB_CALC_E_ARGS,      13},
+    // reductions
+    {"sum(i, 1, 10, i)",               55,     GB_CALC_OK,          0},
+    {"prod(i, 1, 5, i)",               120,    GB_CALC_OK,          0},
+    {"sum(i, 1, 3, sum(j, 1, i, j))",  10,     GB_CALC_OK,          0},
+    {"sum(i, 1, 0, 1/0)",              0,      GB_CALC_OK,          0},
+    {"prod(i, 5, 1, sqrt(-1))",        1,      GB_CALC_OK,          0},
+    {"sum(i, 1, 2, 1/0)",              0,      GB_CALC_E_DIV_ZERO,  14},
+    {"sum(i, 0, 1e20, i)",             0,      GB_CALC_E_RANGE,     0},
+    // `!` and `~` on the int64_t range
+    {"!(-2^63) + ~(2^62) / 2^62",      -1,     GB_CALC_OK,          0},
+    {"~1e30",                          0,      GB_CALC_E_RANGE,     0},
+    {"1 + !(2^63)",                    0,      GB_CALC_E_RANGE,     0},
+    {"~(2^1000 * 2^1000)",             0,      GB_CALC_E_RANGE,     0},
+};
+// clang-format on
+
+static int check_failures;
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions
+// *****************************************************************************
+// *****************************************************************************
+
+static void _expect(bool ok, const char *what) {
+    if (!ok) {
+        fprintf(stderr, "FAIL: %s\n", what);
+        check_failures++;
+    }
+}
+
+static void _check_cases(void) {
+    for (size_t k = 0; k < SIZE_OF(check_cases); ++k) {
+        const check_case_t *c = &check_cases[k];
+        gb_calc_error_t     err;
+
+        const double value = gb_calc_ex(c->expr, &err);
+
+        bool ok = (err.code == c->code);
+
+        if (ok && (c->code == GB_CALC_OK)) {
+            ok = (value == c->value);
+        } else if (ok && (c->code != GB_CALC_E_RANGE)) {
+            ok = (err.pos == c->pos);
+        }
+
+        if (!ok) {
+            fprintf(stderr, "FAIL: %s = %.17g (code %d, offset %zu)\n", c->expr, value, (int)err.code, err.pos);
+            check_failures++;
+        }
+    }
+}
+
+static void _check_programs(void) {
+    gb_calc_syms_t *syms = gb_calc_syms_new(4);
+    gb_calc_error_t err;
+
+    double *x = gb_calc_sym_bind(syms, "x", 2);
+    double *y = gb_calc_sym_bind(syms, "y", 3);
+
+    _expect(gb_calc_func_def(syms, "sq(t) = t * t; hyp(a, b) = sqrt(sq(a) + sq(b))", &err) == 2, "func_def");
+    _expect((gb_calc_func_def(syms, "a = 3", &err) < 0) && (err.code == GB_CALC_E_SYNTAX) && (err.pos == 0),
+            "func_def rejects an assignment");
+    _expect((gb_calc_func_def(syms, "g(t) = t; a = 3", &err) < 0) && (err.code == GB_CALC_E_SYNTAX) && (err.pos == 10),
+            "func_def rejects an assignment after a definition");
+
+    gb_calc_prog_t *prog = gb_calc_compile("hyp(x, y) + sum(i, 1, x, i / y)", syms, &err);
+
+    _expect(prog != NULL, "compile");
+
+    if (!prog) {
+        gb_calc_syms_free(syms);
+        return;
+    }
+
+    _expect(fabs(gb_calc_eval(prog, &err) - (sqrt(13) + 1)) < 1e-12, "eval");
+
+    // Batch: a failing row does not stop the others, and an empty range skips
+    // the division
+    const double  xs[4]   = {2, 0, 3, -1};
+    const double  ys[4]   = {3, 0, 0, 0};
+    const double *cols[2] = {xs, ys};
+    double        out[4];
+
+    gb_calc_eval_batch(prog, cols, out, 4, &err);
+    _expect((err.code == GB_CALC_E_DIV_ZERO) && (err.row == 2), "batch error row");
+    _expect((out[1] == 0) && isinf(out[2]) && (out[3] == 1), "batch values");
+
+    // Gradient: the bounds of a reduction carry no tangent
+    const int wrt[2] = {gb_calc_sym_index(syms, "x"), gb_calc_sym_index(syms, "y")};
+    double    grad[2];
+
+    *x = 2;
+    *y = 3;
+    gb_calc_eval_grad(prog, wrt, 2, grad, &err);
+    _expect((err.code == GB_CALC_OK) && (fabs(grad[0] - (2 / sqrt(13))) < 1e-12) &&
+                (fabs(grad[1] - (3 / sqrt(13) - 1.0 / 3)) < 1e-12),
+            "gradient");
+
+    // `~` of a value beyond int64_t fails alike in every evaluator
+    gb_calc_prog_t *bnot = gb_calc_compile("~x", syms, &err);
+
+    _expect(bnot != NULL, "compile ~x");
+
+    if (bnot) {
+        const double  big[2]     = {1, 1e30};
+        const double *big_col[1] = {big};
+
+        gb_calc_eval_batch(bnot, big_col, out, 2, &err);
+        _expect((err.code == GB_CALC_E_RANGE) && (err.row == 1) && (out[0] == -2), "batch ~ range");
+
+        *x = 1e30;
+        gb_calc_eval_grad(bnot, wrt, 1, grad, &err);
+        _expect(err.code == GB_CALC_E_RANGE, "gradient ~ range");
+        *x = 2;
+        gb_calc_free(bnot);
+    }
+
+    // Library round trip
+    const gb_calc_prog_t *progs[1] = {prog};
+    static double         image[1024];
+    const size_t          size = gb_calc_lib_write(progs, 1, syms, image, sizeof(image), &err);
+    gb_calc_lib_t        *lib  = size ? gb_calc_lib_load(image, size, &err) : NULL;
+
+    _expect(lib != NULL, "library load");
+
+    if (lib) {
+        *gb_calc_sym_find(gb_calc_lib_syms(lib), "x") = 2;
+        *gb_calc_sym_find(gb_calc_lib_syms(lib), "y") = 3;
+        _expect(gb_calc_eval(gb_calc_lib_prog(lib, 0), NULL) == gb_calc_eval(prog, NULL), "library eval");
+        gb_calc_lib_close(lib);
+    }
+
+    gb_calc_free(prog);
+
+    // An unterminated expression: the quoted name stops at its end
+    char *text = gb_malloc(3, 1);
+    char  msg[64];
+
+    _expect(text != NULL, "malloc");
+
+    if (text) {
+        gb_memcpy(text, "1+q", 3);
+        _expect(!gb_calc_compile_n(text, 3, syms, &err) && (err.code == GB_CALC_E_IDENT), "compile_n");
+        gb_calc_format_error_n(&err, text, 3, msg, sizeof(msg));
+        _expect(!strcmp(msg, "Unknown identifier 'q' at offset 2"), "format_error_n");
+        gb_free(text);
+    }
+
+    gb_calc_syms_free(syms);
+}
+
+/**
+ * @brief Writes a library holding one hand-built program and loads it.
+ *
+ * @return `true` if the library was rejected with GB_CALC_E_BAD_PROG.
+ */
+static bool _rejects(const calc_insn_t *code, uint32_t code_len, uint32_t depth, uint32_t regs) {
+    static const double pool[1] = {1};
+    static double       image[1 << 14];
+
+    const gb_calc_prog_t prog = {
+        .code     = code,
+        .pool     = pool,
+        .code_len = code_len,
+        .pool_len = 1,
+        .depth    = depth,
+        .regs     = regs,
+    };
+    const gb_calc_prog_t *progs[1] = {&prog};
+    gb_calc_error_t       err;
+
+    const size_t   size = gb_calc_lib_write(progs, 1, NULL, image, sizeof(image), &err);
+    gb_calc_lib_t *lib  = size ? gb_calc_lib_load(image, size, &err) : NULL;
+
+    gb_calc_lib_close(lib);
+    return !lib && (err.code == GB_CALC_E_BAD_PROG);
+}
+
+static void _check_verifier(void) {
+    const calc_insn_t good[]     = {INSN(OP_PUSH, 0), INSN(OP_PUSH, 0), INSN(OP_ADD, 0), INSN(OP_RET, 0)};
+    const calc_insn_t overflow[] = {INSN(OP_PUSH, 0), INSN(OP_ADD, 0), INSN(OP_RET, 0)};
+    const calc_insn_t no_ret[]   = {INSN(OP_PUSH, 0), INSN(OP_PUSH, 0), INSN(OP_ADD, 0)};
+    const calc_insn_t bad_op[]   = {INSN(OP_PUSH, 0), INSN(OP_COUNT, 0), INSN(OP_RET, 0)};
+
+    _expect(!_rejects(good, 4, 2, 0), "verifier accepts a valid program");
+    _expect(_rejects(overflow, 3, 2, 0), "verifier rejects a missing operand");
+    _expect(_rejects(no_ret, 3, 2, 0), "verifier rejects a program without RET");
+    _expect(_rejects(bad_op, 3, 2, 0), "verifier rejects an unknown opcode");
+    _expect(_rejects(good, 4, 1, 0), "verifier rejects a stack deeper than declared");
+
+    // Every body reduces over the next one: as deep as the compiler allows,
+    // then one level more, then far more than the evaluator stack holds
+    static calc_insn_t chain[5 * 5000 + 4];
+
+    const int levels[3] = {MAX_LOOP_DEPTH, MAX_LOOP_DEPTH + 1, 5000};
+
+    for (int k = 0; k < 3; ++k) {
+        uint32_t len = 0;
+
+        for (int n = 0; n < levels[k]; ++n) {
+            if (n > 0) {
+                chain[len++] = INSN(OP_LOOP, 0);
+            }
+            chain[len++] = INSN(OP_PUSH, 0);
+            chain[len++] = INSN(OP_PUSH, 0);
+            chain[len++] = INSN(OP_SUM, 2);
+            chain[len++] = INSN(OP_RET, 0);
+        }
+        chain[len++] = INSN(OP_LOOP, 0);
+        chain[len++] = INSN(OP_PUSH, 0);
+        chain[len++] = INSN(OP_RET, 0);
+
+        _expect(_rejects(chain, len, 2, 1) == (levels[k] > MAX_LOOP_DEPTH), "verifier limits the reduction nesting");
+    }
+}
+
+static void _check_cache(void) {
+    gb_calc_cache_t      *cache = gb_calc_cache_new(4096);
+    gb_calc_cache_stats_t stats;
+
+    _expect(cache != NULL, "cache");
+
+    if (cache) {
+        _expect(gb_calc_cached(cache, "1 + 2", NULL) == 3, "cache miss");
+        _expect(gb_calc_cached(cache, "1+2", NULL) == 3, "cache hit");
+        gb_calc_cache_stats(cache, &stats);
+        _expect((stats.hits == 1) && (stats.misses == 1), "cache counters");
+        gb_calc_cache_free(cache);
+    }
+}
+
+static void _check_integers(void) {
+    const gb_intcalc_mode_t u8 = {.width = 8, .is_signed = false};
+    uint64_t                v  = 0;
+    gb_calc_error_t         err;
+
+    _expect(gb_intcalc("0xf0 | 0x0f ^ 3", NULL, &v, &err) && (v == 0xfc), "intcalc operators");
+    _expect(gb_intcalc("0xff + 2", &u8, &v, &err) && (v == 1), "intcalc wraps to the width");
+    _expect(!gb_intcalc("1 / 0", NULL, &v, &err) && (err.code == GB_CALC_E_DIV_ZERO), "intcalc division by zero");
+
+    gb_bigint_t big;
+    char        text[64];
+
+    gb_bigint_init(&big);
+    _expect(gb_bigint_calc("2^100 - 1", &big, &err) && gb_bigint_to_str(&big, 10, text, sizeof(text)) &&
+                !strcmp(text, "1267650600228229401496703205375"),
+            "bigint power");
+    gb_bigint_free(&big);
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Main
+// *****************************************************************************
+// *****************************************************************************
+
+int main(void) {
+    _check_cases();
+    _check_programs();
+    _check_verifier();
+    _check_cache();
+    _check_integers();
+
+    if (check_failures) {
+        fprintf(stderr, "%d check(s) failed\n", check_failures);
+        return 1;
+    }
+
+    printf("all checks passed\n");
+    return 0;
+}
+
+/*******************************************************************************
+ End of File
+*/
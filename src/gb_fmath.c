@@ -0,0 +1,307 @@
+/* ************************************************************************** */
+/*
+    @file
+        gb_fmath.c
+
+    @date
+        October, 2026
+
+    @author
+        Gino Francesco Bogo (ᛊᛟᚱᚱᛖ ᛗᛖᚨ ᛁᛊᛏᚨᛗᛁ ᚨcᚢᚱᛉᚢ)
+
+    @license
+        MIT
+ */
+/* ************************************************************************** */
+
+#include "gb_fmath.h"
+
+#include <math.h>    // INFINITY, M_PI, cos, exp, exp2, fabs, frexp, ldexp, log, log2, pow, ...
+#include <pthread.h> // PTHREAD_ONCE_INIT, pthread_once
+#include <stdint.h>  // int64_t
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Defines & Macros
+// *****************************************************************************
+// *****************************************************************************
+
+#if (GB_FMATH_BITS < 4) || (GB_FMATH_BITS > 12)
+#error "GB_FMATH_BITS must be between 4 and 12"
+#endif
+
+// Intervals per table
+#define FM_N (1 << GB_FMATH_BITS)
+
+// Largest angle reduced through the table (beyond it the turn loses digits)
+#define FM_TRIG_MAX 1048576.0
+
+// Widest exponent of two handed to ldexp() without overflow or underflow
+#define FM_EXP2_MAX 1020.0
+
+// Samples per function of gb_fmath_report() (the pow grid is its square root)
+#define FM_SAMPLES 65536
+#define FM_POW_GRID 256
+
+#define FM_LOG2E 1.44269504088896340736
+#define FM_LN2   0.69314718055994530942
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Variables
+// *****************************************************************************
+// *****************************************************************************
+
+static float fm_sin[FM_N + 1];  // sin(2 pi i / N)
+static float fm_exp2[FM_N + 1]; // 2^(i / N)
+static float fm_log2[FM_N + 1]; // log2(1 + i / N)
+
+static pthread_once_t fm_once = PTHREAD_ONCE_INIT;
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions
+// *****************************************************************************
+// *****************************************************************************
+
+static void _fm_fill(void) {
+    for (int i = 0; i <= FM_N; ++i) {
+        fm_sin[i]  = (float)sin((2 * M_PI * i) / FM_N);
+        fm_exp2[i] = (float)exp2((double)i / FM_N);
+        fm_log2[i] = (float)log2(1 + (double)i / FM_N);
+    }
+
+    // Exact zeros, so that sin(k pi) and cos(k pi / 2) stay small
+    fm_sin[0]        = 0;
+    fm_sin[FM_N / 2] = 0;
+    fm_sin[FM_N]     = 0;
+}
+
+// Interpolates `table` at `t`, with 0 <= t < N
+static inline double _fm_lerp(const float *table, double t) {
+    const int    i = (int)t;
+    const double f = t - i;
+
+    return table[i] + f * (table[i + 1] - table[i]);
+}
+
+/**
+ * @brief Splits an angle into table steps.
+ *
+ * @param[in]  x    Angle in radians, |x| < FM_TRIG_MAX.
+ * @param[out] frac Fraction of a step, in [0, 1).
+ *
+ * @return The whole number of steps (any sign; only its low bits matter).
+ */
+static inline int64_t _fm_turn(double x, double *frac) {
+    const double t = x * (FM_N / (2 * M_PI));
+    int64_t      k = (int64_t)t;
+
+    if (t < k) {
+        k--;
+    }
+
+    // A tiny negative `t` rounds `t - k` up to a whole step
+    *frac = t - k;
+    if (*frac >= 1) {
+        *frac = 0;
+        k++;
+    }
+
+    return k;
+}
+
+static inline double _fm_sin_at(int64_t k, double f) {
+    const int i = (int)(k & (FM_N - 1));
+
+    return fm_sin[i] + f * (fm_sin[i + 1] - fm_sin[i]);
+}
+
+// 2^u for |u| < FM_EXP2_MAX
+static inline double _fm_exp2(double u) {
+    double k = (double)(int64_t)u;
+
+    if (u < k) {
+        k -= 1;
+    }
+
+    // A tiny negative `u` rounds `u - k` up to 1: keep 0 <= t < N
+    double f = u - k;
+    if (f >= 1) {
+        f = 0;
+        k += 1;
+    }
+
+    return ldexp(_fm_lerp(fm_exp2, f * FM_N), (int)k);
+}
+
+// log2(x) for finite x > 0
+static inline double _fm_log2(double x) {
+    int          e;
+    const double m = frexp(x, &e); // [0.5, 1)
+
+    return (e - 1) + _fm_lerp(fm_log2, (2 * m - 1) * FM_N);
+}
+
+static inline void _fm_track(gb_fmath_error_t *row, double got, double ref) {
+    const double abs_err = fabs(got - ref);
+
+    if (abs_err > row->max_abs) {
+        row->max_abs = abs_err;
+    }
+
+    if (fabs(ref) >= 0x1p-10) {
+        const double rel_err = abs_err / fabs(ref);
+
+        if (rel_err > row->max_rel) {
+            row->max_rel = rel_err;
+        }
+    }
+}
+
+// Argument `i` of `n` between `lo` and `hi`, evenly or geometrically spaced
+static inline double _fm_sample(double lo, double hi, int geometric, int i, int n) {
+    const double s = (double)i / (n - 1);
+
+    return geometric ? lo * pow(hi / lo, s) : lo + (hi - lo) * s;
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Functions
+// *****************************************************************************
+// *****************************************************************************
+
+void gb_fmath_init(void) {
+    pthread_once(&fm_once, _fm_fill);
+}
+
+double gb_fmath_sin(double x) {
+    if (!(fabs(x) < FM_TRIG_MAX)) {
+        return sin(x);
+    }
+
+    double        f;
+    const int64_t k = _fm_turn(x, &f);
+
+    return _fm_sin_at(k, f);
+}
+
+double gb_fmath_cos(double x) {
+    if (!(fabs(x) < FM_TRIG_MAX)) {
+        return cos(x);
+    }
+
+    double        f;
+    const int64_t k = _fm_turn(x, &f);
+
+    return _fm_sin_at(k + FM_N / 4, f);
+}
+
+double gb_fmath_tan(double x) {
+    if (!(fabs(x) < FM_TRIG_MAX)) {
+        return tan(x);
+    }
+
+    double        f;
+    const int64_t k = _fm_turn(x, &f);
+
+    return _fm_sin_at(k, f) / _fm_sin_at(k + FM_N / 4, f);
+}
+
+double gb_fmath_exp(double x) {
+    const double u = x * FM_LOG2E;
+
+    if (!(fabs(u) < FM_EXP2_MAX)) {
+        return exp(x);
+    }
+
+    return _fm_exp2(u);
+}
+
+double gb_fmath_log(double x) {
+    if (!((x > 0) && (x < INFINITY))) {
+        return log(x);
+    }
+
+    return _fm_log2(x) * FM_LN2;
+}
+
+double gb_fmath_log2(double x) {
+    if (!((x > 0) && (x < INFINITY))) {
+        return log2(x);
+    }
+
+    return _fm_log2(x);
+}
+
+double gb_fmath_pow(double x, double y) {
+    if (!((x > 0) && (x < INFINITY))) {
+        return pow(x, y);
+    }
+
+    const double u = y * _fm_log2(x);
+
+    if (!(fabs(u) < FM_EXP2_MAX)) {
+        return pow(x, y);
+    }
+
+    return _fm_exp2(u);
+}
+
+size_t gb_fmath_report(gb_fmath_error_t *rows, size_t max) {
+    static const struct {
+        const char *name;
+        double (*fast)(double);
+        double (*ref)(double);
+        double lo;
+        double hi;
+        int    geometric;
+    } spec[] = {
+        // clang-format off
+        {"sin",  gb_fmath_sin,  sin,  -M_PI, M_PI,   0},
+        {"cos",  gb_fmath_cos,  cos,  -M_PI, M_PI,   0},
+        {"tan",  gb_fmath_tan,  tan,  -1.5,  1.5,    0},
+        {"exp",  gb_fmath_exp,  exp,  -20,   20,     0},
+        {"log",  gb_fmath_log,  log,  1e-3,  1e3,    1},
+        {"log2", gb_fmath_log2, log2, 1e-3,  1e3,    1},
+        // clang-format on
+    };
+
+    const size_t count = sizeof(spec) / sizeof(spec[0]) + 1;
+
+    gb_fmath_init();
+
+    for (size_t r = 0; (r < count) && (r < max) && rows; ++r) {
+        gb_fmath_error_t *row = &rows[r];
+
+        if (r < count - 1) {
+            *row = (gb_fmath_error_t){.name = spec[r].name, .lo = spec[r].lo, .hi = spec[r].hi};
+
+            for (int i = 0; i < FM_SAMPLES; ++i) {
+                const double x = _fm_sample(spec[r].lo, spec[r].hi, spec[r].geometric, i, FM_SAMPLES);
+
+                _fm_track(row, spec[r].fast(x), spec[r].ref(x));
+            }
+        } else {
+            // Bases over [0.1, 10] against exponents over [-4, 4]
+            *row = (gb_fmath_error_t){.name = "pow", .lo = 0.1, .hi = 10};
+
+            for (int i = 0; i < FM_POW_GRID; ++i) {
+                const double x = _fm_sample(0.1, 10, 1, i, FM_POW_GRID);
+
+                for (int j = 0; j < FM_POW_GRID; ++j) {
+                    const double y = _fm_sample(-4, 4, 0, j, FM_POW_GRID);
+
+                    _fm_track(row, gb_fmath_pow(x, y), pow(x, y));
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+/* *****************************************************************************
+ End of File
+ */
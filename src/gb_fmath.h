@@ -0,0 +1,104 @@
+/* ************************************************************************** */
+/*
+    @file
+        gb_fmath.h
+
+    @date
+        October, 2026
+
+    @author
+        Gino Francesco Bogo (ᛊᛟᚱᚱᛖ ᛗᛖᚨ ᛁᛊᛏᚨᛗᛁ ᚨcᚢᚱᛉᚢ)
+
+    @license
+        MIT
+ */
+/* ************************************************************************** */
+
+#ifndef GB_FMATH_H
+#define GB_FMATH_H
+
+#include <stddef.h> // size_t
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Macros
+// *****************************************************************************
+// *****************************************************************************
+
+// Every table has 2^GB_FMATH_BITS intervals (set at build time, 4 to 12)
+#ifndef GB_FMATH_BITS
+#define GB_FMATH_BITS 8
+#endif
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**
+ * @brief Maximum error of one function against libm (see gb_fmath_report()).
+ */
+typedef struct {
+    const char *name;    // function name
+    double      lo;      // first sampled argument
+    double      hi;      // last sampled argument
+    double      max_abs; // maximum absolute error
+    double      max_rel; // maximum relative error, where |libm| >= 2^-10
+} gb_fmath_error_t;
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Functions
+// *****************************************************************************
+// *****************************************************************************
+
+/*
+    Reduced-precision elementary functions for targets without a fast FPU:
+    a table lookup and one linear interpolation replace the polynomial of
+    libm. The tables are single precision, three of them for a total of
+    3 * (2^GB_FMATH_BITS + 1) floats (3 KiB with the default 8 bits):
+
+        sin(2 pi i / N)    one period, also read by cos and tan
+        2^(i / N)          mantissa of exp and pow
+        log2(1 + i / N)    mantissa of log, log2 and pow
+
+    The interpolation error shrinks by 4 for every extra bit. NaN, infinities
+    and the arguments the tables cannot reduce (huge angles, results that
+    overflow or underflow, non-positive bases of pow) are computed by libm.
+    The error is absolute for the trigonometric functions and the logarithms
+    and relative for exp and pow (which also scales with the exponent).
+ */
+
+/**
+ * @brief Fills the tables. Must run once before any other gb_fmath function;
+ *        further calls, from any thread, return immediately.
+ */
+void gb_fmath_init(void);
+
+double gb_fmath_sin(double x);
+double gb_fmath_cos(double x);
+double gb_fmath_tan(double x);
+double gb_fmath_exp(double x);
+double gb_fmath_log(double x);
+double gb_fmath_log2(double x);
+double gb_fmath_pow(double x, double y);
+
+/**
+ * @brief Measures the maximum error of every function against libm.
+ *
+ * Samples each function on a fixed grid over its typical range. Takes a few
+ * milliseconds with the default table size.
+ *
+ * @param[out] rows Destination for up to `max` rows, or NULL.
+ * @param[in]  max  Capacity of `rows`.
+ *
+ * @return The number of functions measured (regardless of `max`).
+ */
+size_t gb_fmath_report(gb_fmath_error_t *rows, size_t max);
+
+#endif // GB_FMATH_H
+
+/* *****************************************************************************
+ End of File
+ */
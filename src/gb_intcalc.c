@@ -0,0 +1,615 @@
+/* ************************************************************************** */
+/*
+    @file
+        gb_intcalc.c
+
+    @date
+        October, 2026
+
+    @author
+        Gino Francesco Bogo (ᛊᛟᚱᚱᛖ ᛗᛖᚨ ᛁᛊᛏᚨᛗᛁ ᚨcᚢᚱᛉᚢ)
+
+    @license
+        MIT
+ */
+/* ************************************************************************** */
+
+#include "gb_intcalc.h"
+
+#include <ctype.h>   // isalnum, isalpha, isdigit, isspace
+#include <stdbool.h> // bool, false, true
+#include <stdint.h>  // SIZE_MAX, UINT64_MAX, int64_t, uint64_t
+
+#include "gb_utils.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Defines & Macros
+// *****************************************************************************
+// *****************************************************************************
+
+// Expressions up to this length evaluate on the stack, without allocation
+#define LOCAL_TOKENS 64
+
+// Bit intrinsics: a single instruction on most targets with GCC/Clang, a
+// portable bit loop elsewhere
+#if defined(__GNUC__)
+#define _popcount64(x) ((unsigned)__builtin_popcountll(x))
+#define _clz64(x)      ((unsigned)__builtin_clzll(x)) // x != 0
+#define _ctz64(x)      ((unsigned)__builtin_ctzll(x)) // x != 0
+#define _bswap64(x)    ((uint64_t)__builtin_bswap64(x))
+#else
+static unsigned _popcount64(uint64_t x) {
+    unsigned n = 0;
+    for (; x; x &= x - 1) {
+        n++;
+    }
+    return n;
+}
+
+static unsigned _clz64(uint64_t x) {
+    unsigned n = 0;
+    for (; !(x & 0x8000000000000000ULL); x <<= 1) {
+        n++;
+    }
+    return n;
+}
+
+static unsigned _ctz64(uint64_t x) {
+    unsigned n = 0;
+    for (; !(x & 1); x >>= 1) {
+        n++;
+    }
+    return n;
+}
+
+static uint64_t _bswap64(uint64_t x) {
+    uint64_t r = 0;
+    for (int i = 0; i < 8; ++i, x >>= 8) {
+        r = (r << 8) | (x & 0xFF);
+    }
+    return r;
+}
+#endif
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Types & Structures
+// *****************************************************************************
+// *****************************************************************************
+
+typedef enum {
+    // prefix entries of the operator stack
+    IOP_PAREN = 0,
+    IOP_NEG,
+    IOP_BNOT,
+    IOP_LNOT,
+    IOP_POPCOUNT,
+    IOP_CLZ,
+    IOP_CTZ,
+    IOP_BSWAP,
+    // binary operators
+    IOP_POW,
+    IOP_MUL,
+    IOP_DIV,
+    IOP_MOD,
+    IOP_ADD,
+    IOP_SUB,
+    IOP_SHL,
+    IOP_SHR,
+    IOP_AND,
+    IOP_XOR,
+    IOP_OR,
+} iop_t;
+
+typedef struct {
+    const char *name;
+    size_t      len;
+    iop_t       op;
+} intcalc_func_t;
+
+typedef struct {
+    uint64_t *vals; // operand stack
+    size_t    nvals;
+    uint8_t  *ops;  // operator stack (iop_t)
+    size_t   *opos; // source offset of each operator
+    size_t    nops;
+
+    unsigned width;
+    bool     is_signed;
+    uint64_t mask;
+
+    gb_calc_error_t *err;
+} intcalc_t;
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Variables
+// *****************************************************************************
+// *****************************************************************************
+
+static const intcalc_func_t intcalc_funcs[] = {
+    {"popcount", 8, IOP_POPCOUNT},
+    {     "clz", 3,      IOP_CLZ},
+    {     "ctz", 3,      IOP_CTZ},
+    {   "bswap", 5,    IOP_BSWAP},
+};
+
+// Binding power of the binary operators (0 for prefix entries)
+static const uint8_t intcalc_prec[] = {
+    [IOP_POW] = 7, [IOP_MUL] = 6, [IOP_DIV] = 6, [IOP_MOD] = 6, [IOP_ADD] = 5, [IOP_SUB] = 5,
+    [IOP_SHL] = 4, [IOP_SHR] = 4, [IOP_AND] = 3, [IOP_XOR] = 2, [IOP_OR] = 1,
+};
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions
+// *****************************************************************************
+// *****************************************************************************
+
+static bool _fail(intcalc_t *ctx, gb_calc_errno_t code, size_t pos) {
+    if (ctx->err && (ctx->err->code == GB_CALC_OK)) {
+        ctx->err->code = code;
+        ctx->err->pos  = pos;
+        ctx->err->row  = 0;
+    }
+
+    return false;
+}
+
+static uint64_t _mask(unsigned width) {
+    return (width >= 64) ? UINT64_MAX : ((1ULL << width) - 1);
+}
+
+// Applies a prefix operator or built-in function to a register value
+static uint64_t _unary(const intcalc_t *ctx, iop_t op, uint64_t a) {
+    const unsigned pad = 64 - ctx->width;
+
+    switch (op) {
+        case IOP_NEG:
+            return (0 - a) & ctx->mask;
+        case IOP_BNOT:
+            return ~a & ctx->mask;
+        case IOP_LNOT:
+            return !a;
+        case IOP_POPCOUNT:
+            return _popcount64(a);
+        case IOP_CLZ:
+            return a ? (_clz64(a) - pad) : ctx->width;
+        case IOP_CTZ:
+            return a ? _ctz64(a) : ctx->width;
+        default: // IOP_BSWAP
+            return (ctx->width == 8) ? a : (_bswap64(a) >> pad);
+    }
+}
+
+// Right shift of the signed view; counts past the width fill with the sign
+static uint64_t _sar(const intcalc_t *ctx, uint64_t a, uint64_t n) {
+    const int64_t v = gb_intcalc_sext(a, ctx->width);
+
+    if (v >= 0) {
+        return (n >= ctx->width) ? 0 : ((uint64_t)v >> n);
+    }
+
+    // ~(~v >> n) is the arithmetic shift without relying on signed >>
+    const uint64_t inv = ~(uint64_t)v;
+
+    return ~((n >= ctx->width) ? 0 : (inv >> n)) & ctx->mask;
+}
+
+// Pops the top operator and applies it to the two top operands
+static bool _reduce(intcalc_t *ctx) {
+    const iop_t  op  = (iop_t)ctx->ops[--ctx->nops];
+    const size_t pos = ctx->opos[ctx->nops];
+
+    const uint64_t b = ctx->vals[--ctx->nvals];
+    uint64_t      *a = &ctx->vals[ctx->nvals - 1];
+
+    const int64_t sa = gb_intcalc_sext(*a, ctx->width);
+    const int64_t sb = gb_intcalc_sext(b, ctx->width);
+
+    uint64_t r;
+
+    switch (op) {
+        case IOP_POW: {
+            if (ctx->is_signed && (sb < 0)) {
+                return _fail(ctx, GB_CALC_E_RANGE, pos);
+            }
+            uint64_t base = *a;
+            r             = 1;
+            for (uint64_t e = b; e; e >>= 1) {
+                if (e & 1) {
+                    r *= base;
+                }
+                base *= base;
+            }
+        } break;
+
+        case IOP_MUL:
+            r = *a * b;
+            break;
+
+        case IOP_DIV:
+        case IOP_MOD:
+            if (!b) {
+                return _fail(ctx, (op == IOP_DIV) ? GB_CALC_E_DIV_ZERO : GB_CALC_E_MOD_ZERO, pos);
+            }
+            if (!ctx->is_signed) {
+                r = (op == IOP_DIV) ? (*a / b) : (*a % b);
+            } else if (sb == -1) {
+                // MIN / -1 wraps to MIN, as the register would
+                r = (op == IOP_DIV) ? (0 - *a) : 0;
+            } else {
+                r = (uint64_t)((op == IOP_DIV) ? (sa / sb) : (sa % sb));
+            }
+            break;
+
+        case IOP_ADD:
+            r = *a + b;
+            break;
+        case IOP_SUB:
+            r = *a - b;
+            break;
+        case IOP_SHL:
+            r = (b >= ctx->width) ? 0 : (*a << b);
+            break;
+        case IOP_SHR:
+            r = ctx->is_signed ? _sar(ctx, *a, b) : ((b >= ctx->width) ? 0 : (*a >> b));
+            break;
+        case IOP_AND:
+            r = *a & b;
+            break;
+        case IOP_XOR:
+            r = *a ^ b;
+            break;
+        default: // IOP_OR
+            r = *a | b;
+            break;
+    }
+
+    *a = r & ctx->mask;
+    return true;
+}
+
+// Applies the prefix operators waiting for the operand on top of the stack
+static void _apply_prefix(intcalc_t *ctx) {
+    uint64_t *top = &ctx->vals[ctx->nvals - 1];
+
+    while (ctx->nops && (ctx->ops[ctx->nops - 1] != IOP_PAREN) && !intcalc_prec[ctx->ops[ctx->nops - 1]]) {
+        *top = _unary(ctx, (iop_t)ctx->ops[--ctx->nops], *top);
+    }
+}
+
+static void _push_op(intcalc_t *ctx, iop_t op, size_t pos) {
+    ctx->opos[ctx->nops]  = pos;
+    ctx->ops[ctx->nops++] = (uint8_t)op;
+}
+
+/**
+ * @brief Scans a literal at `expr[*pos]` and pushes it, wrapped to the width.
+ */
+static bool _literal(intcalc_t *ctx, const char *expr, size_t *pos) {
+    const size_t start = *pos;
+    const char  *cp    = expr + start;
+    unsigned     base  = 10;
+
+    if ((cp[0] == '0') && ((cp[1] | 0x20) == 'x')) {
+        base = 16;
+        cp  += 2;
+    } else if ((cp[0] == '0') && ((cp[1] | 0x20) == 'b')) {
+        base = 2;
+        cp  += 2;
+    }
+
+    uint64_t value = 0;
+    size_t   len   = 0;
+
+    for (; isalnum((unsigned char)cp[len]); ++len) {
+        const char c = (char)(cp[len] | 0x20);
+        unsigned   d = base;
+
+        if ((c >= '0') && (c <= '9')) {
+            d = (unsigned)(c - '0');
+        } else if ((c >= 'a') && (c <= 'f')) {
+            d = (unsigned)(c - 'a' + 10);
+        }
+
+        if (d >= base) {
+            return _fail(ctx, GB_CALC_E_SYNTAX, start);
+        }
+
+        if (value > ((UINT64_MAX - d) / base)) {
+            return _fail(ctx, GB_CALC_E_RANGE, start);
+        }
+
+        value = (value * base) + d;
+    }
+
+    if (!len) {
+        return _fail(ctx, GB_CALC_E_SYNTAX, start);
+    }
+
+    ctx->vals[ctx->nvals++] = value & ctx->mask;
+    *pos                    = (size_t)(cp + len - expr);
+    return true;
+}
+
+/**
+ * @brief Scans a function name at `expr[*pos]` and pushes it.
+ *
+ * The name must be followed by '(' (blanks allowed in between).
+ */
+static bool _function(intcalc_t *ctx, const char *expr, size_t *pos) {
+    const size_t start = *pos;
+    size_t       len   = 0;
+
+    while (isalnum((unsigned char)expr[start + len]) || (expr[start + len] == '_')) {
+        len++;
+    }
+
+    for (size_t i = 0; i < SIZE_OF(intcalc_funcs); ++i) {
+        const intcalc_func_t *f = &intcalc_funcs[i];
+
+        if ((f->len == len) && !gb_strncmp(expr + start, f->name, len)) {
+            size_t next = start + len;
+            while (isspace((unsigned char)expr[next])) {
+                next++;
+            }
+            if (expr[next] != '(') {
+                return _fail(ctx, GB_CALC_E_SYNTAX, next);
+            }
+
+            _push_op(ctx, f->op, start);
+            *pos = next;
+            return true;
+        }
+    }
+
+    return _fail(ctx, GB_CALC_E_IDENT, start);
+}
+
+// Decodes the binary operator at `cp`; returns its length (0 if none)
+static size_t _binary_op(const char *cp, iop_t *op) {
+    // clang-format off
+    switch (cp[0]) {
+        case '*': if (cp[1] == '*') { *op = IOP_POW; return 2; } *op = IOP_MUL; return 1;
+        case '/': *op = IOP_DIV; return 1;
+        case '%': *op = IOP_MOD; return 1;
+        case '+': *op = IOP_ADD; return 1;
+        case '-': *op = IOP_SUB; return 1;
+        case '<': if (cp[1] == '<') { *op = IOP_SHL; return 2; } return 0;
+        case '>': if (cp[1] == '>') { *op = IOP_SHR; return 2; } return 0;
+        case '&': *op = IOP_AND; return 1;
+        case '^': *op = IOP_XOR; return 1;
+        case '|': *op = IOP_OR;  return 1;
+        default:  return 0;
+    }
+    // clang-format on
+}
+
+static bool _run(intcalc_t *ctx, const char *expr) {
+    bool   expect = true; // an operand is expected next
+    size_t i      = 0;
+
+    while (expr[i]) {
+        const char c = expr[i];
+
+        if (isspace((unsigned char)c)) {
+            i++;
+            continue;
+        }
+
+        if (expect) {
+            if (isdigit((unsigned char)c)) {
+                if (!_literal(ctx, expr, &i)) {
+                    return false;
+                }
+                _apply_prefix(ctx);
+                expect = false;
+                continue;
+            }
+
+            if (isalpha((unsigned char)c) || (c == '_')) {
+                if (!_function(ctx, expr, &i)) {
+                    return false;
+                }
+                continue;
+            }
+
+            switch (c) {
+                case '(':
+                    _push_op(ctx, IOP_PAREN, i);
+                    break;
+                case '-':
+                    _push_op(ctx, IOP_NEG, i);
+                    break;
+                case '~':
+                    _push_op(ctx, IOP_BNOT, i);
+                    break;
+                case '!':
+                    _push_op(ctx, IOP_LNOT, i);
+                    break;
+                case '+':
+                    break;
+                default: {
+                    iop_t op;
+                    return _fail(ctx, _binary_op(expr + i, &op) ? GB_CALC_E_OPERAND : GB_CALC_E_SYNTAX, i);
+                }
+            }
+
+            i++;
+            continue;
+        }
+
+        if (c == ')') {
+            while (ctx->nops && (ctx->ops[ctx->nops - 1] != IOP_PAREN)) {
+                if (!_reduce(ctx)) {
+                    return false;
+                }
+            }
+            if (!ctx->nops) {
+                return _fail(ctx, GB_CALC_E_PARENS, i);
+            }
+            ctx->nops--;
+            _apply_prefix(ctx);
+            i++;
+            continue;
+        }
+
+        iop_t        op;
+        const size_t len = _binary_op(expr + i, &op);
+
+        if (!len) {
+            return _fail(ctx, GB_CALC_E_SYNTAX, i);
+        }
+
+        // ** is right-associative, everything else is left-associative
+        const unsigned prec = intcalc_prec[op];
+
+        while (ctx->nops) {
+            const unsigned top = intcalc_prec[ctx->ops[ctx->nops - 1]];
+
+            if ((top < prec) || ((top == prec) && (op == IOP_POW)) || !top) {
+                break;
+            }
+            if (!_reduce(ctx)) {
+                return false;
+            }
+        }
+
+        _push_op(ctx, op, i);
+        expect = true;
+        i     += len;
+    }
+
+    if (expect) {
+        return _fail(ctx, (ctx->nops || ctx->nvals) ? GB_CALC_E_OPERAND : GB_CALC_E_EMPTY_EXPR, i);
+    }
+
+    while (ctx->nops) {
+        if (ctx->ops[ctx->nops - 1] == IOP_PAREN) {
+            return _fail(ctx, GB_CALC_E_PARENS, ctx->opos[ctx->nops - 1]);
+        }
+        if (!_reduce(ctx)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Functions
+// *****************************************************************************
+// *****************************************************************************
+
+bool gb_intcalc(const char *expr, const gb_intcalc_mode_t *mode, uint64_t *out, gb_calc_error_t *err) {
+    if (err) {
+        err->code = GB_CALC_OK;
+        err->pos  = 0;
+        err->row  = 0;
+    }
+
+    intcalc_t ctx = {
+        .width     = mode ? mode->width : 64,
+        .is_signed = mode ? mode->is_signed : true,
+        .err       = err,
+    };
+
+    if (!expr) {
+        return _fail(&ctx, GB_CALC_E_NULL_EXPR, 0);
+    }
+
+    if (!gb_intcalc_width_ok(ctx.width)) {
+        return _fail(&ctx, GB_CALC_E_RANGE, 0);
+    }
+
+    ctx.mask = _mask(ctx.width);
+
+    // Every token takes at least one character, which bounds both stacks
+    const size_t len  = gb_strlen(expr) + 1;
+    const size_t item = sizeof(uint64_t) + sizeof(size_t) + sizeof(uint8_t);
+
+    uint64_t local_vals[LOCAL_TOKENS];
+    size_t   local_opos[LOCAL_TOKENS];
+    uint8_t  local_ops[LOCAL_TOKENS];
+    void    *block = NULL;
+
+    if (len <= LOCAL_TOKENS) {
+        ctx.vals = local_vals;
+        ctx.opos = local_opos;
+        ctx.ops  = local_ops;
+    } else {
+        if (len > (SIZE_MAX / item)) {
+            return _fail(&ctx, GB_CALC_E_LIMIT, 0);
+        }
+
+        block = gb_malloc(len * item, sizeof(uint64_t));
+        if (!block) {
+            return _fail(&ctx, GB_CALC_E_NO_MEMORY, 0);
+        }
+
+        ctx.vals = (uint64_t *)block;
+        ctx.opos = (size_t *)(ctx.vals + len);
+        ctx.ops  = (uint8_t *)(ctx.opos + len);
+    }
+
+    const bool ok = _run(&ctx, expr);
+
+    if (ok && out) {
+        *out = ctx.vals[0];
+    }
+
+    gb_free(block);
+    return ok;
+}
+
+bool gb_intcalc_width_ok(unsigned width) {
+    return (width == 8) || (width == 16) || (width == 32) || (width == 64);
+}
+
+int64_t gb_intcalc_sext(uint64_t value, unsigned width) {
+    if (width >= 64) {
+        return (int64_t)value;
+    }
+
+    const uint64_t sign = 1ULL << (width - 1);
+
+    value &= _mask(width);
+
+    // (v ^ s) - s moves the sign bit to bit 63 without a signed shift
+    return (int64_t)((value ^ sign) - sign);
+}
+
+bool gb_intcalc_format(uint64_t value, unsigned width, int base, char *dst, size_t dst_len) {
+    static const char digits[] = "0123456789ABCDEF";
+
+    if (!dst || !gb_intcalc_width_ok(width) || ((base != 2) && (base != 16))) {
+        return false;
+    }
+
+    const unsigned shift = (base == 16) ? 4 : 1;
+    const unsigned nd    = width / shift;
+    const unsigned gaps  = (base == 2) ? ((nd / 4) - 1) : 0;
+
+    if ((size_t)(nd + gaps) >= dst_len) {
+        return false;
+    }
+
+    char *cp = dst + nd + gaps;
+    *cp      = '\0';
+
+    for (unsigned i = 0; i < nd; ++i) {
+        if ((base == 2) && i && !(i % 4)) {
+            *--cp = '_';
+        }
+        *--cp = digits[(value >> (i * shift)) & (base - 1)];
+    }
+
+    return true;
+}
+
+/* *****************************************************************************
+ End of File
+ */
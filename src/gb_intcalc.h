@@ -0,0 +1,110 @@
+/* ************************************************************************** */
+/*
+    @file
+        gb_intcalc.h
+
+    @date
+        October, 2026
+
+    @author
+        Gino Francesco Bogo (ᛊᛟᚱᚱᛖ ᛗᛖᚨ ᛁᛊᛏᚨᛗᛁ ᚨcᚢᚱᛉᚢ)
+
+    @license
+        MIT
+ */
+/* ************************************************************************** */
+
+#ifndef GB_INTCALC_H
+#define GB_INTCALC_H
+
+#include <stdbool.h> // bool
+#include <stddef.h>  // size_t
+#include <stdint.h>  // int64_t, uint64_t
+
+#include "gb_calc.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**
+ * @brief Register model of the integer ("programmer") mode.
+ *
+ * Every intermediate result wraps to `width` bits, as in a machine register.
+ * `is_signed` selects the two's complement view, which affects division,
+ * modulo, right shifts and how results are printed.
+ */
+typedef struct {
+    unsigned width;     // 8, 16, 32 or 64
+    bool     is_signed; // two's complement (true) or unsigned (false)
+} gb_intcalc_mode_t;
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Functions
+// *****************************************************************************
+// *****************************************************************************
+
+/**
+ * @brief Evaluates an integer expression without going through doubles.
+ *
+ * Operators and precedence follow C, from tightest to loosest:
+ * - unary `-`, `+`, `~` (bitwise NOT), `!` (logical NOT);
+ * - `**` (power, right-associative);
+ * - `*`, `/`, `%`;
+ * - `+`, `-`;
+ * - `<<`, `>>` (arithmetic in signed mode, logical otherwise);
+ * - `&`;
+ * - `^` (exclusive OR);
+ * - `|`.
+ *
+ * Literals are decimal, `0x` hexadecimal or `0b` binary. The built-in
+ * functions `popcount()`, `clz()`, `ctz()` and `bswap()` work on the register
+ * width (`clz(0)` and `ctz(0)` return the width).
+ *
+ * @param[in]  expr A null-terminated string containing the expression.
+ * @param[in]  mode Register model, or NULL for signed 64-bit.
+ * @param[out] out  Result, masked to the register width.
+ * @param[out] err  Error report (GB_CALC_OK on success), or NULL.
+ *
+ * @return `true` on success, `false` otherwise (`*out` is left untouched).
+ */
+bool gb_intcalc(const char *expr, const gb_intcalc_mode_t *mode, uint64_t *out, gb_calc_error_t *err);
+
+/**
+ * @brief Checks that a register width is supported (8, 16, 32 or 64).
+ */
+bool gb_intcalc_width_ok(unsigned width);
+
+/**
+ * @brief Sign-extends the low `width` bits of a value.
+ *
+ * @param[in] value Register value.
+ * @param[in] width Register width in bits (1 to 64).
+ *
+ * @return The two's complement value of the register.
+ */
+int64_t gb_intcalc_sext(uint64_t value, unsigned width);
+
+/**
+ * @brief Formats the low `width` bits of a value as zero-padded digits.
+ *
+ * Binary output is grouped in nibbles separated by '_' for readability.
+ *
+ * @param[in]  value   Register value.
+ * @param[in]  width   Register width in bits (8, 16, 32 or 64).
+ * @param[in]  base    2 or 16.
+ * @param[out] dst     Destination buffer.
+ * @param[in]  dst_len Size of the destination buffer.
+ *
+ * @return `true` on success, `false` if the buffer is too small.
+ */
+bool gb_intcalc_format(uint64_t value, unsigned width, int base, char *dst, size_t dst_len);
+
+#endif // GB_INTCALC_H
+
+/* *****************************************************************************
+ End of File
+ */
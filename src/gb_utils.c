@@ -16,10 +16,11 @@
 
 #include "gb_utils.h"
 
-#include <errno.h>  // errno, ERANGE
 #include <stdint.h> // SIZE_MAX, uint32_t, uintptr_t
-#include <stdio.h>  // size_t, snprintf
-#include <stdlib.h> // NULL, malloc, strtoul
+#include <stdio.h>  // size_t
+#include <stdlib.h> // NULL, malloc
+
+#include "gb_bigint.h"
 
 // *****************************************************************************
 // *****************************************************************************
@@ -484,79 +485,104 @@ static inline size_t _zero_byte_offset(const gb_word_t w) {
     // clang-format on
 }
 
-// --- Helper for gb_dec2bin / gb_hex2bin / gb_dec2hex -------------------------
+// --- Helpers for the base converters ----------------------------------------
 
 /**
- * @brief Returns the number of significant bits in a size_t value.
- *
- * Uses a binary-halving scan: each step tests whether the upper half of the
- * remaining value is non-zero, conditionally adds the half-width to the count,
- * and shifts the value down. This is O(log2(bits)) comparisons and produces
- * branchless cmov sequences on any modern compiler.
+ * @brief Parses an unsigned number of arbitrary length.
  *
- * Returns 1 for num == 0 so that the caller always emits at least one digit.
- * Safe on all platforms: no compiler builtins, no UB, no type-width assumptions.
- * The 64-bit half-step is guarded behind SIZE_MAX so 32-bit builds never
- * execute or see a shift-by-32 on a 32-bit type.
+ * The whole string must be digits of the given base, optionally preceded by
+ * the matching `0b`/`0x` prefix; signs, blanks and an empty string are
+ * rejected.
  *
- * @param[in] num Value whose significant bit count is needed.
- * @return Number of bits required to represent num (minimum 1).
+ * @param[in]  src  Null-terminated source string.
+ * @param[in]  base 2, 10 or 16.
+ * @param[out] num  Parsed value (initialized by the caller).
+ * @return true on success, false otherwise.
  */
-static inline int _count_sig_bits(size_t num) {
-    int bits = 1;
-    // clang-format off
-#if SIZE_MAX > 0xFFFFFFFFUL
-    if (num >> 32) { bits += 32; num >>= 32; }
-#endif
-    if (num >> 16) { bits += 16; num >>= 16; }
-    if (num >>  8) { bits +=  8; num >>=  8; }
-    if (num >>  4) { bits +=  4; num >>=  4; }
-    if (num >>  2) { bits +=  2; num >>=  2; }
-    if (num >>  1) { bits +=  1; }
-    // clang-format on
-    return bits;
+static bool _parse_unsigned(const char  *src,  //
+                            const int    base, //
+                            gb_bigint_t *num) {
+    const char prefix = (base == 16) ? 'x' : 'b';
+
+    if ((base != 10) && (src[0] == '0') && ((src[1] | 0x20) == prefix)) {
+        src += 2;
+    }
+
+    return gb_bigint_from_str(num, src, gb_strlen(src), base);
 }
 
 /**
- * @brief Converts a size_t value to a zero-padded binary string.
+ * @brief Formats an unsigned number, zero-padded to a multiple of `group`
+ * digits.
  *
- * The number of significant bits is computed with _count_sig_bits, a portable
- * binary-halving scan. The output is then padded with leading '0' characters
- * to the next multiple of 8 bits before the binary digits are written from
- * least-significant to most-significant. The caller must ensure dst_bin is
- * large enough.
+ * The digits are written at the front of the buffer first; if padding is
+ * needed they are shifted right and the vacated leading positions are filled
+ * with '0'.
  *
- * @param[in]  num     Value to convert.
- * @param[out] dst_bin Destination buffer.
+ * @param[in]  num     Value to format.
+ * @param[in]  base    2, 10 or 16.
+ * @param[in]  group   Digit group size (1 for no padding).
+ * @param[out] dst     Destination buffer.
  * @param[in]  dst_len Size of destination buffer.
  * @return true on success, false if the buffer is too small.
  */
-static bool _unsafe_dec2bin(const size_t num,     //
-                            char        *dst_bin, //
-                            const size_t dst_len) {
-    int bits = _count_sig_bits(num);
+static bool _format_unsigned(const gb_bigint_t *num,   //
+                             const int          base,  //
+                             const size_t       group, //
+                             char              *dst,   //
+                             const size_t       dst_len) {
+    const size_t len = gb_bigint_to_str(num, base, dst, dst_len);
+
+    if (!len) {
+        return false;
+    }
 
-    int rem = bits % 8;
-    int pad = (rem > 0) ? (8 - rem) : 0;
+    const size_t rem = len % group;
+    const size_t pad = rem ? (group - rem) : 0;
 
-    if ((pad + bits) < (int)dst_len) {
-        for (int i = 0; i < pad; ++i) {
-            dst_bin[i] = '0';
+    if (pad) {
+        if ((len + pad) >= dst_len) {
+            return false;
         }
 
-        // Walk backwards from the MSB position — avoids recomputing
-        // (pad + bits - 1 - i) on every iteration
-        char *p = dst_bin + pad + bits - 1;
-        for (int i = 0; i < bits; ++i, --p) {
-            *p = (char)((num & (1UL << i)) ? '1' : '0');
-        }
+        gb_memmove(dst + pad, dst, len + 1);
+        gb_memset(dst, '0', pad);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Converts an unsigned number between two bases.
+ *
+ * @param[in]  src     Null-terminated source string.
+ * @param[in]  from    Source base.
+ * @param[in]  to      Destination base.
+ * @param[in]  group   Destination digit group size (1 for no padding).
+ * @param[out] dst     Destination buffer.
+ * @param[in]  dst_len Size of destination buffer.
+ * @return true on success, false otherwise.
+ */
+static bool _convert(const char *restrict src, //
+                     const int    from,        //
+                     const int    to,          //
+                     const size_t group,       //
+                     char *restrict dst,       //
+                     const size_t dst_len) {
+    bool rvalue = (src && dst && dst_len);
+
+    if (rvalue) {
+        gb_bigint_t num;
+
+        gb_bigint_init(&num);
 
-        dst_bin[pad + bits] = '\0';
+        rvalue = _parse_unsigned(src, from, &num) && //
+                 _format_unsigned(&num, to, group, dst, dst_len);
 
-        return true;
+        gb_bigint_free(&num);
     }
 
-    return false;
+    return rvalue;
 }
 
 // *****************************************************************************
@@ -1754,6 +1780,11 @@ int gb_strncmp(const char *str1, //
 }
 
 // --- Conversion --------------------------------------------------------------
+//
+// The six base converters work on gb_bigint_t values, so the input length is
+// limited only by the destination buffer. The source must be an unsigned
+// number in the expected base (binary and hexadecimal inputs may carry a
+// `0b`/`0x` prefix); trailing characters, signs and blanks are rejected.
 
 /**
  * @brief Converts a binary string to a decimal string.
@@ -1770,21 +1801,7 @@ int gb_strncmp(const char *str1, //
 bool gb_bin2dec(const char *restrict src_bin, //
                 char *restrict dst_dec,       //
                 size_t dst_len) {
-    bool rvalue = (src_bin && dst_dec && dst_len);
-
-    if (rvalue) {
-        char *err;
-        errno      = 0;
-        size_t num = strtoul(src_bin, &err, 2);
-
-        rvalue = !(*err) && (errno != ERANGE);
-
-        if (rvalue) {
-            rvalue = snprintf(dst_dec, dst_len, "%zu", num) > 0;
-        }
-    }
-
-    return rvalue;
+    return _convert(src_bin, 2, 10, 1, dst_dec, dst_len);
 }
 
 /**
@@ -1802,21 +1819,7 @@ bool gb_bin2dec(const char *restrict src_bin, //
 bool gb_bin2hex(const char *restrict src_bin, //
                 char *restrict dst_hex,       //
                 size_t dst_len) {
-    bool rvalue = (src_bin && dst_hex && dst_len);
-
-    if (rvalue) {
-        char *err;
-        errno      = 0;
-        size_t num = strtoul(src_bin, &err, 2);
-
-        rvalue = !(*err) && (errno != ERANGE);
-
-        if (rvalue) {
-            rvalue = snprintf(dst_hex, dst_len, "%zX", num) > 0;
-        }
-    }
-
-    return rvalue;
+    return _convert(src_bin, 2, 16, 1, dst_hex, dst_len);
 }
 
 /**
@@ -1835,21 +1838,7 @@ bool gb_bin2hex(const char *restrict src_bin, //
 bool gb_dec2bin(const char *restrict src_dec, //
                 char *restrict dst_bin,       //
                 size_t dst_len) {
-    bool rvalue = (src_dec && dst_bin && dst_len);
-
-    if (rvalue) {
-        char *err;
-        errno      = 0;
-        size_t num = strtoul(src_dec, &err, 10);
-
-        rvalue = !(*err) && (errno != ERANGE);
-
-        if (rvalue) {
-            rvalue = _unsafe_dec2bin(num, dst_bin, dst_len);
-        }
-    }
-
-    return rvalue;
+    return _convert(src_dec, 10, 2, 8, dst_bin, dst_len);
 }
 
 /**
@@ -1859,10 +1848,9 @@ bool gb_dec2bin(const char *restrict src_dec, //
  * into a hexadecimal string `dst_hex`. The output is padded with leading zeros
  * to ensure it is a multiple of 4 characters.
  *
- * Algorithm: snprintf writes the raw hex representation; its return value is
- * validated against dst_len before the padding step to ensure the buffer is
- * large enough for the shift. If the resulting length is not already a multiple
- * of 4, the existing digits are shifted right and the gap is filled with '0'.
+ * Algorithm: the raw hex digits are written first; if their count is not
+ * already a multiple of 4 and the buffer has room, they are shifted right and
+ * the gap is filled with '0'.
  *
  * @param[in]  src_dec Pointer to the source decimal string.
  * @param[out] dst_hex Pointer to the destination hexadecimal string.
@@ -1873,44 +1861,7 @@ bool gb_dec2bin(const char *restrict src_dec, //
 bool gb_dec2hex(const char *restrict src_dec, //
                 char *restrict dst_hex,       //
                 size_t dst_len) {
-    bool rvalue = (src_dec && dst_hex && dst_len);
-
-    if (!rvalue) {
-        return false;
-    }
-
-    char *err;
-    errno      = 0;
-    size_t num = strtoul(src_dec, &err, 10);
-
-    rvalue = !(*err) && (errno != ERANGE);
-
-    if (rvalue) {
-        // snprintf returns the number of characters written; reuse that
-        // value as len directly — avoids a redundant gb_strlen traversal
-        int written = snprintf(dst_hex, dst_len, "%zX", num);
-        rvalue      = (written > 0 && (size_t)written < dst_len);
-
-        if (rvalue) {
-            int len = written;
-            int rem = len % 4;
-            int pad = 4 - rem;
-
-            // Pad to a multiple of 4 hex digits: shift existing digits right,
-            // then fill the vacated leading positions with '0'
-            if (rem > 0 && ((pad + len) < (int)dst_len)) {
-                for (int i = len; i >= 0; --i) {
-                    dst_hex[i + pad] = dst_hex[i];
-                }
-
-                for (int i = 0; i < pad; ++i) {
-                    dst_hex[i] = '0';
-                }
-            }
-        }
-    }
-
-    return rvalue;
+    return _convert(src_dec, 10, 16, 4, dst_hex, dst_len);
 }
 
 /**
@@ -1929,21 +1880,7 @@ bool gb_dec2hex(const char *restrict src_dec, //
 bool gb_hex2bin(const char *restrict src_hex, //
                 char *restrict dst_bin,       //
                 size_t dst_len) {
-    bool rvalue = (src_hex && dst_bin && dst_len);
-
-    if (rvalue) {
-        char *err;
-        errno      = 0;
-        size_t num = strtoul(src_hex, &err, 16);
-
-        rvalue = !(*err) && (errno != ERANGE);
-
-        if (rvalue) {
-            rvalue = _unsafe_dec2bin(num, dst_bin, dst_len);
-        }
-    }
-
-    return rvalue;
+    return _convert(src_hex, 16, 2, 8, dst_bin, dst_len);
 }
 
 /**
@@ -1961,21 +1898,7 @@ bool gb_hex2bin(const char *restrict src_hex, //
 bool gb_hex2dec(const char *restrict src_hex, //
                 char *restrict dst_dec,       //
                 size_t dst_len) {
-    bool rvalue = (src_hex && dst_dec && dst_len);
-
-    if (rvalue) {
-        char *err;
-        errno      = 0;
-        size_t num = strtoul(src_hex, &err, 16);
-
-        rvalue = !(*err) && (errno != ERANGE);
-
-        if (rvalue) {
-            rvalue = snprintf(dst_dec, dst_len, "%zu", num) > 0;
-        }
-    }
-
-    return rvalue;
+    return _convert(src_hex, 16, 10, 1, dst_dec, dst_len);
 }
 
 /**
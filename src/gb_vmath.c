@@ -0,0 +1,721 @@
+/* ************************************************************************** */
+/*
+    @file
+        gb_vmath.c
+
+    @date
+        October, 2026
+
+    @author
+        Gino Francesco Bogo (ᛊᛟᚱᚱᛖ ᛗᛖᚨ ᛁᛊᛏᚨᛗᛁ ᚨcᚢᚱᛉᚢ)
+
+    @license
+        MIT
+ */
+/* ************************************************************************** */
+
+#include "gb_vmath.h"
+
+#include <float.h>  // FLT_EVAL_METHOD
+#include <math.h>   // acos, asin, atan, cos, exp, log, log2, sin, sqrt, tan
+#include <stdint.h> // uint64_t
+#include <string.h> // memcpy
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Defines & Macros
+// *****************************************************************************
+// *****************************************************************************
+
+// Contracting a * b + c into a fused multiply-add would change the rounding
+// the reductions are built on, and make the paths disagree
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+/*
+    Vector layer: the kernels below are written once against these helpers.
+    Masks are vectors of doubles with all bits set in the selected lanes.
+    Define GB_VMATH_SCALAR to force the portable path.
+ */
+#if defined(__AVX2__) && !defined(GB_VMATH_SCALAR)
+
+#include <immintrin.h>
+
+#define VM_LANES 4
+
+typedef __m256d vm_d;
+typedef __m256i vm_i;
+
+// clang-format off
+static inline vm_d vm_set(double v)                 { return _mm256_set1_pd(v); }
+static inline vm_d vm_load(const double *p)         { return _mm256_loadu_pd(p); }
+static inline void vm_store(double *p, vm_d a)      { _mm256_storeu_pd(p, a); }
+static inline vm_d vm_add(vm_d a, vm_d b)           { return _mm256_add_pd(a, b); }
+static inline vm_d vm_sub(vm_d a, vm_d b)           { return _mm256_sub_pd(a, b); }
+static inline vm_d vm_mul(vm_d a, vm_d b)           { return _mm256_mul_pd(a, b); }
+static inline vm_d vm_div(vm_d a, vm_d b)           { return _mm256_div_pd(a, b); }
+static inline vm_d vm_sqrt(vm_d a)                  { return _mm256_sqrt_pd(a); }
+static inline vm_d vm_and(vm_d a, vm_d b)           { return _mm256_and_pd(a, b); }
+static inline vm_d vm_or(vm_d a, vm_d b)            { return _mm256_or_pd(a, b); }
+static inline vm_d vm_xor(vm_d a, vm_d b)           { return _mm256_xor_pd(a, b); }
+static inline vm_d vm_andnot(vm_d a, vm_d b)        { return _mm256_andnot_pd(b, a); } // a & ~b
+static inline vm_d vm_gt(vm_d a, vm_d b)            { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+static inline vm_d vm_ge(vm_d a, vm_d b)            { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+static inline vm_d vm_le(vm_d a, vm_d b)            { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+static inline unsigned vm_bits(vm_d m)              { return (unsigned)_mm256_movemask_pd(m); }
+static inline vm_i vm_as_i(vm_d a)                  { return _mm256_castpd_si256(a); }
+static inline vm_d vm_as_d(vm_i a)                  { return _mm256_castsi256_pd(a); }
+static inline vm_i vm_seti(uint64_t v)              { return _mm256_set1_epi64x((long long)v); }
+static inline vm_i vm_addi(vm_i a, vm_i b)          { return _mm256_add_epi64(a, b); }
+static inline vm_i vm_subi(vm_i a, vm_i b)          { return _mm256_sub_epi64(a, b); }
+static inline vm_i vm_andi(vm_i a, vm_i b)          { return _mm256_and_si256(a, b); }
+static inline vm_i vm_ori(vm_i a, vm_i b)           { return _mm256_or_si256(a, b); }
+#define vm_shli(a, n) _mm256_slli_epi64(a, n)
+#define vm_shri(a, n) _mm256_srli_epi64(a, n)
+// clang-format on
+
+#elif defined(__SSE2__) && !defined(GB_VMATH_SCALAR)
+
+#include <emmintrin.h>
+
+#define VM_LANES 2
+
+typedef __m128d vm_d;
+typedef __m128i vm_i;
+
+// clang-format off
+static inline vm_d vm_set(double v)                 { return _mm_set1_pd(v); }
+static inline vm_d vm_load(const double *p)         { return _mm_loadu_pd(p); }
+static inline void vm_store(double *p, vm_d a)      { _mm_storeu_pd(p, a); }
+static inline vm_d vm_add(vm_d a, vm_d b)           { return _mm_add_pd(a, b); }
+static inline vm_d vm_sub(vm_d a, vm_d b)           { return _mm_sub_pd(a, b); }
+static inline vm_d vm_mul(vm_d a, vm_d b)           { return _mm_mul_pd(a, b); }
+static inline vm_d vm_div(vm_d a, vm_d b)           { return _mm_div_pd(a, b); }
+static inline vm_d vm_sqrt(vm_d a)                  { return _mm_sqrt_pd(a); }
+static inline vm_d vm_and(vm_d a, vm_d b)           { return _mm_and_pd(a, b); }
+static inline vm_d vm_or(vm_d a, vm_d b)            { return _mm_or_pd(a, b); }
+static inline vm_d vm_xor(vm_d a, vm_d b)           { return _mm_xor_pd(a, b); }
+static inline vm_d vm_andnot(vm_d a, vm_d b)        { return _mm_andnot_pd(b, a); } // a & ~b
+static inline vm_d vm_gt(vm_d a, vm_d b)            { return _mm_cmpgt_pd(a, b); }
+static inline vm_d vm_ge(vm_d a, vm_d b)            { return _mm_cmpge_pd(a, b); }
+static inline vm_d vm_le(vm_d a, vm_d b)            { return _mm_cmple_pd(a, b); }
+static inline unsigned vm_bits(vm_d m)              { return (unsigned)_mm_movemask_pd(m); }
+static inline vm_i vm_as_i(vm_d a)                  { return _mm_castpd_si128(a); }
+static inline vm_d vm_as_d(vm_i a)                  { return _mm_castsi128_pd(a); }
+static inline vm_i vm_seti(uint64_t v)              { return _mm_set1_epi64x((long long)v); }
+static inline vm_i vm_addi(vm_i a, vm_i b)          { return _mm_add_epi64(a, b); }
+static inline vm_i vm_subi(vm_i a, vm_i b)          { return _mm_sub_epi64(a, b); }
+static inline vm_i vm_andi(vm_i a, vm_i b)          { return _mm_and_si128(a, b); }
+static inline vm_i vm_ori(vm_i a, vm_i b)           { return _mm_or_si128(a, b); }
+#define vm_shli(a, n) _mm_slli_epi64(a, n)
+#define vm_shri(a, n) _mm_srli_epi64(a, n)
+// clang-format on
+
+#elif defined(__aarch64__) && defined(__ARM_NEON) && !defined(GB_VMATH_SCALAR)
+
+#include <arm_neon.h>
+
+#define VM_LANES 2
+
+typedef float64x2_t vm_d;
+typedef uint64x2_t  vm_i;
+
+// clang-format off
+static inline vm_d vm_set(double v)                 { return vdupq_n_f64(v); }
+static inline vm_d vm_load(const double *p)         { return vld1q_f64(p); }
+static inline void vm_store(double *p, vm_d a)      { vst1q_f64(p, a); }
+static inline vm_d vm_add(vm_d a, vm_d b)           { return vaddq_f64(a, b); }
+static inline vm_d vm_sub(vm_d a, vm_d b)           { return vsubq_f64(a, b); }
+static inline vm_d vm_mul(vm_d a, vm_d b)           { return vmulq_f64(a, b); }
+static inline vm_d vm_div(vm_d a, vm_d b)           { return vdivq_f64(a, b); }
+static inline vm_d vm_sqrt(vm_d a)                  { return vsqrtq_f64(a); }
+static inline vm_i vm_as_i(vm_d a)                  { return vreinterpretq_u64_f64(a); }
+static inline vm_d vm_as_d(vm_i a)                  { return vreinterpretq_f64_u64(a); }
+static inline vm_d vm_and(vm_d a, vm_d b)           { return vm_as_d(vandq_u64(vm_as_i(a), vm_as_i(b))); }
+static inline vm_d vm_or(vm_d a, vm_d b)            { return vm_as_d(vorrq_u64(vm_as_i(a), vm_as_i(b))); }
+static inline vm_d vm_xor(vm_d a, vm_d b)           { return vm_as_d(veorq_u64(vm_as_i(a), vm_as_i(b))); }
+static inline vm_d vm_andnot(vm_d a, vm_d b)        { return vm_as_d(vbicq_u64(vm_as_i(a), vm_as_i(b))); } // a & ~b
+static inline vm_d vm_gt(vm_d a, vm_d b)            { return vm_as_d(vcgtq_f64(a, b)); }
+static inline vm_d vm_ge(vm_d a, vm_d b)            { return vm_as_d(vcgeq_f64(a, b)); }
+static inline vm_d vm_le(vm_d a, vm_d b)            { return vm_as_d(vcleq_f64(a, b)); }
+static inline vm_i vm_seti(uint64_t v)              { return vdupq_n_u64(v); }
+static inline vm_i vm_addi(vm_i a, vm_i b)          { return vaddq_u64(a, b); }
+static inline vm_i vm_subi(vm_i a, vm_i b)          { return vsubq_u64(a, b); }
+static inline vm_i vm_andi(vm_i a, vm_i b)          { return vandq_u64(a, b); }
+static inline vm_i vm_ori(vm_i a, vm_i b)           { return vorrq_u64(a, b); }
+#define vm_shli(a, n) vshlq_n_u64(a, n)
+#define vm_shri(a, n) vshrq_n_u64(a, n)
+
+static inline unsigned vm_bits(vm_d m) {
+    const vm_i b = vm_shri(vm_as_i(m), 63);
+    return (unsigned)(vgetq_lane_u64(b, 0) | (vgetq_lane_u64(b, 1) << 1));
+}
+// clang-format on
+
+#else
+
+#define VM_LANES 1
+
+typedef double   vm_d;
+typedef uint64_t vm_i;
+
+static inline vm_i vm_as_i(vm_d a) {
+    vm_i i;
+    memcpy(&i, &a, sizeof(i));
+    return i;
+}
+
+static inline vm_d vm_as_d(vm_i a) {
+    vm_d d;
+    memcpy(&d, &a, sizeof(d));
+    return d;
+}
+
+// clang-format off
+static inline vm_d vm_set(double v)                 { return v; }
+static inline vm_d vm_load(const double *p)         { return *p; }
+static inline void vm_store(double *p, vm_d a)      { *p = a; }
+static inline vm_d vm_add(vm_d a, vm_d b)           { return a + b; }
+static inline vm_d vm_sub(vm_d a, vm_d b)           { return a - b; }
+static inline vm_d vm_mul(vm_d a, vm_d b)           { return a * b; }
+static inline vm_d vm_div(vm_d a, vm_d b)           { return a / b; }
+static inline vm_d vm_sqrt(vm_d a)                  { return sqrt(a); }
+static inline vm_d vm_and(vm_d a, vm_d b)           { return vm_as_d(vm_as_i(a) & vm_as_i(b)); }
+static inline vm_d vm_or(vm_d a, vm_d b)            { return vm_as_d(vm_as_i(a) | vm_as_i(b)); }
+static inline vm_d vm_xor(vm_d a, vm_d b)           { return vm_as_d(vm_as_i(a) ^ vm_as_i(b)); }
+static inline vm_d vm_andnot(vm_d a, vm_d b)        { return vm_as_d(vm_as_i(a) & ~vm_as_i(b)); }
+static inline vm_d vm_gt(vm_d a, vm_d b)            { return vm_as_d((a > b) ? ~0ULL : 0); }
+static inline vm_d vm_ge(vm_d a, vm_d b)            { return vm_as_d((a >= b) ? ~0ULL : 0); }
+static inline vm_d vm_le(vm_d a, vm_d b)            { return vm_as_d((a <= b) ? ~0ULL : 0); }
+static inline unsigned vm_bits(vm_d m)              { return (unsigned)(vm_as_i(m) >> 63); }
+static inline vm_i vm_seti(uint64_t v)              { return v; }
+static inline vm_i vm_addi(vm_i a, vm_i b)          { return a + b; }
+static inline vm_i vm_subi(vm_i a, vm_i b)          { return a - b; }
+static inline vm_i vm_andi(vm_i a, vm_i b)          { return a & b; }
+static inline vm_i vm_ori(vm_i a, vm_i b)           { return a | b; }
+#define vm_shli(a, n) ((vm_i)(a) << (n))
+#define vm_shri(a, n) ((vm_i)(a) >> (n))
+// clang-format on
+
+#endif
+
+#define VM_FULL ((1U << VM_LANES) - 1)
+
+// The reductions rely on every operation rounding to double: with excess
+// precision (x87) everything goes to libm
+#if (VM_LANES == 1) && defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD != 0)
+#define VM_KERNELS 0
+#else
+#define VM_KERNELS 1
+#endif
+
+// Lane-wise `m ? a : b`
+#define vm_select(m, a, b) vm_or(vm_and(m, a), vm_andnot(b, m))
+
+// Polynomial in z with constant coefficients (Horner scheme)
+#define vm_poly(z, c) _vm_poly(z, c, sizeof(c) / sizeof(c[0]))
+
+// Adding then subtracting 1.5 * 2^52 rounds to the nearest integer, and the
+// low bits of the intermediate sum hold that integer in two's complement
+#define ROUND_MAGIC 0x1.8p52
+#define ROUND_BITS  0x4338000000000000ULL
+
+#define SIGN_BIT  0x8000000000000000ULL
+#define EXPO_MASK 0x7FF0000000000000ULL
+#define MANT_MASK 0x000FFFFFFFFFFFFFULL
+
+// Arguments the trigonometric reduction keeps exact: k * PIO2_1 must not
+// round, and k grows with |x|
+#define TRIG_MAX 0x1p15
+
+#define EXP_MAX 708.0
+
+// Below this magnitude the kernels would go through subnormal intermediates,
+// which are slow on most FPUs: such arguments are left to libm
+#define VM_TINY 0x1p-500
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Variables
+// *****************************************************************************
+// *****************************************************************************
+
+/*
+    The coefficients are those of fdlibm (sin, cos, exp, log, log2) and Cephes
+    (atan). The first entry of each table is the highest degree.
+ */
+
+// sin(r) = r + r^3 * S(r^2) on [-pi/4, pi/4]
+static const double sin_coef[] = {
+    1.58969099521155010221e-10,  //
+    -2.50507602534068634195e-08, //
+    2.75573137070700676789e-06,  //
+    -1.98412698298579493134e-04, //
+    8.33333333332248946124e-03,  //
+    -1.66666666666666324348e-01,
+};
+
+// cos(r) = 1 - r^2 / 2 + r^4 * C(r^2) on [-pi/4, pi/4]
+static const double cos_coef[] = {
+    -1.13596475577881948265e-11, //
+    2.08757232129817482790e-09,  //
+    -2.75573143513906633035e-07, //
+    2.48015872894767294178e-05,  //
+    -1.38888888888741095749e-03, //
+    4.16666666666666019037e-02,
+};
+
+// pi/2 in three 33-bit pieces, so that k * PIO2_n is exact for small k
+#define INV_PIO2 6.36619772367581382433e-01
+#define PIO2_1   1.57079632673412561417e+00
+#define PIO2_2   6.07710050630396597660e-11
+#define PIO2_3   2.02226624871116645580e-21
+#define PIO2_3T  8.47842766036889956997e-32
+
+// atan(x) = x + x^3 * P(x^2) / Q(x^2) on [0, 0.66]
+static const double atan_p[] = {
+    -8.750608600031904122785e-01, //
+    -1.615753718733365076637e+01, //
+    -7.500855792314704667340e+01, //
+    -1.228866684490136173410e+02, //
+    -6.485021904942025371773e+01,
+};
+
+static const double atan_q[] = {
+    1.0,                         //
+    2.485846490142306297962e+01, //
+    1.650270098316988542046e+02, //
+    4.328810604912902668951e+02, //
+    4.853903996359136964868e+02, //
+    1.945506571482613964425e+02,
+};
+
+#define PIO2      1.57079632679489661923e+00
+#define PIO4      7.85398163397448309616e-01
+#define T3P8      2.41421356237309504880e+00 // tan(3 pi / 8)
+#define MOREBITS  6.123233995736765886130e-17 // pi/2 - PIO2
+
+// exp(r) = 1 + 2r / (2 - c) with c = r - r^2 * P(r^2) on [-ln2/2, ln2/2]
+static const double exp_coef[] = {
+    4.13813679705723846039e-08,  //
+    -1.65339022054652515390e-06, //
+    6.61375632143793436117e-05,  //
+    -2.77777777770155933842e-03, //
+    1.66666666666666019037e-01,
+};
+
+#define INV_LN2 1.44269504088896338700e+00
+#define LN2_HI  6.93147180369123816490e-01
+#define LN2_LO  1.90821492927058770002e-10
+
+// log(1 + f) = f - f^2 / 2 + s * (f^2 / 2 + R), s = f / (2 + f), split in the
+// even and odd powers of s^2
+static const double log_odd[] = {
+    1.479819860511658591e-01, //
+    1.818357216161805012e-01, //
+    2.857142874366239149e-01, //
+    6.666666666666735130e-01,
+};
+
+static const double log_even[] = {
+    1.531383769920937332e-01, //
+    2.222219843214978396e-01, //
+    3.999999999940941908e-01,
+};
+
+#define SQRT2     1.41421356237309504880e+00
+#define IVLN2_HI  1.44269504072144627571e+00
+#define IVLN2_LO  1.67517131648865118353e-10
+#define LOG_MIN  0x1p-1022
+#define LOG_MAX 0x1.fffffffffffffp1023
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (Kernels)
+// *****************************************************************************
+// *****************************************************************************
+
+static inline vm_d _vm_poly(vm_d z, const double *c, size_t n) {
+    vm_d p = vm_set(c[0]);
+
+    for (size_t i = 1; i < n; ++i) {
+        p = vm_add(vm_mul(p, z), vm_set(c[i]));
+    }
+
+    return p;
+}
+
+static inline vm_d _vm_abs(vm_d x) {
+    return vm_andnot(x, vm_set(-0.0));
+}
+
+// Lanes with 0 or VM_TINY <= |x| <= max (false for NaN)
+static inline vm_d _vm_in_range(vm_d x, double max) {
+    const vm_d ax = _vm_abs(x);
+    const vm_d lo = vm_or(vm_ge(ax, vm_set(VM_TINY)), vm_le(ax, vm_set(0.0)));
+
+    return vm_and(lo, vm_le(ax, vm_set(max)));
+}
+
+static inline vm_d _vm_sign(vm_d x) {
+    return vm_and(x, vm_set(-0.0));
+}
+
+// Returns x in its zero lanes, y elsewhere: sin and tan keep the sign of a
+// zero argument, which the reduction to +0 loses
+static inline vm_d _vm_keep_zero(vm_d x, vm_d y) {
+    return vm_select(vm_le(_vm_abs(x), vm_set(0.0)), x, y);
+}
+
+/**
+ * @brief Reduces x to hi + lo = x - k * pi/2 with |hi| <= pi/4.
+ *
+ * x - k * PIO2_1 and k * PIO2_2 are exact; the rounding error of their
+ * difference is recovered (TwoSum) and carried in `lo` with the last two
+ * pieces of pi/2, so arguments close to a multiple of pi/2 keep full
+ * relative accuracy.
+ *
+ * @param[in]  x  Arguments, |x| <= TRIG_MAX.
+ * @param[out] q  Integer k in two's complement (only the low bits matter).
+ * @param[out] lo Low part of the reduced arguments.
+ *
+ * @return The high part of the reduced arguments.
+ */
+static inline vm_d _vm_reduce_pio2(vm_d x, vm_i *q, vm_d *lo) {
+    const vm_d t = vm_add(vm_mul(x, vm_set(INV_PIO2)), vm_set(ROUND_MAGIC));
+    const vm_d k = vm_sub(t, vm_set(ROUND_MAGIC));
+
+    const vm_d a = vm_sub(x, vm_mul(k, vm_set(PIO2_1)));
+    const vm_d b = vm_mul(k, vm_set(-PIO2_2));
+    const vm_d r = vm_add(a, b);
+
+    // TwoSum: a + b = r + e exactly
+    const vm_d bb = vm_sub(r, a);
+    const vm_d e  = vm_add(vm_sub(a, vm_sub(r, bb)), vm_sub(b, bb));
+
+    const vm_d tail = vm_sub(e, vm_add(vm_mul(k, vm_set(PIO2_3)), vm_mul(k, vm_set(PIO2_3T))));
+    const vm_d hi   = vm_add(r, tail);
+
+    *lo = vm_sub(tail, vm_sub(hi, r));
+    *q  = vm_as_i(t);
+
+    return hi;
+}
+
+// sin(r + y) for |y| much smaller than |r|
+static inline vm_d _vm_sin_kernel(vm_d r, vm_d y) {
+    const vm_d z = vm_mul(r, r);
+    const vm_d v = vm_mul(z, r);
+
+    // sin(r + y) ~ sin(r) + y * (1 - r^2 / 2)
+    const vm_d dy = vm_sub(y, vm_mul(vm_mul(z, vm_set(0.5)), y));
+    return vm_add(r, vm_add(vm_mul(v, vm_poly(z, sin_coef)), dy));
+}
+
+// cos(r + y) for |y| much smaller than |r|
+static inline vm_d _vm_cos_kernel(vm_d r, vm_d y) {
+    const vm_d z  = vm_mul(r, r);
+    const vm_d hz = vm_mul(z, vm_set(0.5));
+    const vm_d w  = vm_sub(vm_set(1.0), hz);
+
+    // 1 - hz rounded, plus what the rounding lost, plus the polynomial tail;
+    // cos(r + y) ~ cos(r) - r * y
+    const vm_d lost = vm_sub(vm_sub(vm_set(1.0), w), hz);
+    const vm_d tail = vm_sub(vm_mul(vm_mul(z, z), vm_poly(z, cos_coef)), vm_mul(r, y));
+    return vm_add(w, vm_add(lost, tail));
+}
+
+// Full mask in the lanes where bit 0 of q is set
+static inline vm_d _vm_odd(vm_i q) {
+    return vm_as_d(vm_subi(vm_seti(0), vm_andi(q, vm_seti(1))));
+}
+
+// Sign bit in the lanes where bit 1 of q is set
+static inline vm_d _vm_half_turn(vm_i q) {
+    return vm_as_d(vm_shli(vm_andi(q, vm_seti(2)), 62));
+}
+
+static inline vm_d _vm_sin(vm_d x, vm_d *ok) {
+    vm_i       q;
+    vm_d       y;
+    const vm_d r = _vm_reduce_pio2(x, &q, &y);
+    const vm_d s = _vm_sin_kernel(r, y);
+    const vm_d c = _vm_cos_kernel(r, y);
+
+    *ok = _vm_in_range(x, TRIG_MAX);
+
+    return _vm_keep_zero(x, vm_xor(vm_select(_vm_odd(q), c, s), _vm_half_turn(q)));
+}
+
+static inline vm_d _vm_cos(vm_d x, vm_d *ok) {
+    vm_i       q;
+    vm_d       y;
+    const vm_d r = _vm_reduce_pio2(x, &q, &y);
+    const vm_d s = _vm_sin_kernel(r, y);
+    const vm_d c = _vm_cos_kernel(r, y);
+
+    *ok = _vm_in_range(x, TRIG_MAX);
+
+    // cos(x) = sin(x + pi/2)
+    q = vm_addi(q, vm_seti(1));
+
+    return vm_xor(vm_select(_vm_odd(q), c, s), _vm_half_turn(q));
+}
+
+static inline vm_d _vm_tan(vm_d x, vm_d *ok) {
+    vm_i       q;
+    vm_d       y;
+    const vm_d r   = _vm_reduce_pio2(x, &q, &y);
+    const vm_d s   = _vm_sin_kernel(r, y);
+    const vm_d c   = _vm_cos_kernel(r, y);
+    const vm_d odd = _vm_odd(q);
+
+    *ok = _vm_in_range(x, TRIG_MAX);
+
+    // tan(r + pi/2) = -cos(r) / sin(r)
+    const vm_d t = vm_div(vm_select(odd, c, s), vm_select(odd, s, c));
+    return _vm_keep_zero(x, vm_xor(t, vm_and(odd, vm_set(-0.0))));
+}
+
+static inline vm_d _vm_atan_all(vm_d x) {
+    const vm_d ax  = _vm_abs(x);
+    const vm_d mid = vm_gt(ax, vm_set(0.66));
+    const vm_d big = vm_gt(ax, vm_set(T3P8));
+
+    // atan(x) = pi/4 + atan((x - 1) / (x + 1)) = pi/2 + atan(-1 / x)
+    vm_d num = vm_select(mid, vm_sub(ax, vm_set(1.0)), ax);
+    vm_d den = vm_select(mid, vm_add(ax, vm_set(1.0)), vm_set(1.0));
+    num      = vm_select(big, vm_set(-1.0), num);
+    den      = vm_select(big, ax, den);
+
+    const vm_d y0   = vm_select(big, vm_set(PIO2), vm_and(mid, vm_set(PIO4)));
+    const vm_d more = vm_select(big, vm_set(MOREBITS), vm_and(mid, vm_set(0.5 * MOREBITS)));
+
+    const vm_d t = vm_div(num, den);
+    const vm_d z = vm_mul(t, t);
+    const vm_d p = vm_div(vm_mul(z, vm_poly(z, atan_p)), vm_poly(z, atan_q));
+    const vm_d y = vm_add(y0, vm_add(vm_add(vm_mul(t, p), t), more));
+
+    return vm_or(y, _vm_sign(x));
+}
+
+static inline vm_d _vm_atan(vm_d x, vm_d *ok) {
+    *ok = _vm_in_range(x, 0x1p500);
+
+    return _vm_atan_all(x);
+}
+
+static inline vm_d _vm_asin(vm_d x, vm_d *ok) {
+    const vm_d one = vm_set(1.0);
+
+    *ok = _vm_in_range(x, 1.0);
+
+    // asin(x) = atan(x / sqrt((1 - x) * (1 + x)))
+    const vm_d c = vm_sqrt(vm_mul(vm_sub(one, x), vm_add(one, x)));
+    return _vm_atan_all(vm_div(x, c));
+}
+
+static inline vm_d _vm_acos(vm_d x, vm_d *ok) {
+    const vm_d one = vm_set(1.0);
+
+    *ok = vm_le(_vm_abs(x), one);
+
+    // acos(x) = 2 * atan(sqrt((1 - x) / (1 + x)))
+    const vm_d t = vm_sqrt(vm_div(vm_sub(one, x), vm_add(one, x)));
+    return vm_mul(vm_set(2.0), _vm_atan_all(t));
+}
+
+static inline vm_d _vm_exp(vm_d x, vm_d *ok) {
+    const vm_d t = vm_add(vm_mul(x, vm_set(INV_LN2)), vm_set(ROUND_MAGIC));
+    const vm_d k = vm_sub(t, vm_set(ROUND_MAGIC));
+
+    *ok = _vm_in_range(x, EXP_MAX);
+
+    // x = k * ln2 + hi - lo
+    const vm_d hi = vm_sub(x, vm_mul(k, vm_set(LN2_HI)));
+    const vm_d lo = vm_mul(k, vm_set(LN2_LO));
+    const vm_d r  = vm_sub(hi, lo);
+    const vm_d z  = vm_mul(r, r);
+    const vm_d c  = vm_sub(r, vm_mul(z, vm_poly(z, exp_coef)));
+
+    const vm_d rc = vm_div(vm_mul(r, c), vm_sub(vm_set(2.0), c));
+    const vm_d y  = vm_sub(vm_set(1.0), vm_sub(vm_sub(lo, rc), hi));
+
+    // 2^k, built in the exponent field
+    const vm_i kb    = vm_subi(vm_as_i(t), vm_seti(ROUND_BITS));
+    const vm_d scale = vm_as_d(vm_shli(vm_addi(kb, vm_seti(1023)), 52));
+
+    return vm_mul(y, scale);
+}
+
+/**
+ * @brief Splits x = 2^k * m with m in [sqrt(2)/2, sqrt(2)).
+ *
+ * @param[in]  x Normal positive arguments.
+ * @param[out] k The exponents, as doubles.
+ *
+ * @return f = m - 1 (exact).
+ */
+static inline vm_d _vm_log_split(vm_d x, vm_d *k) {
+    const vm_i b = vm_as_i(x);
+    const vm_d m = vm_as_d(vm_ori(vm_andi(b, vm_seti(MANT_MASK)), vm_as_i(vm_set(1.0))));
+
+    // The biased exponent becomes the mantissa of 2^52 + e
+    const vm_d e   = vm_sub(vm_as_d(vm_ori(vm_shri(b, 52), vm_as_i(vm_set(0x1p52)))), vm_set(0x1p52 + 1023.0));
+    const vm_d big = vm_gt(m, vm_set(SQRT2));
+
+    *k = vm_add(e, vm_and(big, vm_set(1.0)));
+
+    return vm_sub(vm_select(big, vm_mul(m, vm_set(0.5)), m), vm_set(1.0));
+}
+
+// s * (f^2 / 2 + R(s^2)) - f^2 / 2 for log(1 + f) = f + that
+static inline vm_d _vm_log_tail(vm_d f, vm_d *hfsq) {
+    const vm_d s = vm_div(f, vm_add(vm_set(2.0), f));
+    const vm_d z = vm_mul(s, s);
+    const vm_d w = vm_mul(z, z);
+    const vm_d R = vm_add(vm_mul(z, vm_poly(w, log_odd)), vm_mul(w, vm_poly(w, log_even)));
+
+    *hfsq = vm_mul(vm_mul(f, f), vm_set(0.5));
+
+    return vm_mul(s, vm_add(*hfsq, R));
+}
+
+static inline vm_d _vm_log(vm_d x, vm_d *ok) {
+    vm_d k;
+    vm_d hfsq;
+
+    *ok = vm_and(vm_ge(x, vm_set(LOG_MIN)), vm_le(x, vm_set(LOG_MAX)));
+
+    const vm_d f  = _vm_log_split(x, &k);
+    const vm_d sr = _vm_log_tail(f, &hfsq);
+
+    // k * ln2_hi - ((hfsq - (s * (hfsq + R) + k * ln2_lo)) - f)
+    const vm_d inner = vm_sub(hfsq, vm_add(sr, vm_mul(k, vm_set(LN2_LO))));
+    return vm_sub(vm_mul(k, vm_set(LN2_HI)), vm_sub(inner, f));
+}
+
+static inline vm_d _vm_log2(vm_d x, vm_d *ok) {
+    vm_d k;
+    vm_d hfsq;
+
+    *ok = vm_and(vm_ge(x, vm_set(LOG_MIN)), vm_le(x, vm_set(LOG_MAX)));
+
+    const vm_d f  = _vm_log_split(x, &k);
+    const vm_d sr = _vm_log_tail(f, &hfsq);
+
+    // log(1 + f) = hi + lo, hi with its low 32 bits cleared so that
+    // hi * IVLN2_HI is exact
+    const vm_d hi = vm_as_d(vm_andi(vm_as_i(vm_sub(f, hfsq)), vm_seti(0xFFFFFFFF00000000ULL)));
+    const vm_d lo = vm_add(vm_sub(vm_sub(f, hi), hfsq), sr);
+
+    const vm_d v_hi = vm_mul(hi, vm_set(IVLN2_HI));
+    const vm_d v_lo = vm_add(vm_mul(vm_add(lo, hi), vm_set(IVLN2_LO)), vm_mul(lo, vm_set(IVLN2_HI)));
+
+    const vm_d w = vm_add(k, v_hi);
+    return vm_add(vm_add(v_lo, vm_add(vm_sub(k, w), v_hi)), w);
+}
+
+static inline vm_d _vm_sqrt(vm_d x, vm_d *ok) {
+    *ok = vm_as_d(vm_seti(~0ULL));
+
+    return vm_sqrt(x);
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (Drivers)
+// *****************************************************************************
+// *****************************************************************************
+
+/**
+ * @brief Stores the results of one vector, recomputing with libm the lanes
+ *        the kernel does not cover.
+ *
+ * @param[out] dst    Destination of the `m` results.
+ * @param[in]  src    The `m` arguments (`dst` may be the same array).
+ * @param[in]  y      Kernel results.
+ * @param[in]  bits   Lanes covered by the kernel.
+ * @param[in]  m      Number of lanes to store (<= VM_LANES).
+ * @param[in]  scalar libm function.
+ */
+static void _vm_finish(double       *dst, //
+                       const double *src, //
+                       vm_d          y,   //
+                       unsigned      bits,
+                       size_t        m,
+                       double (*scalar)(double)) {
+    double tmp[VM_LANES];
+
+    vm_store(tmp, y);
+
+    for (size_t j = 0; j < m; ++j) {
+        dst[j] = ((bits >> j) & 1U) ? tmp[j] : scalar(src[j]);
+    }
+}
+
+/*
+    Each driver runs the kernel over whole vectors. The last partial vector is
+    padded, so a value gives the same result wherever it sits in the array.
+ */
+#define VM_DRIVER(name, kernel, scalar)                              \
+    void gb_vmath_##name(double *dst, const double *src, size_t n) { \
+        size_t i = 0;                                                \
+        vm_d   ok;                                                   \
+                                                                     \
+        if (!VM_KERNELS) {                                           \
+            for (; i < n; ++i) {                                     \
+                dst[i] = scalar(src[i]);                             \
+            }                                                        \
+            return;                                                  \
+        }                                                            \
+                                                                     \
+        for (; i + VM_LANES <= n; i += VM_LANES) {                   \
+            const vm_d y = kernel(vm_load(src + i), &ok);            \
+                                                                     \
+            if (vm_bits(ok) == VM_FULL) {                            \
+                vm_store(dst + i, y);                                \
+            } else {                                                 \
+                _vm_finish(dst + i, src + i, y, vm_bits(ok), VM_LANES, scalar); \
+            }                                                        \
+        }                                                            \
+                                                                     \
+        if (i < n) {                                                 \
+            double x[VM_LANES];                                      \
+                                                                     \
+            for (size_t j = 0; j < VM_LANES; ++j) {                  \
+                x[j] = (i + j < n) ? src[i + j] : 0.5;               \
+            }                                                        \
+                                                                     \
+            const vm_d y = kernel(vm_load(x), &ok);                  \
+            _vm_finish(dst + i, x, y, vm_bits(ok), n - i, scalar);   \
+        }                                                            \
+    }
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Functions
+// *****************************************************************************
+// *****************************************************************************
+
+size_t gb_vmath_lanes(void) {
+    return VM_LANES;
+}
+
+VM_DRIVER(sin, _vm_sin, sin)
+VM_DRIVER(cos, _vm_cos, cos)
+VM_DRIVER(tan, _vm_tan, tan)
+VM_DRIVER(asin, _vm_asin, asin)
+VM_DRIVER(acos, _vm_acos, acos)
+VM_DRIVER(atan, _vm_atan, atan)
+VM_DRIVER(exp, _vm_exp, exp)
+VM_DRIVER(log, _vm_log, log)
+VM_DRIVER(log2, _vm_log2, log2)
+VM_DRIVER(sqrt, _vm_sqrt, sqrt)
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,78 @@
+/* ************************************************************************** */
+/*
+    @file
+        gb_vmath.h
+
+    @date
+        October, 2026
+
+    @author
+        Gino Francesco Bogo (ᛊᛟᚱᚱᛖ ᛗᛖᚨ ᛁᛊᛏᚨᛗᛁ ᚨcᚢᚱᛉᚢ)
+
+    @license
+        MIT
+ */
+/* ************************************************************************** */
+
+#ifndef GB_VMATH_H
+#define GB_VMATH_H
+
+#include <stddef.h> // size_t
+
+// *****************************************************************************
+// *****************************************************************************
+// Public Functions
+// *****************************************************************************
+// *****************************************************************************
+
+/*
+    Elementary functions over arrays of doubles, computed several lanes at a
+    time: 4 with AVX2, 2 with SSE2 or NEON, 1 with the portable fallback. The
+    path is chosen at compile time (see gb_vmath_lanes()).
+
+    Every kernel is a range reduction followed by a polynomial or rational
+    approximation. Arguments outside the reduced range (NaN, infinities,
+    domain edges, huge trigonometric arguments, magnitudes below 2^-500,
+    results that would overflow or be subnormal) are computed with libm
+    instead, so special values behave exactly as in the scalar evaluator.
+    Fused multiply-add is never used: all paths give bit-identical results.
+
+    Maximum error against the exact result, measured on 4 * 10^6 random
+    arguments per range and rounded up to half a unit:
+
+        function  range                      ULP
+        --------  -------------------------  ----
+        sin, cos  |x| <= 2^15                1
+        tan       |x| <= 2^15                2.5
+        atan      |x| <= 2^500               1
+        asin      |x| <= 1                   2.5
+        acos      |x| <= 1                   2
+        exp       |x| <= 708                 1
+        log       normal positive numbers    1
+        log2      normal positive numbers    1
+        sqrt      all                        0.5 (correctly rounded)
+
+    `dst` may be the same array as `src`; partial overlap is not allowed.
+ */
+
+/**
+ * @brief Returns the number of lanes processed per vector instruction.
+ */
+size_t gb_vmath_lanes(void);
+
+void gb_vmath_sin(double *dst, const double *src, size_t n);
+void gb_vmath_cos(double *dst, const double *src, size_t n);
+void gb_vmath_tan(double *dst, const double *src, size_t n);
+void gb_vmath_asin(double *dst, const double *src, size_t n);
+void gb_vmath_acos(double *dst, const double *src, size_t n);
+void gb_vmath_atan(double *dst, const double *src, size_t n);
+void gb_vmath_exp(double *dst, const double *src, size_t n);
+void gb_vmath_log(double *dst, const double *src, size_t n);
+void gb_vmath_log2(double *dst, const double *src, size_t n);
+void gb_vmath_sqrt(double *dst, const double *src, size_t n);
+
+#endif // GB_VMATH_H
+
+/* *****************************************************************************
+ End of File
+ */
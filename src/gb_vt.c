@@ -17,17 +17,22 @@
 #include "gb_vt.h"
 
 #include <ctype.h>   // isprint
-#include <math.h>    // INFINITY
+#include <errno.h>   // EINTR, errno
 #include <pthread.h> // pthread_cancel, pthread_create, pthread_join, ...
+#include <stdarg.h>  // va_copy, va_end, va_list, va_start
 #include <stdbool.h> // bool, false, true
 #include <stdio.h>   // FILE, NULL, fclose, fflush, fgets, ...
-#include <stdlib.h>  // strtoul
-#include <string.h>  // memcpy, memset, strcmp, strncpy, strtok
+#include <stdlib.h>  // calloc, free, strtoul
+#include <string.h>  // memchr, memcpy, memmove, memset, strncpy, strstr, strtok
 #include <termios.h> // ECHO, ICANON, TCSANOW
 #include <time.h>    // timespec, clock_gettime, CLOCK_MONOTONIC
-#include <unistd.h>  // STDIN_FILENO
+#include <unistd.h>  // STDIN_FILENO, read, ssize_t
 
+#include "gb_batch.h"
+#include "gb_bigint.h"
 #include "gb_calc.h"
+#include "gb_fmath.h"
+#include "gb_intcalc.h"
 #include "gb_utils.h"
 
 // *****************************************************************************
@@ -37,21 +42,37 @@
 // *****************************************************************************
 
 // clang-format off
-#define print_prompt()  fputs("\r\n$> ", stdout); fflush(stdout)
+#define print_prompt()  if (vt_interactive) { fputs("\r\n$> ", stdout); fflush(stdout); }
 #define print_string(x) fputs("\r$> ", stdout); fputs(x, stdout); fflush(stdout)
 
-#define error_unknown_cmd() fputs("\r\n  [ERROR] Unknown command!\r\n", stdout)
-#define error_wrong_args()  fputs("\r\n  [ERROR] Wrong arguments\r\n", stdout)
+#define error_unknown_cmd() vt_puts("\r\n  [ERROR] Unknown command!\r\n")
+#define error_wrong_args()  vt_puts("\r\n  [ERROR] Wrong arguments\r\n")
 
 #define move_cur_left()  fputs("\x1B[D", stdout) // ESC[D (move cursor left)
 #define move_cur_right() fputs("\x1B[C", stdout) // ESC[C (move cursor right)
 // clang-format on
 
-#define MAX_ARG_LEN (24)
+// An argument fits a 256-bit value written in binary with its prefix
+#define MAX_ARG_LEN (272)
 #define MAX_ARG_NUM (64)
-#define MAX_CMD_LEN (32 + (MAX_ARG_NUM * MAX_ARG_LEN))
+#define MAX_CMD_LEN (1600)
 #define HISTORY_LEN (20)
 
+// Converter outputs: 4 bits per hex digit, 10/3 bits per decimal digit
+#define MAX_BIN_LEN (4 * MAX_ARG_LEN + 16)
+#define MAX_DEC_LEN (2 * MAX_ARG_LEN)
+#define MAX_HEX_LEN (MAX_ARG_LEN)
+
+// Memory budget of the calc result cache (about 128 bytes per expression)
+#define CALC_CACHE_SIZE (8 * 1024)
+
+// Lines of a batch file evaluated per parallel round
+#define RUN_BLOCK_LINES (16384)
+
+// Streaming mode: bytes read per block, and output buffered per block
+#define STREAM_BLOCK   (64 * 1024)
+#define STREAM_OUT_LEN (256 * 1024)
+
 // *****************************************************************************
 // *****************************************************************************
 // Local Types & Structures
@@ -86,21 +107,97 @@ int  vt_history_idx = 0;
 int  vt_history_pos = 0;
 int  vt_history_len = 0;
 
+// Raw text of the command being decoded (before tokenization)
+const char *vt_line = "";
+
+// Interactive terminal (prompts) or streaming mode
+bool vt_interactive = true;
+
+gb_calc_cache_t *vt_calc_cache = NULL;
+gb_batch_t      *vt_batch      = NULL;
+
+gb_intcalc_mode_t vt_int_mode = {64, true};
+
 // *****************************************************************************
 // *****************************************************************************
-// Local Functions (Math)
+// Local Functions (Output)
 // *****************************************************************************
 // *****************************************************************************
 
-static void __math_calc(int argc) {
-    if (argc < 1) {
-        error_wrong_args();
+/**
+ * @brief Writes a string to stdout.
+ *
+ * Lines end with "\r\n" on the raw terminal; in streaming mode the output
+ * feeds scripts and files, so they end with a plain "\n".
+ */
+static void vt_puts(const char *str) {
+    if (vt_interactive) {
+        fputs(str, stdout);
         return;
     }
 
+    for (const char *cr; (cr = strstr(str, "\r\n")) != NULL; str = cr + 1) {
+        fwrite(str, 1, (size_t)(cr - str), stdout);
+    }
+    fputs(str, stdout);
+}
+
+/**
+ * @brief Formats to stdout, with the line ends of vt_puts().
+ */
+static void vt_printf(const char *fmt, ...) {
+    va_list args;
+
+    va_start(args, fmt);
+
+    if (vt_interactive) {
+        vprintf(fmt, args);
+        va_end(args);
+        return;
+    }
+
+    char    local[256];
+    char   *buf = local;
+    va_list copy;
+
+    va_copy(copy, args);
+    const int len = vsnprintf(local, sizeof(local), fmt, copy);
+    va_end(copy);
+
+    // Long results (e.g. bcalc digits) get a buffer of their own, or are
+    // truncated if there is no memory for it
+    if (len >= (int)sizeof(local)) {
+        buf = (char *)gb_malloc((size_t)len + 1, 1);
+
+        if (buf) {
+            vsnprintf(buf, (size_t)len + 1, fmt, args);
+        } else {
+            buf = local;
+        }
+    }
+
+    va_end(args);
+
+    if (len >= 0) {
+        vt_puts(buf);
+    }
+
+    if (buf != local) {
+        gb_free(buf);
+    }
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Local Functions (Math)
+// *****************************************************************************
+// *****************************************************************************
+
+static const char *__math_expr(void) {
     const char *task = vt_arg[0];
-    const char *expr = vt_history[vt_history_pos - 1];
+    const char *expr = vt_line;
 
+    // Skip the command name: the expression is the rest of the raw line
     size_t len = gb_strlen(task);
     while (len > 0) {
         if (*expr == *task) {
@@ -110,23 +207,281 @@ static void __math_calc(int argc) {
         ++expr;
     }
 
-    double value = gb_calc(expr);
+    return expr;
+}
+
+static void __math_error(const gb_calc_error_t *err, const char *expr) {
+    char msg[96];
+
+    gb_calc_format_error(err, expr, msg, sizeof(msg));
+    vt_printf("\r\n  [ERROR] %s\r\n", msg);
+}
+
+static void __math_calc(int argc) {
+    if (argc < 1) {
+        error_wrong_args();
+        return;
+    }
+
+    const char *expr = __math_expr();
+
+    if (!vt_calc_cache) {
+        vt_calc_cache = gb_calc_cache_new(CALC_CACHE_SIZE);
+    }
+
+    gb_calc_error_t err;
+
+    double value = gb_calc_cached(vt_calc_cache, expr, &err);
+
+    if (err.code == GB_CALC_OK) {
+        vt_printf("%lf\r\n", value);
+    } else {
+        __math_error(&err, expr);
+    }
+}
+
+static void __math_bcalc(int argc) {
+    if (argc < 1) {
+        error_wrong_args();
+        return;
+    }
+
+    const char *expr = __math_expr();
+
+    gb_bigint_t     value;
+    gb_calc_error_t err;
+
+    gb_bigint_init(&value);
+
+    if (gb_bigint_calc(expr, &value, &err)) {
+        // 10 decimal digits per 32 bits, plus sign and terminator
+        const size_t len = ((gb_bigint_bits(&value) / 32) + 1) * 10 + 2;
+        char        *dec = (char *)gb_malloc(len, 1);
+
+        if (dec && gb_bigint_to_str(&value, 10, dec, len)) {
+            vt_printf("%s\r\n", dec);
+        } else {
+            err.code = GB_CALC_E_NO_MEMORY;
+            err.pos  = 0;
+            __math_error(&err, expr);
+        }
+
+        gb_free(dec);
+    } else {
+        __math_error(&err, expr);
+    }
+
+    gb_bigint_free(&value);
+}
+
+static void __math_pcalc(int argc) {
+    if (argc < 1) {
+        error_wrong_args();
+        return;
+    }
+
+    const char *expr = __math_expr();
+
+    uint64_t        value;
+    gb_calc_error_t err;
+
+    if (!gb_intcalc(expr, &vt_int_mode, &value, &err)) {
+        __math_error(&err, expr);
+        return;
+    }
+
+    char hex[24];
+    char bin[96];
+
+    gb_intcalc_format(value, vt_int_mode.width, 16, hex, sizeof(hex));
+    gb_intcalc_format(value, vt_int_mode.width, 2, bin, sizeof(bin));
+
+    if (vt_int_mode.is_signed) {
+        vt_printf("%lld\r\n", (long long)gb_intcalc_sext(value, vt_int_mode.width));
+    } else {
+        vt_printf("%llu\r\n", (unsigned long long)value);
+    }
+
+    vt_printf("  hex : 0x%s\r\n", hex);
+    vt_printf("  bin : 0b%s\r\n", bin);
+}
+
+static void __math_pmode(int argc) {
+    for (int i = 1; i <= argc; ++i) {
+        const char *arg = vt_arg[i];
+
+        if (!gb_strcmp(arg, "signed")) {
+            vt_int_mode.is_signed = true;
+        } else if (!gb_strcmp(arg, "unsigned")) {
+            vt_int_mode.is_signed = false;
+        } else {
+            const unsigned long width = strtoul(arg, NULL, 10);
+
+            if (!gb_intcalc_width_ok((unsigned)width)) {
+                error_wrong_args();
+                return;
+            }
+
+            vt_int_mode.width = (unsigned)width;
+        }
+    }
+
+    vt_printf("\r\n  %s %u-bit\r\n", vt_int_mode.is_signed ? "signed" : "unsigned", vt_int_mode.width);
+}
+
+static void __math_cache(int argc) {
+    if (!vt_calc_cache) {
+        vt_calc_cache = gb_calc_cache_new(CALC_CACHE_SIZE);
+    }
+
+    if ((argc == 1) && !gb_strcmp(vt_arg[1], "clear")) {
+        gb_calc_cache_clear(vt_calc_cache);
+    } else if (argc != 0) {
+        error_wrong_args();
+        return;
+    }
+
+    gb_calc_cache_stats_t stats = {0};
+
+    gb_calc_cache_stats(vt_calc_cache, &stats);
+
+    vt_printf("\r\n");
+    vt_printf("  hits    : %zu\r\n", stats.hits);
+    vt_printf("  misses  : %zu\r\n", stats.misses);
+    vt_printf("  entries : %zu / %zu\r\n", stats.entries, stats.capacity);
+    vt_printf("  memory  : %zu bytes\r\n", stats.bytes);
+}
+
+static void __math_fmath(int argc) {
+    if ((argc == 1) && !gb_strcmp(vt_arg[1], "on")) {
+        gb_calc_fast_math(1);
+    } else if ((argc == 1) && !gb_strcmp(vt_arg[1], "off")) {
+        gb_calc_fast_math(0);
+    } else if (argc != 0) {
+        error_wrong_args();
+        return;
+    }
+
+    gb_fmath_error_t rows[8];
+
+    const size_t count = GB_MIN(gb_fmath_report(rows, 8), 8);
 
-    if (value != INFINITY) {
-        printf("%lf\r\n", value);
+    vt_printf("\r\n  fast math %s (%d-entry tables)\r\n", gb_calc_fast_math_enabled() ? "on" : "off", 1 << GB_FMATH_BITS);
+    vt_printf("\r\n  function  range                  max abs err  max rel err\r\n");
+
+    for (size_t i = 0; i < count; ++i) {
+        char range[32];
+
+        snprintf(range, sizeof(range), "[%g, %g]", rows[i].lo, rows[i].hi);
+        vt_printf("  %-8s  %-21s  %11.3e  %11.3e\r\n", rows[i].name, range, rows[i].max_abs, rows[i].max_rel);
     }
 }
 
+static size_t __run_block(char **line, size_t count, size_t first_row, double *value, gb_calc_error_t *err) {
+    size_t failed = 0;
+
+    gb_batch_calc(vt_batch, (const char *const *)line, count, value, err);
+
+    // Blank lines are echoed as such and not counted as errors
+    for (size_t i = 0; i < count; ++i) {
+        if (line[i][0] == '\0') {
+            vt_puts("\r\n");
+        } else if (err[i].code == GB_CALC_OK) {
+            vt_printf("%lf\r\n", value[i]);
+        } else {
+            char msg[96];
+
+            gb_calc_format_error(&err[i], line[i], msg, sizeof(msg));
+            vt_printf("  [ERROR] line %zu: %s\r\n", first_row + i, msg);
+            ++failed;
+        }
+    }
+
+    return failed;
+}
+
+static void __math_run(int argc) {
+    if (argc != 1) {
+        error_wrong_args();
+        return;
+    }
+
+    FILE *file = fopen(vt_arg[1], "r");
+
+    if (!file) {
+        vt_printf("\r\n  [ERROR] Cannot open '%s'\r\n", vt_arg[1]);
+        return;
+    }
+
+    if (!vt_batch) {
+        vt_batch = gb_batch_new(0);
+    }
+
+    // The line buffers are kept across blocks: getline() reuses them
+    char           **line  = (char **)calloc(RUN_BLOCK_LINES, sizeof(char *));
+    size_t          *cap   = (size_t *)calloc(RUN_BLOCK_LINES, sizeof(size_t));
+    double          *value = (double *)gb_malloc(RUN_BLOCK_LINES * sizeof(double), sizeof(double));
+    gb_calc_error_t *err   = (gb_calc_error_t *)gb_malloc(RUN_BLOCK_LINES * sizeof(gb_calc_error_t), sizeof(void *));
+
+    size_t rows   = 0;
+    size_t failed = 0;
+    size_t count  = 0;
+
+    struct timespec t0;
+    struct timespec t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    if (line && cap && value && err) {
+        ssize_t len;
+
+        while ((len = getline(&line[count], &cap[count], file)) >= 0) {
+            // Strip the line terminator (LF or CRLF)
+            while ((len > 0) && ((line[count][len - 1] == '\n') || (line[count][len - 1] == '\r'))) {
+                line[count][--len] = '\0';
+            }
+
+            if (++count == RUN_BLOCK_LINES) {
+                failed += __run_block(line, count, rows + 1, value, err);
+                rows += count;
+                count = 0;
+            }
+        }
+
+        failed += __run_block(line, count, rows + 1, value, err);
+        rows += count;
+    } else {
+        vt_puts("\r\n  [ERROR] Out of memory\r\n");
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    const double ms = (double)(t1.tv_sec - t0.tv_sec) * 1e3 + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-6;
+
+    vt_printf("\r\n  %zu lines, %zu errors, %u threads, %.1f ms\r\n", rows, failed, gb_batch_threads(vt_batch), ms);
+
+    for (size_t i = 0; line && (i < RUN_BLOCK_LINES); ++i) {
+        free(line[i]);
+    }
+
+    free(line);
+    free(cap);
+    gb_free(value);
+    gb_free(err);
+
+    fclose(file);
+}
+
 static void __math_bin2dec(int argc) {
     if (argc != 1) {
         error_wrong_args();
         return;
     }
 
-    char dec[80];
+    char dec[MAX_DEC_LEN];
 
     if (gb_bin2dec(vt_arg[1], dec, sizeof(dec))) {
-        printf("%s\r\n", dec);
+        vt_printf("%s\r\n", dec);
     } else {
         error_wrong_args();
     }
@@ -138,10 +493,10 @@ static void __math_bin2hex(int argc) {
         return;
     }
 
-    char hex[64];
+    char hex[MAX_HEX_LEN];
 
     if (gb_bin2hex(vt_arg[1], hex, sizeof(hex))) {
-        printf("%s\r\n", hex);
+        vt_printf("%s\r\n", hex);
     } else {
         error_wrong_args();
     }
@@ -153,10 +508,10 @@ static void __math_dec2bin(int argc) {
         return;
     }
 
-    char bin[128];
+    char bin[MAX_BIN_LEN];
 
     if (gb_dec2bin(vt_arg[1], bin, sizeof(bin))) {
-        printf("%s\r\n", bin);
+        vt_printf("%s\r\n", bin);
     } else {
         error_wrong_args();
     }
@@ -168,10 +523,10 @@ static void __math_dec2hex(int argc) {
         return;
     }
 
-    char hex[64];
+    char hex[MAX_HEX_LEN];
 
     if (gb_dec2hex(vt_arg[1], hex, sizeof(hex))) {
-        printf("%s\r\n", hex);
+        vt_printf("%s\r\n", hex);
     } else {
         error_wrong_args();
     }
@@ -183,10 +538,10 @@ static void __math_hex2bin(int argc) {
         return;
     }
 
-    char bin[128];
+    char bin[MAX_BIN_LEN];
 
     if (gb_hex2bin(vt_arg[1], bin, sizeof(bin))) {
-        printf("%s\r\n", bin);
+        vt_printf("%s\r\n", bin);
     } else {
         error_wrong_args();
     }
@@ -198,10 +553,10 @@ static void __math_hex2dec(int argc) {
         return;
     }
 
-    char dec[80];
+    char dec[MAX_DEC_LEN];
 
     if (gb_hex2dec(vt_arg[1], dec, sizeof(dec))) {
-        printf("%s\r\n", dec);
+        vt_printf("%s\r\n", dec);
     } else {
         error_wrong_args();
     }
@@ -290,6 +645,12 @@ static int vt_split_string(char       *str, //
 
 vt_cmd_entry_t vt_cmd_entry[] = {
     {   "calc", 4, 1,    __math_calc},
+    {  "bcalc", 5, 1,   __math_bcalc},
+    {  "pcalc", 5, 1,   __math_pcalc},
+    {  "pmode", 5, 0,   __math_pmode},
+    {  "cache", 5, 0,   __math_cache},
+    {  "fmath", 5, 0,   __math_fmath},
+    {    "run", 3, 1,     __math_run},
     {    "b2d", 3, 1, __math_bin2dec},
     {"bin2dec", 7, 1, __math_bin2dec},
     {    "b2h", 3, 1, __math_bin2hex},
@@ -365,25 +726,59 @@ static bool vt_decode_word(int argc) {
     return false;
 }
 
-static void vt_decode_command(void) {
-    vt_add_history(vt_cmd);
-
+static void vt_execute(bool skip_empty) {
     const int argc = vt_split_string(vt_cmd, " ;", vt_arg);
 
+    if ((argc == 0) && skip_empty) {
+        return;
+    }
+
     if (vt_decode_task(argc)) {
-        print_prompt();
         return;
     }
 
     if (vt_decode_word(argc)) {
-        print_prompt();
         return;
     }
 
     error_unknown_cmd();
+}
+
+static void vt_decode_command(void) {
+    vt_add_history(vt_cmd);
+
+    vt_line = vt_history[(vt_history_idx + HISTORY_LEN - 1) % HISTORY_LEN];
+
+    vt_execute(false);
     print_prompt();
 }
 
+static void vt_stream_line(char *line, size_t len) {
+    // CRLF input
+    if ((len > 0) && (line[len - 1] == '\r')) {
+        line[--len] = '\0';
+    }
+
+    if (len >= MAX_CMD_LEN) {
+        vt_puts("  [ERROR] Line too long\r\n");
+        return;
+    }
+
+    // The arguments are cut out of a copy: the expression keeps the raw line
+    memcpy(vt_cmd, line, len + 1);
+    vt_line = line;
+
+    vt_execute(true);
+}
+
+static void vt_release(void) {
+    gb_calc_cache_free(vt_calc_cache);
+    vt_calc_cache = NULL;
+
+    gb_batch_free(vt_batch);
+    vt_batch = NULL;
+}
+
 static void vt_key_end(void) {
     if (vt_cmd_len > 0) {
         for (int i = vt_cur_pos; i < vt_cmd_len; ++i) {
@@ -450,7 +845,7 @@ static void vt_key_return(void) {
     vt_cmd_len         = 0;
     vt_cur_pos         = 0;
 
-    fputs("\r\n", stdout);
+    vt_puts("\r\n");
 
     vt_decode_command();
 
@@ -595,6 +990,10 @@ static void *vt_keystroke_worker(void *args) {
         }
 
         switch (ch) {
+            case EOF: { // input closed
+                VT_Exit();
+            } break;
+
             case 0x08:   // BACKSPACE
             case 0x7F: { // DEL
                 vt_key_backspace();
@@ -663,6 +1062,89 @@ void VT_KeystrokeStop(void) {
     pthread_cancel(vt_thread);
 
     pthread_join(vt_thread, NULL);
+
+    vt_release();
+}
+
+bool VT_StreamRun(int fd) {
+    // Room for a whole block after the longest partial line kept from the
+    // previous one
+    const size_t size  = STREAM_BLOCK + MAX_CMD_LEN;
+    char        *block = (char *)gb_malloc(size + 1, 1);
+
+    if (!block) {
+        return false;
+    }
+
+    vt_interactive = false;
+
+    // Every block of results leaves in a single write
+    setvbuf(stdout, NULL, _IOFBF, STREAM_OUT_LEN);
+
+    size_t held = 0;     // bytes of an incomplete line at the start of block
+    bool   skip = false; // discarding the rest of an overlong line
+    bool   ok   = true;
+
+    while (!vt_exit) {
+        const ssize_t got = read(fd, block + held, size - held);
+
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            ok = false;
+            break;
+        }
+
+        if (got == 0) {
+            // Last line without a terminator
+            if ((held > 0) && !skip) {
+                block[held] = '\0';
+                vt_stream_line(block, held);
+            }
+            break;
+        }
+
+        char *const end  = block + held + got;
+        char       *line = block;
+        char       *eol;
+
+        while (!vt_exit && ((eol = memchr(line, '\n', (size_t)(end - line))) != NULL)) {
+            *eol = '\0';
+
+            if (skip) {
+                skip = false;
+            } else {
+                vt_stream_line(line, (size_t)(eol - line));
+            }
+
+            line = eol + 1;
+        }
+
+        held = (size_t)(end - line);
+
+        if (held >= MAX_CMD_LEN) {
+            // No command is that long: report it once and drop it
+            if (!skip) {
+                vt_puts("  [ERROR] Line too long\r\n");
+            }
+
+            skip = true;
+            held = 0;
+        } else {
+            memmove(block, line, held);
+        }
+
+        fflush(stdout);
+    }
+
+    fflush(stdout);
+
+    gb_free(block);
+    vt_release();
+
+    return ok;
 }
 
 static bool is_first_time = true;
@@ -674,14 +1156,14 @@ void VT_PrintAbout(void) {
     vt_cur_pos = 0;
     vt_esc_seq = 0;
 
-    printf("\r\n");
-    printf("----------------------------\r\n");
-    printf("           gVtCalc          \r\n");
-    printf("                            \r\n");
-    printf("   author: Gino Bogo        \r\n");
-    printf("  version: %d.%d.%d         \r\n", 0, 1, 0);
-    printf("     date: %s               \r\n", "September, 2025");
-    printf("----------------------------\r\n");
+    vt_printf("\r\n");
+    vt_printf("----------------------------\r\n");
+    vt_printf("           gVtCalc          \r\n");
+    vt_printf("                            \r\n");
+    vt_printf("   author: Gino Bogo        \r\n");
+    vt_printf("  version: %d.%d.%d         \r\n", 0, 1, 0);
+    vt_printf("     date: %s               \r\n", "September, 2025");
+    vt_printf("----------------------------\r\n");
 
     if (is_first_time) {
         is_first_time = false;
@@ -696,13 +1178,13 @@ void VT_PrintHelp(void) {
     vt_cur_pos = 0;
     vt_esc_seq = 0;
 
-    printf("\r\n");
-    printf("Commands list:\r\n");
-    printf("  about\r\n");
-    printf("  clear\r\n");
-    printf("  exit\r\n");
-    printf("  help\r\n");
-    printf("  math\r\n");
+    vt_printf("\r\n");
+    vt_printf("Commands list:\r\n");
+    vt_printf("  about\r\n");
+    vt_printf("  clear\r\n");
+    vt_printf("  exit\r\n");
+    vt_printf("  help\r\n");
+    vt_printf("  math\r\n");
 }
 
 void VT_PrintMath(void) {
@@ -713,15 +1195,21 @@ void VT_PrintMath(void) {
     vt_esc_seq = 0;
 
     // clang-format off
-    printf("\r\n");
-    printf("Math:\r\n");
-    printf("  calc <expr>   - calculate the expression\r\n");
-    printf("  bin2dec <num> - convert binary to decimal. Alias: b2d\r\n");
-    printf("  bin2hex <num> - convert binary to hexadecimal. Alias: b2h\r\n");
-    printf("  dec2bin <num> - convert decimal to binary. Alias: d2b\r\n");
-    printf("  dec2hex <num> - convert decimal to hexadecimal. Alias: d2h\r\n");
-    printf("  hex2bin <num> - convert hexadecimal to binary. Alias: h2b\r\n");
-    printf("  hex2dec <num> - convert hexadecimal to decimal. Alias: h2d\r\n");
+    vt_printf("\r\n");
+    vt_printf("Math:\r\n");
+    vt_printf("  calc <expr>   - calculate the expression (a = 1/3; b = a*2; a + b)\r\n");
+    vt_printf("  bcalc <expr>  - calculate an exact integer expression\r\n");
+    vt_printf("  pcalc <expr>  - calculate with register integers (& | ^ << >> ...)\r\n");
+    vt_printf("  pmode [8|16|32|64] [signed|unsigned] - set the pcalc register\r\n");
+    vt_printf("  cache [clear] - show (or reset) the calc result cache\r\n");
+    vt_printf("  fmath [on|off] - table-driven sin, cos, tan, exp, log, pow; error vs libm\r\n");
+    vt_printf("  run <file>    - calculate every line of a file on all cores\r\n");
+    vt_printf("  bin2dec <num> - convert binary to decimal. Alias: b2d\r\n");
+    vt_printf("  bin2hex <num> - convert binary to hexadecimal. Alias: b2h\r\n");
+    vt_printf("  dec2bin <num> - convert decimal to binary. Alias: d2b\r\n");
+    vt_printf("  dec2hex <num> - convert decimal to hexadecimal. Alias: d2h\r\n");
+    vt_printf("  hex2bin <num> - convert hexadecimal to binary. Alias: h2b\r\n");
+    vt_printf("  hex2dec <num> - convert hexadecimal to decimal. Alias: h2d\r\n");
     // clang-format on
 }
 
@@ -39,6 +39,8 @@ void VT_RestoreBuffering(void);
 void VT_KeystrokeStart(void *args);
 void VT_KeystrokeStop(void);
 
+bool VT_StreamRun(int fd);
+
 void VT_PrintAbout(void);
 void VT_PrintHelp(void);
 void VT_PrintMath(void);
@@ -14,12 +14,56 @@
  */
 /* ************************************************************************** */
 
+#include <fcntl.h> // O_RDONLY, open
+#include <stdbool.h>
 #include <stdio.h>
-#include <unistd.h> // NULL, sleep
+#include <string.h> // strcmp
+#include <unistd.h> // NULL, STDIN_FILENO, close, isatty, sleep
 
 #include "gb_vt.h"
 
-int main(void) {
+static void print_usage(const char *name) {
+    fprintf(stderr, "Usage: %s [-i | -s] [file]\n", name);
+    fprintf(stderr, "  -i    interactive terminal (default when stdin is a TTY)\n");
+    fprintf(stderr, "  -s    stream commands, one per line, from stdin or file\n");
+}
+
+int main(int argc, char *argv[]) {
+    // Pipes, redirections and files are streamed line by line
+    bool        stream = !isatty(STDIN_FILENO);
+    const char *path   = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-i")) {
+            stream = false;
+        } else if (!strcmp(argv[i], "-s")) {
+            stream = true;
+        } else if ((argv[i][0] != '-') && !path) {
+            path   = argv[i];
+            stream = true;
+        } else {
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (stream) {
+        const int fd = path ? open(path, O_RDONLY) : STDIN_FILENO;
+
+        if (fd < 0) {
+            perror(path);
+            return 2;
+        }
+
+        const bool ok = VT_StreamRun(fd);
+
+        if (path) {
+            close(fd);
+        }
+
+        return ok ? 0 : 1;
+    }
+
     VT_DisableBuffering();
     VT_KeystrokeStart(NULL);
 